@@ -0,0 +1,65 @@
+// File: AllocationTracker.hpp
+// Description: Declares optional heap allocation accounting. Builds made
+//              with WITH_ALLOC_TRACKING=1 replace the global operator
+//              new/delete and count allocations and bytes per thread,
+//              attributed to the innermost AllocationScope tag. In other
+//              builds scopes compile to nothing and no hook is installed.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace backend {
+
+struct AllocationStats {
+    const char* scope{"untagged"};
+    std::uint64_t allocations{0};
+    std::uint64_t allocatedBytes{0};
+    // Frees are charged to the scope active when the memory is released,
+    // which is not always the scope that allocated it.
+    std::uint64_t frees{0};
+    std::uint64_t freedBytes{0};
+};
+
+class AllocationTracker {
+public:
+    static constexpr bool enabled() {
+#ifdef TANK_ALLOC_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Totals per scope over every thread, including exited ones. Scopes that
+    // never allocated are omitted; empty when tracking is compiled out.
+    static std::vector<AllocationStats> snapshot();
+
+    // Totals of the calling thread across all scopes (for benchmarks that
+    // measure one operation at a time).
+    static AllocationStats threadTotals();
+};
+
+// Attributes the calling thread's allocations to tag until destruction.
+// tag must outlive the process (a string literal); at most 63 distinct tags
+// are tracked, later ones count as "untagged".
+class AllocationScope {
+public:
+#ifdef TANK_ALLOC_TRACKING
+    explicit AllocationScope(const char* tag) noexcept;
+    ~AllocationScope();
+#else
+    explicit AllocationScope(const char*) noexcept {}
+#endif
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+#ifdef TANK_ALLOC_TRACKING
+private:
+    std::uint8_t m_previous;
+#endif
+};
+
+}  // namespace backend
@@ -3,8 +3,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -28,13 +31,55 @@ public:
     virtual ~AttendanceRepository() = default;
 
     virtual std::vector<Student> listStudents() = 0;
+    // Keyset page of students ordered by studentId, strictly after afterId
+    // (empty afterId starts from the beginning).
+    virtual std::vector<Student> listStudentsAfter(const std::string& afterId,
+                                                   std::size_t limit) = 0;
+    // Visits every student in studentId order without materializing the roster.
+    // Rows are fetched in keyset batches and the repository is not locked while
+    // the visitor runs, so a walk may see changes made during it.
+    // The Student reference is only valid during the call; return false to stop.
+    // Returns false if the backend failed before the walk completed.
+    virtual bool forEachStudent(const std::function<bool(const Student&)>& visitor) = 0;
     virtual std::optional<Student> findStudentById(const std::string& studentId) = 0;
     virtual bool markAttendance(const AttendanceRecord& record) = 0;
 };
 
+// Raised by repositories configured not to terminate the process when the
+// backing store becomes unreachable (see MySqlConnectionOptions).
+class AttendanceUnavailableError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct MySqlConnectionOptions {
+    std::string host{"localhost"};
+    std::string user{"root"};
+    std::string password;
+    std::string database{"attendance_db"};
+    unsigned int port{3306U};
+    // Client-side socket timeouts in seconds; 0 keeps the library default.
+    unsigned int connectTimeoutSeconds{0};
+    unsigned int readTimeoutSeconds{0};
+    unsigned int writeTimeoutSeconds{0};
+    // true: a lost connection logs and quick_exit()s (historical behaviour).
+    // false: the call throws AttendanceUnavailableError and the next call reconnects.
+    bool exitOnDisconnect{true};
+
+    // Reads ATTENDANCE_DB_* (plus MYSQL_PWD / DB_PASSWORD) environment variables.
+    static MySqlConnectionOptions fromEnvironment();
+};
+
+std::unique_ptr<AttendanceRepository> createInMemoryAttendanceRepository();
+// Throws std::runtime_error if the connection fails or MySQL support is not compiled in.
+std::unique_ptr<AttendanceRepository> createMySqlAttendanceRepository(
+    const MySqlConnectionOptions& options);
+
 // Factory used by WebServer. In a MySQL-enabled build (HAVE_MYSQL),
 // attendance data is persisted in MySQL; if MySQL support is missing,
 // the factory will fail fast instead of silently falling back to memory.
+// The connection uses a short connect timeout and reports later disconnects
+// as AttendanceUnavailableError, so callers can retry instead of exiting.
 std::unique_ptr<AttendanceRepository> createAttendanceRepository();
 
 }  // namespace backend
@@ -1,13 +1,21 @@
 // File: GameEngine.hpp
 // Description: Declares the core backend engine coordinating tank movement,
-//              red envelope generation, and gameplay timing.
+//              red envelope generation, and gameplay timing. Timed events
+//              (envelope expiry, rain waves) run on a TimerWheel driven by
+//              game time, which stops while the game is paused.
 
 #pragma once
 
 #include "Tank.hpp"
+#include "TimerWheel.hpp"
 
 #include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
 #include <random>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace backend {
@@ -17,8 +25,17 @@ struct GameConfig {
     int worldHeight{20};
     int initialEnvelopeCount{8};
     int timeLimitSeconds{60};
+    // Game seconds an envelope stays on the board uncollected; 0 keeps it
+    // until collected. The board is topped back up to initialEnvelopeCount.
+    int envelopeLifetimeSeconds{20};
+    // Game seconds between automatic rain waves; 0 leaves rain to /rain.
+    int rainIntervalSeconds{15};
+    int rainWaveMinCount{3};
+    int rainWaveMaxCount{6};
 };
 
+class SharedStateWriter;
+
 struct CollectionStats {
     int collectedCount{0};
     int collectedValue{0};
@@ -27,10 +44,30 @@ struct CollectionStats {
 class GameEngine {
 public:
     explicit GameEngine(GameConfig config = {});
+    ~GameEngine();
 
     void reset();
 
     bool moveTank(MoveDirection direction);
+    // moveTank for a client that numbers its inputs. A sequence at or below
+    // the last one seen from player is a retry or arrived late and is
+    // skipped; otherwise it becomes the player's acknowledged sequence,
+    // whether or not the move could be applied. Up to 1024 players are
+    // tracked; a new one is refused while all of them were active in the
+    // last 10 minutes.
+    bool applyInput(const std::string& player, std::uint64_t sequence, MoveDirection direction);
+    // Highest sequence processed for player (0: none). Survives reset() so
+    // acknowledgements only ever move forward.
+    std::uint64_t lastInputSequence(const std::string& player) const;
+
+    // Fires the scheduled events due by the current game time (capped at the
+    // time limit). Mutating calls do this themselves; readers call it before
+    // looking at the board. Returns the number of events fired.
+    std::size_t update();
+    std::size_t pendingEvents() const noexcept;
+    // Wall time until update() may have something to fire; max() while
+    // paused, after the time limit or with nothing scheduled.
+    std::chrono::milliseconds untilNextEvent() const;
 
     bool isTimeUp() const;
     double elapsedSeconds() const;
@@ -47,6 +84,12 @@ public:
     bool togglePause();
     bool isPaused() const noexcept;
 
+    // Mirrors the game into the POSIX shared-memory segment name (layout
+    // and reader in SharedState.hpp) after every change, holding up to
+    // envelopeCapacity envelopes. Throws std::runtime_error if the segment
+    // cannot be created.
+    void exportSharedState(const std::string& name, std::size_t envelopeCapacity);
+
 private:
     GameConfig m_config;
     Tank m_tank;
@@ -59,7 +102,38 @@ private:
     std::chrono::duration<double> m_pausedAccumulated{0.0};
     std::chrono::steady_clock::time_point m_pauseStart{};
 
+    struct EnvelopeEntry {
+        std::size_t index;
+        TimerId expiry;
+    };
+    // Envelope id -> slot in m_envelopes and its expiry timer, so an expiry
+    // touches only the envelope concerned.
+    std::unordered_map<std::size_t, EnvelopeEntry> m_envelopeEntries;
+    TimerWheel m_timers;  // ticks are game milliseconds
+    struct TrackedPlayer {
+        std::string id;
+        std::uint64_t sequence;
+        std::chrono::steady_clock::time_point lastSeen;
+    };
+    // Players by last input, least recent first, indexed by id.
+    std::list<TrackedPlayer> m_playerOrder;
+    std::unordered_map<std::string, std::list<TrackedPlayer>::iterator> m_inputSequences;
+    std::unique_ptr<SharedStateWriter> m_sharedState;  // null unless exported
+
+    std::uint64_t gameMillis() const;
+    // update() without publishing, for callers that publish themselves.
+    std::size_t advanceTimers();
+    void publishSharedState();
     RedEnvelope createRandomEnvelope(std::size_t id);
+    // Bulk path for reset and rain: places count envelopes at once with
+    // Poisson-disk spacing instead of one rejection scan each.
+    void placeEnvelopes(std::size_t count);
+    void addEnvelope();
+    void trackEnvelope(std::size_t index);
+    void forgetEnvelope(std::size_t id);
+    void expireEnvelope(std::size_t id);
+    int spawnEnvelopes(int minCount, int maxCount);
+    void scheduleRain();
     void respawnEnvelope(std::size_t index);
     void handleCollisions(double previousX, double previousY);
     bool intersectsMovementPath(double startX,
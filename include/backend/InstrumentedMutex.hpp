@@ -0,0 +1,71 @@
+// File: InstrumentedMutex.hpp
+// Description: Declares a drop-in std::mutex replacement that records, per
+//              lock name, how often it is taken, how often callers had to
+//              wait, and histograms of wait and hold times. All instances
+//              sharing a name are aggregated; LockRegistry reads the totals
+//              for /metrics and /debug/locks.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace backend {
+
+// Wait and hold histograms share power-of-four buckets from 256 ns to 1 s;
+// the last bucket has no upper bound.
+constexpr std::size_t kLockHistogramBuckets = 13;
+using LockHistogram = std::array<std::uint64_t, kLockHistogramBuckets>;
+
+struct LockStatsSnapshot {
+    std::string name;
+    std::uint64_t acquisitions{0};
+    // Acquisitions that found the lock held and had to block.
+    std::uint64_t contended{0};
+    std::uint64_t waitNanos{0};
+    std::uint64_t maxWaitNanos{0};
+    std::uint64_t holdNanos{0};
+    // Only contended acquisitions are recorded here.
+    LockHistogram waitBuckets{};
+    LockHistogram holdBuckets{};
+};
+
+class LockRegistry {
+public:
+    // Upper bound in nanoseconds of each bucket except the last.
+    static const std::array<std::uint64_t, kLockHistogramBuckets - 1>& bucketBoundsNanos();
+
+    // One entry per lock name, in registration order.
+    static std::vector<LockStatsSnapshot> snapshot();
+};
+
+struct LockCounters;
+
+// Meets the Lockable requirements, so it works with std::lock_guard and
+// std::unique_lock; wait on it with std::condition_variable_any.
+// An uncontended lock/unlock costs two clock reads and two relaxed atomic
+// increments on top of the underlying std::mutex.
+class InstrumentedMutex {
+public:
+    // name must outlive the mutex (a string literal).
+    explicit InstrumentedMutex(const char* name);
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+private:
+    std::mutex m_mutex;
+    LockCounters* m_counters;
+    // Written only by the holder.
+    std::int64_t m_acquiredAtNanos{0};
+};
+
+}  // namespace backend
@@ -4,7 +4,8 @@
 
 #pragma once
 
-#include <mutex>
+#include "backend/InstrumentedMutex.hpp"
+
 #include <string>
 
 namespace backend {
@@ -23,7 +24,7 @@ private:
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
-    std::mutex m_mutex;
+    InstrumentedMutex m_mutex{"logger"};
     std::string m_logFilePath;
     bool m_initialized{false};
     struct Impl;
@@ -0,0 +1,52 @@
+// File: PoissonDiskSampler.hpp
+// Description: Declares bulk placement of points on the integer world grid
+//              with Bridson's Poisson-disk sampling, so large envelope rains
+//              come out evenly spread (blue noise) in time linear in the
+//              number of points instead of one rejection scan per point.
+
+#pragma once
+
+#include "RedEnvelope.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace backend {
+
+class PoissonDiskSampler {
+public:
+    // Extra per-point constraint, e.g. keeping clear of the tank; index is
+    // the position of the point in the result.
+    using Accept = std::function<bool(Position, std::size_t index)>;
+
+    PoissonDiskSampler(int width, int height, std::mt19937& rng);
+
+    // Marks a cell as taken: no sample lands on it and samples keep their
+    // spacing from it.
+    void occupy(Position position);
+
+    // Returns count positions. The spacing starts at the widest radius that
+    // should fit count more points among the occupied ones and shrinks while
+    // the board saturates; once even neighbouring cells are full, remaining
+    // points go to free cells and finally anywhere accept allows.
+    std::vector<Position> sample(std::size_t count, const Accept& accept);
+
+private:
+    // One Bridson pass at a fixed minimum distance, appending to placed.
+    void runPass(double radius, std::size_t count, const Accept& accept, std::vector<Position>& placed);
+    void fillFreeCells(std::size_t count, const Accept& accept, std::vector<Position>& placed);
+    bool inBounds(Position position) const noexcept;
+    std::size_t cellIndex(Position position) const noexcept;
+    Position randomCell();
+
+    int m_width;
+    int m_height;
+    std::mt19937& m_rng;
+    std::vector<std::uint8_t> m_occupied;  // one byte per world cell
+    std::vector<Position> m_points;  // occupied cells, then placed samples
+};
+
+}  // namespace backend
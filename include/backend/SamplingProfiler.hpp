@@ -0,0 +1,54 @@
+// File: SamplingProfiler.hpp
+// Description: Declares an in-process sampling CPU profiler. While a
+//              profile runs, a CPU-time timer raises SIGPROF on whichever
+//              thread is burning CPU; the handler walks that thread's frame
+//              pointers into a lock-free table, and the result is returned
+//              as folded stacks for flame graph tools. Nothing is installed
+//              or armed between profiles.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace backend {
+
+struct ProfileOptions {
+    std::chrono::milliseconds duration{10000};
+    // Samples per CPU-second; a prime avoids lockstep with periodic work.
+    int frequencyHz{99};
+};
+
+struct ProfileResult {
+    // One "outer;...;inner count" line per distinct stack.
+    std::string folded;
+    std::uint64_t samples{0};
+    // Samples lost because the stack table was full.
+    std::uint64_t dropped{0};
+    std::size_t uniqueStacks{0};
+};
+
+class SamplingProfiler {
+public:
+    static SamplingProfiler& instance();
+
+    static bool supported();
+
+    // Profiles the whole process for options.duration, blocking the caller.
+    // Returns false with error set if a profile is already running or the
+    // platform cannot sample.
+    bool profile(const ProfileOptions& options, ProfileResult& result, std::string& error);
+
+private:
+    SamplingProfiler() = default;
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    std::atomic<bool> m_running{false};
+};
+
+}  // namespace backend
@@ -0,0 +1,197 @@
+// File: SharedState.hpp
+// Description: Layout of the shared-memory game state export and a
+//              header-only reader for co-located processes (overlays, bots,
+//              recorders). The server rewrites the segment under a seqlock
+//              whenever the game changes; readers copy it out with plain
+//              loads and retry if a write overlapped, so a read takes no
+//              syscalls, no locks and never blocks the server.
+//
+//              Include this file alone; it needs nothing else from the repo.
+//              On older glibc, link readers with -lrt.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace backend {
+
+constexpr std::uint32_t kSharedStateMagic = 0x534b4e54;  // "TNKS" little-endian
+constexpr std::uint32_t kSharedStateVersion = 1;
+
+// Values of SharedEnvelope::size and SharedStateSnapshot::tankDirection
+// follow EnvelopeSize and MoveDirection in declaration order.
+struct SharedEnvelope {
+    std::uint64_t id;
+    std::int32_t x;
+    std::int32_t y;
+    std::int32_t value;
+    std::uint8_t size;  // 0 small, 1 medium, 2 large
+    std::uint8_t radius;
+    std::uint8_t reserved[2];
+};
+
+struct SharedStateSnapshot {
+    // Bumped on every publish, so a reader can tell updates apart.
+    std::uint64_t publishCount;
+    // std::chrono::steady_clock at publish time, in nanoseconds. On Linux
+    // this is CLOCK_MONOTONIC, which every process on the host shares.
+    std::int64_t publishedNanos;
+    // Game time at publish; it only advances while not paused.
+    std::uint64_t elapsedMillis;
+    std::int32_t worldWidth;
+    std::int32_t worldHeight;
+    std::int32_t timeLimitSeconds;
+    std::uint8_t paused;
+    std::uint8_t timeUp;
+    std::uint8_t reserved[2];
+    // Tank position in cells and in the engine's fixed-point units.
+    std::int32_t tankX;
+    std::int32_t tankY;
+    std::int32_t tankStep;
+    std::int32_t tankDirection;  // up, down, left, right, none
+    std::int64_t tankUnitsX;
+    std::int64_t tankUnitsY;
+    std::int64_t tankMomentumUnits;
+    std::int32_t collectedCount;
+    std::int32_t collectedValue;
+    // Envelopes in the segment, and on the board (more if the board
+    // outgrew the segment's capacity).
+    std::uint32_t envelopeCount;
+    std::uint32_t envelopeTotal;
+};
+
+// The segment: this header, then envelopeCapacity SharedEnvelope entries.
+struct SharedStateHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t envelopeCapacity;
+    std::uint32_t headerBytes;
+    // Odd while the writer is mid-update. Kept on its own cache line so
+    // polling it does not contend with the payload.
+    alignas(64) std::atomic<std::uint64_t> sequence;
+    alignas(64) SharedStateSnapshot snapshot;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "The seqlock counter must be lock-free to live in shared memory.");
+static_assert(sizeof(SharedEnvelope) == 24, "SharedEnvelope layout changed; bump kSharedStateVersion.");
+static_assert(sizeof(SharedStateHeader) % alignof(SharedEnvelope) == 0, "Envelope array must stay aligned.");
+
+inline SharedEnvelope* sharedEnvelopes(SharedStateHeader* header) noexcept {
+    return reinterpret_cast<SharedEnvelope*>(reinterpret_cast<unsigned char*>(header) + sizeof(SharedStateHeader));
+}
+
+inline const SharedEnvelope* sharedEnvelopes(const SharedStateHeader* header) noexcept {
+    return reinterpret_cast<const SharedEnvelope*>(reinterpret_cast<const unsigned char*>(header) +
+                                                   sizeof(SharedStateHeader));
+}
+
+inline std::size_t sharedStateBytes(std::uint32_t envelopeCapacity) noexcept {
+    return sizeof(SharedStateHeader) + static_cast<std::size_t>(envelopeCapacity) * sizeof(SharedEnvelope);
+}
+
+// Game seconds left now, extrapolated from the snapshot's publish time.
+inline double sharedTimeLeftSeconds(const SharedStateSnapshot& snapshot) {
+    double elapsed = static_cast<double>(snapshot.elapsedMillis) / 1000.0;
+    if (!snapshot.paused && !snapshot.timeUp) {
+        const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count();
+        elapsed += static_cast<double>(std::max<std::int64_t>(0, now - snapshot.publishedNanos)) / 1e9;
+    }
+    return std::max(0.0, static_cast<double>(snapshot.timeLimitSeconds) - elapsed);
+}
+
+// Maps the segment read-only. Open it after the server has started; if the
+// server restarts it creates a fresh segment, so reopen when version()
+// stops changing for longer than expected.
+class SharedStateReader {
+public:
+    // name as passed to TANK_SHM_NAME, e.g. "/tank_state". Throws
+    // std::runtime_error if the segment is missing or from another version.
+    explicit SharedStateReader(const std::string& name) {
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open shared state " + name + ": " + std::strerror(errno));
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(SharedStateHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Shared state " + name + " is truncated.");
+        }
+        m_bytes = static_cast<std::size_t>(info.st_size);
+        void* base = ::mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("Cannot map shared state " + name + ": " + std::strerror(errno));
+        }
+        m_header = static_cast<const SharedStateHeader*>(base);
+        if (m_header->magic != kSharedStateMagic || m_header->version != kSharedStateVersion ||
+            m_header->headerBytes != sizeof(SharedStateHeader) ||
+            sharedStateBytes(m_header->envelopeCapacity) > m_bytes) {
+            ::munmap(base, m_bytes);
+            throw std::runtime_error("Shared state " + name + " has an unexpected layout.");
+        }
+        m_capacity = m_header->envelopeCapacity;
+    }
+
+    ~SharedStateReader() { ::munmap(const_cast<SharedStateHeader*>(m_header), m_bytes); }
+
+    SharedStateReader(const SharedStateReader&) = delete;
+    SharedStateReader& operator=(const SharedStateReader&) = delete;
+
+    // Changes with every publish; one load, for cheap change detection.
+    std::uint64_t version() const noexcept { return m_header->sequence.load(std::memory_order_acquire); }
+
+    // Copies a consistent snapshot and its envelopes. Returns false if every
+    // attempt overlapped a write (or the server died mid-write).
+    bool read(SharedStateSnapshot& snapshot, std::vector<SharedEnvelope>& envelopes, int maxAttempts = 1000) const {
+        envelopes.reserve(m_capacity);
+        for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+            if (attempt >= kSpinAttempts) {
+                // The writer is taking long enough to have been preempted;
+                // let it run instead of spinning out the time slice.
+                std::this_thread::yield();
+            }
+            const std::uint64_t before = m_header->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            std::memcpy(&snapshot, &m_header->snapshot, sizeof(snapshot));
+            // A torn count is caught by the sequence check below, but must
+            // not send the copy past the segment first.
+            const std::size_t count = std::min<std::size_t>(snapshot.envelopeCount, m_capacity);
+            envelopes.resize(count);
+            std::memcpy(envelopes.data(), sharedEnvelopes(m_header), count * sizeof(SharedEnvelope));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_header->sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr int kSpinAttempts = 64;
+
+    const SharedStateHeader* m_header{nullptr};
+    std::size_t m_bytes{0};
+    std::uint32_t m_capacity{0};
+};
+
+}  // namespace backend
@@ -0,0 +1,43 @@
+// File: SharedStateWriter.hpp
+// Description: Declares the writer side of the shared-memory state export:
+//              owns the POSIX segment described in SharedState.hpp and
+//              rewrites it from the engine under the seqlock.
+
+#pragma once
+
+#include "SharedState.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace backend {
+
+class GameEngine;
+
+class SharedStateWriter {
+public:
+    // Creates the segment (replacing a stale one of the same name) with room
+    // for envelopeCapacity envelopes. Throws std::runtime_error on failure.
+    SharedStateWriter(std::string name, std::size_t envelopeCapacity);
+    // Unmaps and unlinks the segment.
+    ~SharedStateWriter();
+
+    SharedStateWriter(const SharedStateWriter&) = delete;
+    SharedStateWriter& operator=(const SharedStateWriter&) = delete;
+
+    // Copies the engine's current state into the segment. Called with the
+    // engine's lock held, so there is only ever one writer.
+    void publish(const GameEngine& engine);
+
+    const std::string& name() const noexcept { return m_name; }
+
+private:
+    std::string m_name;
+    SharedStateHeader* m_header{nullptr};
+    std::size_t m_bytes{0};
+    std::uint32_t m_capacity{0};
+    std::uint64_t m_publishCount{0};
+};
+
+}  // namespace backend
@@ -1,16 +1,24 @@
 // File: Tank.hpp
 // Description: Declares the tank entity responsible for player movement actions.
+//              Movement runs in integer sub-cell units so it is exactly
+//              reproducible: clients predict moves with the same integer
+//              steps and match the server bit for bit.
 
 #pragma once
 
 #include "RedEnvelope.hpp"
 
+#include <cstdint>
+
 namespace backend {
 
 enum class MoveDirection { Up, Down, Left, Right, None };
 
 class Tank {
 public:
+    // Sub-cell units per cell used for exact positions and momentum.
+    static constexpr std::int64_t kUnitsPerCell = 1000;
+
     explicit Tank(Position startPosition, int moveStep = 1);
 
     Position getPosition() const noexcept;
@@ -18,18 +26,25 @@ public:
     double getExactY() const noexcept;
     int getMoveStep() const noexcept;
 
+    // Raw movement state, in sub-cell units: what a client needs to replay
+    // unacknowledged moves on top of the server's answer.
+    std::int64_t getUnitsX() const noexcept;
+    std::int64_t getUnitsY() const noexcept;
+    std::int64_t getMomentumUnits() const noexcept;
+    MoveDirection getLastDirection() const noexcept;
+
     bool move(MoveDirection direction, int worldWidth, int worldHeight) noexcept;
     void setPosition(Position newPosition) noexcept;
 
 private:
     Position m_position;
     int m_moveStep;
-    double m_exactX;
-    double m_exactY;
-    double m_currentMomentum{0.0};
-    double m_momentumIncrement{0.0};
-    double m_momentumDecay{0.0};
-    double m_momentumMax{0.0};
+    std::int64_t m_unitsX;
+    std::int64_t m_unitsY;
+    std::int64_t m_currentMomentum{0};
+    std::int64_t m_momentumIncrement{0};
+    std::int64_t m_momentumDecay{0};
+    std::int64_t m_momentumMax{0};
     MoveDirection m_lastDirection{MoveDirection::None};
 };
 
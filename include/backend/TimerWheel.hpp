@@ -0,0 +1,91 @@
+// File: TimerWheel.hpp
+// Description: Declares a hierarchical timing wheel for scheduled game events.
+//              Time is an abstract tick counter that only moves when the owner
+//              calls advance(), so a paused clock simply stops advancing.
+//              schedule() and cancel() are O(1); advance() jumps straight to
+//              the next occupied slot using per-level occupancy bitmaps, so it
+//              costs one step per due timer (plus at most one cascade per
+//              level), however far time moves.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace backend {
+
+using TimerId = std::uint64_t;
+constexpr TimerId kInvalidTimer = 0;
+
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+
+    // 6 levels of 64 slots cover 2^36 ticks (about 795 days at 1 ms).
+    static constexpr std::size_t kLevels = 6;
+    static constexpr std::size_t kSlotBits = 6;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+    static constexpr std::uint64_t kMaxDelay = (std::uint64_t{1} << (kLevels * kSlotBits)) - 1;
+
+    TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Runs callback once now() has moved delayTicks past the current tick
+    // (at least one tick; longer delays are clamped to kMaxDelay).
+    TimerId schedule(std::uint64_t delayTicks, Callback callback);
+    // Returns false if the timer already fired or was cancelled.
+    bool cancel(TimerId id);
+    bool pending(TimerId id) const noexcept;
+
+    // Fires every timer due at or before target in expiry order (ties in no
+    // particular order) and leaves now() at target. Callbacks may schedule
+    // and cancel timers; ones due by target fire in the same call. Returns
+    // the number fired.
+    std::size_t advance(std::uint64_t target);
+
+    // Drops all timers without running them and restarts at tick 0.
+    void clear();
+
+    // Earliest tick after now() with work to do, or UINT64_MAX when empty.
+    // Never later than the next expiry; it may be an earlier cascade step.
+    std::uint64_t nextTick() const noexcept;
+
+    std::uint64_t now() const noexcept { return m_now; }
+    std::size_t size() const noexcept { return m_size; }
+
+private:
+    static constexpr std::uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        std::uint64_t expiry{0};
+        Callback callback;
+        std::uint32_t prev{kNil};
+        std::uint32_t next{kNil};
+        // Bumped on release so stale TimerIds never match a reused node.
+        std::uint32_t generation{0};
+        std::uint8_t level{0};
+        std::uint8_t slot{0};
+        bool active{false};
+    };
+
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascade(std::size_t level, std::size_t slot);
+    std::size_t fireSlot(std::size_t slot);
+    const Node* lookup(TimerId id) const noexcept;
+
+    std::vector<Node> m_nodes;
+    std::vector<std::uint32_t> m_free;
+    std::array<std::array<std::uint32_t, kSlots>, kLevels> m_heads;
+    std::array<std::uint64_t, kLevels> m_occupied{};
+    std::uint64_t m_now{0};
+    std::size_t m_size{0};
+};
+
+}  // namespace backend
@@ -0,0 +1,84 @@
+// File: Tracing.hpp
+// Description: Declares lightweight request tracing. Scoped spans are
+//              timestamped with the CPU cycle counter and appended to a
+//              per-thread ring buffer, but only while a capture is running
+//              and only for sampled requests; a capture returns the spans
+//              as Chrome trace-event JSON (loadable in Perfetto).
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace backend {
+
+struct TraceOptions {
+    // Fraction of requests whose spans are recorded during a capture.
+    double sampleRate{1.0};
+    // Ring capacity per thread; older spans are overwritten.
+    std::size_t eventsPerThread{1024};
+
+    // Reads TANK_TRACE_SAMPLE_RATE and TANK_TRACE_BUFFER_EVENTS.
+    static TraceOptions fromEnvironment();
+};
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // Applies to requests started afterwards; buffers already handed to
+    // threads keep their size.
+    void configure(const TraceOptions& options);
+
+    // Marks the start of a request on the calling thread and decides whether
+    // its spans are recorded. Outside a capture this is one atomic load.
+    void beginRequest();
+    bool sampled() const noexcept;
+
+    // Records a finished span for the current request if it is sampled.
+    // detail is truncated to a few dozen bytes.
+    void record(const char* name, std::uint64_t beginTicks, std::uint64_t endTicks, std::string_view detail = {});
+
+    // Records spans for the given window, blocking the caller, and returns
+    // them as a Chrome trace_event JSON document.
+    std::string capture(std::chrono::milliseconds window);
+
+    // Cycle counter on x86-64, steady_clock nanoseconds elsewhere.
+    static std::uint64_t now() noexcept;
+
+private:
+    Tracer();
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+    std::atomic<int> m_captures{0};
+};
+
+// Times the enclosing scope (or until end()) as one span of the current request.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) noexcept;
+    ~TraceSpan() { end(); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void setDetail(std::string_view detail);
+    void end();
+
+private:
+    const char* m_name;
+    std::uint64_t m_begin{0};
+    std::string m_detail;
+};
+
+}  // namespace backend
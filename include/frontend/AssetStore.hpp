@@ -0,0 +1,65 @@
+// File: AssetStore.hpp
+// Description: Declares the browser assets compiled into the server binary
+//              (see tools/embed_assets.cpp) and the lookup used to serve
+//              them. With TANK_ASSET_DIR set, pages and images are read from
+//              disk on every request instead so edits show without a rebuild.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace frontend {
+
+struct EmbeddedAsset {
+    const char* path;  // URL path, e.g. "/static/duck.png"
+    const char* contentType;
+    // 64-bit FNV-1a of the body in hex; the ETag is derived from it.
+    const char* hash;
+    const unsigned char* data;
+    std::size_t size;
+    // gzip variant, or null when compression saves less than a tenth.
+    const unsigned char* gzipData;
+    std::size_t gzipSize;
+    // Content-hashed path (/static/duck.<hash>.png): the bytes behind it
+    // never change, so clients may cache it for a year without revalidating.
+    bool immutable;
+};
+
+// Generated into build/generated/EmbeddedAssets.cpp, sorted by path.
+extern const EmbeddedAsset kEmbeddedAssets[];
+extern const std::size_t kEmbeddedAssetCount;
+
+struct AssetStoreOptions {
+    // Project root to read assets from instead of the embedded copies
+    // (TANK_ASSET_DIR); empty serves the embedded ones.
+    std::string overrideDir;
+    // Subdirectory of overrideDir holding the pages served from "/".
+    std::string pagesDir{"web"};
+
+    static AssetStoreOptions fromEnvironment(std::string pagesDir);
+};
+
+class AssetStore {
+public:
+    explicit AssetStore(AssetStoreOptions options);
+
+    // Embedded asset for a URL path ("/" is "/index.html"), or null.
+    // Content-hashed paths resolve to immutable entries.
+    const EmbeddedAsset* find(std::string_view path) const;
+
+    bool overridden() const noexcept { return !m_options.overrideDir.empty(); }
+    // File under overrideDir for a URL path, mirroring the embed step:
+    // "/static/x" -> static/x, "/x" -> <pagesDir>/x. Empty for paths that
+    // would leave the directory.
+    std::string overridePath(std::string_view path) const;
+
+private:
+    AssetStoreOptions m_options;
+    // Built once from the embedded table so lookups are a single probe.
+    std::unordered_map<std::string_view, const EmbeddedAsset*> m_index;
+};
+
+}  // namespace frontend
@@ -0,0 +1,50 @@
+// File: ChunkedJsonWriter.hpp
+// Description: Declares a small buffered writer that streams a JSON document
+//              to a client socket using HTTP/1.1 chunked transfer encoding.
+
+#pragma once
+
+#include "frontend/OutputQueue.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace frontend {
+
+// Appends value to out with JSON string escaping (without surrounding quotes).
+void appendJsonEscaped(std::string& out, std::string_view value);
+
+class ChunkedJsonWriter {
+public:
+    // Chunks go through an OutputQueue, so writeRaw() blocks once the client
+    // falls output.highWaterBytes behind.
+    ChunkedJsonWriter(int clientSocket, const OutputQueueOptions& output, std::size_t chunkSize = 16 * 1024);
+
+    // Sends the status line and headers; must be called once before writing.
+    bool begin(const std::string& statusLine, const std::string& contentType = "application/json");
+
+    // Buffers raw JSON text, flushing a chunk whenever the buffer is full.
+    bool writeRaw(std::string_view text);
+    // Buffers a quoted, escaped JSON string.
+    bool writeString(std::string_view value);
+
+    // Queues buffered data as a chunk right away (e.g. after each SSE event)
+    // and writes whatever the socket accepts, including earlier leftovers.
+    bool flush();
+
+    // Flushes pending data, sends the terminating zero-length chunk and
+    // waits until the client has taken all of it.
+    bool finish();
+
+    bool failed() const noexcept;
+
+private:
+    bool flushChunk();
+
+    OutputQueue m_output;
+    std::size_t m_chunkSize;
+    std::string m_buffer;
+};
+
+}  // namespace frontend
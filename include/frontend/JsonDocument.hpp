@@ -0,0 +1,109 @@
+// File: JsonDocument.hpp
+// Description: Declares an on-demand JSON reader. Construction builds a
+//              structural index of the input (SSE2 when available, scalar
+//              otherwise); values are only located and decoded when a
+//              caller asks for them, e.g. by path "choices[0].message.content".
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace frontend {
+
+class JsonDocument;
+
+enum class JsonType { Invalid, Object, Array, String, Number, Boolean, Null };
+
+enum class JsonIndexMode {
+    Auto,   // SSE2 when the build target has it
+    Scalar  // byte-at-a-time reference path (used by benchmarks)
+};
+
+// Lightweight handle to one value inside a JsonDocument. Lookups on a
+// missing member, an out-of-range index or a malformed value yield an
+// Invalid handle, so chained lookups need no intermediate checks.
+class JsonValue {
+public:
+    JsonValue() = default;
+
+    JsonType type() const;
+    bool valid() const { return type() != JsonType::Invalid; }
+    bool isNull() const { return type() == JsonType::Null; }
+
+    // Direct object member (first match for duplicate keys); nested objects
+    // are skipped over, never searched.
+    JsonValue operator[](std::string_view key) const;
+    JsonValue operator[](std::size_t index) const;
+    JsonValue operator[](int index) const { return (*this)[static_cast<std::size_t>(index)]; }
+    // Dotted path with bracketed indices, e.g. "choices[0].delta.content".
+    // A negative index counts from the end of the array ("messages[-1]").
+    JsonValue at(std::string_view path) const;
+    // Number of elements (arrays) or members (objects); 0 for scalars.
+    std::size_t size() const;
+
+    // Decode on demand; return false (leaving out untouched) on a type mismatch.
+    bool getString(std::string& out) const;
+    bool getBool(bool& out) const;
+    bool getInt64(std::int64_t& out) const;
+    bool getDouble(double& out) const;
+
+    std::string stringOr(std::string fallback) const;
+    bool boolOr(bool fallback) const;
+
+    // Source text of the value (strings include their quotes).
+    std::string_view raw() const;
+
+private:
+    friend class JsonDocument;
+    JsonValue(const JsonDocument* doc, std::uint32_t begin, std::uint32_t entry)
+        : m_doc(doc), m_begin(begin), m_entry(entry) {}
+
+    // Index entry just past this value: the ',' / '}' / ']' that follows it.
+    std::uint32_t endEntry() const;
+    std::string_view rawStringBody() const;
+
+    const JsonDocument* m_doc{nullptr};
+    std::uint32_t m_begin{0};  // byte offset of the first character
+    std::uint32_t m_entry{0};  // own entry for containers/strings, terminator for scalars
+};
+
+class JsonDocument {
+public:
+    // The document refers to json without copying it; keep the text alive.
+    explicit JsonDocument(std::string_view json, JsonIndexMode mode = JsonIndexMode::Auto);
+
+    // False for unterminated strings, mismatched brackets or trailing data.
+    // Scalars are only checked when read.
+    bool valid() const { return m_valid; }
+    JsonValue root() const;
+    JsonValue at(std::string_view path) const { return root().at(path); }
+
+    static bool simdAvailable();
+
+private:
+    friend class JsonValue;
+
+    void buildIndexScalar();
+    void buildIndexSimd();
+    bool matchBrackets();
+    JsonValue valueAfter(std::uint32_t entry) const;
+    std::uint32_t entryPosition(std::uint32_t entry) const { return m_entries[entry].position; }
+    std::uint32_t matchingEntry(std::uint32_t entry) const { return m_entries[entry].matching; }
+
+    struct Entry {
+        std::uint32_t position;  // byte offset
+        std::uint32_t matching;  // for '{' / '[': entry of the closing bracket
+    };
+
+    std::string_view m_json;
+    // { } [ ] : , and every opening quote outside strings, in order,
+    // followed by a sentinel at m_json.size().
+    std::vector<Entry> m_entries;
+    bool m_valid{false};
+};
+
+}  // namespace frontend
@@ -4,9 +4,11 @@
 
 #pragma once
 
-#include <mutex>
+#include <cstddef>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace frontend {
 
@@ -16,21 +18,46 @@ struct UserLayoutPreferences {
     bool compactMode{false};
 };
 
+struct LayoutStoreOptions {
+    // Directory holding layout.snap (mmap'd snapshot) and layout.log (append-only updates).
+    std::string directory{"data/layout"};
+    // fdatasync the log once per committed batch.
+    bool syncOnCommit{true};
+    // Rewrite the snapshot and truncate the log after this many logged updates.
+    std::size_t snapshotEveryRecords{100000};
+};
+
+// Reads are lock-free: preferences live in immutable shards that writers
+// replace copy-on-write and publish atomically (RCU style). Writes are
+// group-committed by a background writer thread.
 class LayoutManager {
 public:
     LayoutManager();
+    explicit LayoutManager(LayoutStoreOptions options);
     ~LayoutManager();
 
+    LayoutManager(const LayoutManager&) = delete;
+    LayoutManager& operator=(const LayoutManager&) = delete;
+
+    // Loads the snapshot, replays the log on top of it and starts the writer.
+    // Throws if the store cannot be opened or read; the manager then keeps
+    // working memory-only, without persistence.
     void initialize();
+    // Returns once the update is logged and visible to readers. Throws
+    // std::runtime_error, with nothing from the call applied, if the log
+    // append fails or a new theme or preset no longer fits the string table.
     void applyPreferences(const std::string& userId, const UserLayoutPreferences& preferences);
+    void applyPreferencesBatch(
+        const std::vector<std::pair<std::string, UserLayoutPreferences>>& updates);
     UserLayoutPreferences getPreferences(const std::string& userId) const;
     std::string exportPreferences(const std::string& userId) const;
+    // Writes a fresh snapshot and truncates the log.
     void persist();
+    std::size_t userCount() const;
 
 private:
-    mutable std::mutex m_mutex;
-    std::unordered_map<std::string, UserLayoutPreferences> m_userPreferences;
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
 };
 
 }  // namespace frontend
-
@@ -0,0 +1,102 @@
+// File: OutputQueue.hpp
+// Description: Declares the per-connection output queue. Responses are
+//              appended as owned buffers or file ranges and written to a
+//              non-blocking socket as it becomes writable, resuming partial
+//              writes. A producer that gets more than highWaterBytes ahead of
+//              the client is paused until the backlog drains to lowWaterBytes.
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace frontend {
+
+struct OutputQueueOptions {
+    // Queued bytes at which append() stops returning to the producer until
+    // the client has read down to lowWaterBytes (TANK_OUTPUT_HIGH_WATER;
+    // the low-water mark is a quarter of it).
+    std::size_t highWaterBytes{1024 * 1024};
+    std::size_t lowWaterBytes{256 * 1024};
+    // A client that accepts no bytes for this long is dropped
+    // (TANK_SEND_TIMEOUT_MS).
+    std::chrono::milliseconds sendTimeout{30000};
+
+    static OutputQueueOptions fromEnvironment();
+};
+
+// Process-wide counters for /metrics.
+struct OutputQueueStats {
+    std::uint64_t bytesSent{0};
+    // Write attempts that found the socket buffer full.
+    std::uint64_t wouldBlock{0};
+    // Times a producer was paused at the high-water mark.
+    std::uint64_t backpressurePauses{0};
+    std::uint64_t sendTimeouts{0};
+};
+
+class OutputQueue {
+public:
+    // Switches clientSocket to non-blocking mode; the caller keeps owning it.
+    OutputQueue(int clientSocket, const OutputQueueOptions& options);
+    // Closes any file descriptors still queued; unsent data is dropped.
+    ~OutputQueue();
+
+    OutputQueue(const OutputQueue&) = delete;
+    OutputQueue& operator=(const OutputQueue&) = delete;
+
+    // Appends only queue, so consecutive pieces go out in one gathered
+    // write; past highWaterBytes they wait for the client to catch up.
+    // Both return false once the connection has failed.
+    bool append(std::string data);
+    // Queues memory without copying it; it must outlive the queue
+    // (embedded assets, string literals).
+    bool appendStatic(std::string_view data);
+    // Takes ownership of fd and sends [offset, offset + length) from it.
+    bool appendFile(int fd, off_t offset, std::size_t length);
+
+    // Writes whatever the socket takes now, without waiting.
+    bool trySend();
+    // Waits until everything queued has been written.
+    bool flush();
+
+    bool failed() const noexcept { return m_failed; }
+    std::size_t pendingBytes() const noexcept { return m_pendingBytes; }
+
+    static OutputQueueStats stats();
+
+private:
+    struct Segment {
+        std::string data;
+        const char* borrowed{nullptr};  // used instead of data when set
+        int fd{-1};  // file range when >= 0
+        off_t offset{0};
+        std::size_t length{0};
+        std::size_t sent{0};
+
+        const char* bytes() const { return borrowed ? borrowed : data.data(); }
+    };
+
+    bool afterAppend();
+    // Writes until at most target bytes are pending; waits for POLLOUT
+    // only when wait is set.
+    bool drain(std::size_t target, bool wait);
+    // One write attempt on the front segment(s); returns bytes written, 0 if
+    // the socket is full, -1 on error.
+    ssize_t writeSome();
+    void popFront();
+
+    int m_socket;
+    OutputQueueOptions m_options;
+    std::deque<Segment> m_segments;
+    std::size_t m_pendingBytes{0};
+    bool m_failed{false};
+};
+
+}  // namespace frontend
@@ -0,0 +1,107 @@
+// File: RequestScheduler.hpp
+// Description: Declares admission scheduling for request handlers. Routes are
+//              grouped into priority classes; at most `workers` handlers run
+//              at once and waiting requests are admitted from per-class FIFO
+//              queues by weighted round robin or strict priority, with aging
+//              so a lower class never waits longer than maxWait while the
+//              server has free slots for it.
+
+#pragma once
+
+#include "backend/InstrumentedMutex.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace frontend {
+
+// Declared from most to least latency-critical.
+enum class PriorityClass : std::uint8_t { Input = 0, State, Static, Analytics, Admin };
+constexpr std::size_t kPriorityClassCount = 5;
+
+const char* priorityClassName(PriorityClass priorityClass);
+
+enum class SchedulingPolicy { Weighted, Strict };
+
+struct RequestSchedulerOptions {
+    // Handlers allowed to run at once (TANK_SCHED_WORKERS).
+    std::size_t workers{4};
+    // Slots only Input and State requests may take, so a burst of static or
+    // analytics work cannot occupy every worker (TANK_SCHED_RESERVED).
+    std::size_t reservedSlots{1};
+    // TANK_SCHED_POLICY: "weighted" or "strict".
+    SchedulingPolicy policy{SchedulingPolicy::Weighted};
+    // Share of admissions per class under the weighted policy, in
+    // PriorityClass order (TANK_SCHED_WEIGHTS, e.g. "8,4,2,1,1").
+    std::array<std::uint32_t, kPriorityClassCount> weights{8, 4, 2, 1, 1};
+    // A queue head older than this is admitted ahead of policy order
+    // (TANK_SCHED_MAX_WAIT_MS).
+    std::chrono::milliseconds maxWait{250};
+    // Requests beyond this many waiting in one class are rejected
+    // (TANK_SCHED_MAX_QUEUED).
+    std::size_t maxQueuedPerClass{256};
+
+    static RequestSchedulerOptions fromEnvironment();
+};
+
+struct PriorityClassStats {
+    std::string name;
+    std::size_t queued{0};
+    std::size_t running{0};
+    std::uint64_t admitted{0};
+    std::uint64_t rejected{0};
+    // Admissions that jumped policy order because the head exceeded maxWait.
+    std::uint64_t promoted{0};
+    std::uint64_t waitNanos{0};
+    std::uint64_t maxWaitNanos{0};
+    // Queue wait of every admission, on the lock histogram buckets.
+    backend::LockHistogram waitBuckets{};
+};
+
+class RequestScheduler {
+public:
+    // Holds one worker slot until destroyed or released.
+    class Ticket {
+    public:
+        Ticket() = default;
+        ~Ticket();
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+        explicit operator bool() const { return m_scheduler != nullptr; }
+
+        void release();
+
+    private:
+        friend class RequestScheduler;
+
+        RequestScheduler* m_scheduler{nullptr};
+        PriorityClass m_class{PriorityClass::Input};
+    };
+
+    explicit RequestScheduler(RequestSchedulerOptions options = RequestSchedulerOptions{});
+    ~RequestScheduler();
+
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+    // Blocks until a slot is granted. Returns an empty ticket, without
+    // waiting, when the class queue is full.
+    Ticket acquire(PriorityClass priorityClass);
+
+    // One entry per class, in PriorityClass order.
+    std::vector<PriorityClassStats> stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace frontend
@@ -0,0 +1,71 @@
+// File: ResponseCache.hpp
+// Description: Declares an in-memory LRU + TTL cache for upstream responses
+//              with a byte budget and per-key request coalescing, so
+//              identical concurrent prompts share a single upstream call.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace frontend {
+
+struct ResponseCacheOptions {
+    // Total bytes (keys + bodies) kept before least recently used entries go.
+    std::size_t maxBytes{8 * 1024 * 1024};
+    // Larger responses are returned but never stored.
+    std::size_t maxEntryBytes{256 * 1024};
+    std::chrono::seconds ttl{600};
+
+    // Reads DUCKAI_CACHE_BYTES and DUCKAI_CACHE_TTL_SECONDS; a zero budget disables storage.
+    static ResponseCacheOptions fromEnvironment();
+};
+
+struct CachedResponse {
+    int statusCode{200};
+    std::string body;
+};
+
+struct ResponseCacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t coalesced{0};  // callers that waited on another caller's load
+    std::uint64_t evictions{0};
+    std::uint64_t expirations{0};
+    std::size_t entries{0};
+    std::size_t bytes{0};
+};
+
+class ResponseCache {
+public:
+    using Loader = std::function<CachedResponse()>;
+
+    explicit ResponseCache(ResponseCacheOptions options = ResponseCacheOptions{});
+    ~ResponseCache();
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // Builds the lookup key: each part is trimmed and has whitespace runs
+    // collapsed, so trivially different spellings of a prompt share an entry.
+    static std::string makeKey(const std::string& model,
+                               const std::string& systemPrompt,
+                               const std::string& message);
+
+    // Returns the fresh cached response for key, or runs loader exactly once
+    // for all concurrent callers of the same key. Only 2xx results are stored.
+    // Exceptions from loader propagate to every waiting caller.
+    std::shared_ptr<const CachedResponse> getOrLoad(const std::string& key, const Loader& loader);
+
+    ResponseCacheStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace frontend
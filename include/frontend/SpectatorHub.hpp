@@ -0,0 +1,75 @@
+// File: SpectatorHub.hpp
+// Description: Declares the publish/subscribe hub behind GET /spectate. One
+//              thread owns every spectator socket: it serializes the world
+//              once per update into a shared immutable SSE frame and hands
+//              the same buffer to each subscriber. A subscriber that is still
+//              sending the previous frame only keeps the newest one pending,
+//              so slow readers get coalesced updates instead of a growing
+//              queue.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace frontend {
+
+struct SpectatorHubOptions {
+    // Updates are published at most this often, even when notify() is
+    // called more often (TANK_SPECTATE_MIN_INTERVAL_MS)...
+    std::chrono::milliseconds minInterval{50};
+    // ...and at least this often while anyone is watching, so the clock
+    // keeps ticking between moves (TANK_SPECTATE_INTERVAL_MS).
+    std::chrono::milliseconds interval{250};
+    // Further subscribers are turned away (TANK_SPECTATE_MAX).
+    std::size_t maxSubscribers{4096};
+    // A subscriber that accepts no bytes for this long is dropped.
+    std::chrono::milliseconds sendTimeout{30000};
+    // Comment line sent when nothing changed for this long, so dead
+    // connections surface.
+    std::chrono::milliseconds keepAlive{15000};
+
+    static SpectatorHubOptions fromEnvironment();
+};
+
+struct SpectatorHubStats {
+    std::size_t subscribers{0};
+    std::uint64_t published{0};
+    // Frames replaced before a slow subscriber got to them.
+    std::uint64_t coalesced{0};
+    std::uint64_t dropped{0};
+    std::uint64_t bytesSent{0};
+};
+
+class SpectatorHub {
+public:
+    // Produces the JSON document to broadcast; called on the hub thread,
+    // once per update, only while someone is subscribed.
+    using Snapshot = std::function<std::string()>;
+
+    SpectatorHub(SpectatorHubOptions options, Snapshot snapshot);
+    // Closes every subscriber socket.
+    ~SpectatorHub();
+
+    SpectatorHub(const SpectatorHub&) = delete;
+    SpectatorHub& operator=(const SpectatorHub&) = delete;
+
+    // Takes ownership of clientSocket and answers it with an event stream,
+    // starting with the latest frame. Returns false (socket untouched) when
+    // the hub is full.
+    bool subscribe(int clientSocket);
+    // The world changed; publish soon rather than at the next interval.
+    void notify();
+
+    SpectatorHubStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace frontend
@@ -0,0 +1,35 @@
+// File: SseParser.hpp
+// Description: Declares an incremental parser for text/event-stream bodies
+//              that accepts arbitrary byte splits and yields whole events.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace frontend {
+
+struct SseEvent {
+    std::string event;  // empty means the default "message" type
+    std::string data;   // data lines joined with '\n'
+};
+
+class SseParser {
+public:
+    using EventHandler = std::function<void(const SseEvent&)>;
+
+    // Consumes the next slice of the stream and calls onEvent for every event
+    // completed by it. Partial lines are kept until the next call.
+    void feed(std::string_view bytes, const EventHandler& onEvent);
+
+private:
+    void processLine(std::string_view line, const EventHandler& onEvent);
+
+    std::string m_line;
+    SseEvent m_pending;
+    bool m_hasData{false};
+    bool m_skipLeadingLf{false};
+};
+
+}  // namespace frontend
@@ -0,0 +1,90 @@
+// File: TrafficCapture.hpp
+// Description: Declares HTTP traffic capture for offline replay. When
+//              TANK_CAPTURE_FILE is set, WebServer appends every request
+//              (arrival time, method, path, headers, body) to a compact
+//              binary file; bodies on sensitive routes are redacted first.
+//              TrafficCaptureReader reads the file back for tools/traffic_replay.
+//
+//              File layout (integers are LEB128 varints unless noted):
+//                "TANKCAP1" | startedAt unix micros (8 bytes, little endian)
+//                records: payloadLength | offsetMicros | flags (1 byte) |
+//                         method | path | headerCount | (name | value)* | body
+//              Strings are a varint length followed by the bytes. A torn
+//              final record (crash mid-write) reads as end of file.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace frontend {
+
+struct CapturedRequest {
+    std::uint64_t offsetMicros{0};  // since the capture started
+    std::string method;
+    std::string path;  // including the query string
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    bool bodyRedacted{false};
+};
+
+struct TrafficCaptureOptions {
+    // Capture is off while empty (TANK_CAPTURE_FILE).
+    std::string path;
+    // Routes whose body values are masked (TANK_CAPTURE_REDACT, comma
+    // separated; "none" disables redaction).
+    std::vector<std::string> redactRoutes{"/duckai", "/attendance/mark", "/layout"};
+    // Capture stops once the file reaches this size (TANK_CAPTURE_MAX_BYTES).
+    std::uint64_t maxBytes{256ULL * 1024 * 1024};
+
+    static TrafficCaptureOptions fromEnvironment();
+};
+
+class TrafficCapture {
+public:
+    explicit TrafficCapture(TrafficCaptureOptions options);
+    ~TrafficCapture();
+
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    // True while the capture file is open; false if it could not be opened
+    // or capture has stopped.
+    bool enabled() const noexcept;
+
+    // Thread-safe. routingPath (normalized, no query) selects redaction.
+    void record(const std::string& method,
+                const std::string& path,
+                const std::string& routingPath,
+                const std::vector<std::pair<std::string, std::string>>& headers,
+                const std::string& body);
+
+    // Replaces every value in a form or JSON body with 'x' characters of the
+    // same length, so redacted requests still parse and keep their size.
+    static std::string redactBody(const std::string& body);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+class TrafficCaptureReader {
+public:
+    // Throws std::runtime_error if the file is missing or not a capture.
+    explicit TrafficCaptureReader(const std::string& path);
+
+    // False at end of file (or at a torn final record); throws on corruption.
+    bool next(CapturedRequest& request);
+
+    std::uint64_t startedAtMicros() const noexcept { return m_startedAtMicros; }
+
+private:
+    std::ifstream m_in;
+    std::uint64_t m_startedAtMicros{0};
+};
+
+}  // namespace frontend
@@ -0,0 +1,92 @@
+// File: UpstreamClient.hpp
+// Description: Declares a pooled HTTP client for upstream APIs. All transfers
+//              share one curl multi handle driven by a dedicated event-loop
+//              thread, so connections and DNS lookups are reused across
+//              requests and callers simply wait on a future.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace frontend {
+
+struct UpstreamClientOptions {
+    // Transfers running at once; further requests wait in the queue.
+    std::size_t maxConcurrent{16};
+    // Requests allowed to wait for a slot before new ones are rejected.
+    std::size_t maxQueued{256};
+    // Idle connections kept open in the shared connection cache.
+    std::size_t maxCachedConnections{32};
+    long connectTimeoutMs{5000};
+    long dnsCacheTimeoutSeconds{300};
+
+    // Reads DUCKAI_MAX_CONCURRENT and DUCKAI_MAX_QUEUED on top of the defaults.
+    static UpstreamClientOptions fromEnvironment();
+};
+
+struct UpstreamRequest {
+    std::string url;
+    std::vector<std::string> headers;  // "Name: value"
+    std::string body;                  // sent as POST
+    long timeoutMs{20000};
+
+    // When set, the body is delivered here as it arrives instead of being
+    // collected into UpstreamResponse::body. Runs on the event-loop thread,
+    // so it must not block; returning false aborts the transfer.
+    std::function<bool(long status, const char* data, std::size_t size)> onData;
+    // Setting this flag aborts the transfer; call UpstreamClient::wake() after.
+    std::shared_ptr<const std::atomic<bool>> cancelled;
+};
+
+struct UpstreamResponse {
+    // False when the transfer itself failed (DNS, connect, timeout, rejected).
+    bool ok{false};
+    // Set when the queue was full and the request never started.
+    bool rejected{false};
+    // Set when the transfer hit UpstreamRequest::timeoutMs.
+    bool timedOut{false};
+    long status{0};
+    std::string body;
+    std::string error;
+    // True when the transfer ran over a connection from the cache.
+    bool reusedConnection{false};
+};
+
+struct UpstreamClientStats {
+    std::size_t active{0};
+    std::size_t queued{0};
+    std::uint64_t completed{0};
+    std::uint64_t failed{0};
+    std::uint64_t rejected{0};
+    std::uint64_t reusedConnections{0};
+};
+
+class UpstreamClient {
+public:
+    explicit UpstreamClient(UpstreamClientOptions options = UpstreamClientOptions{});
+    ~UpstreamClient();
+
+    UpstreamClient(const UpstreamClient&) = delete;
+    UpstreamClient& operator=(const UpstreamClient&) = delete;
+
+    // Queues the request for the event loop. The future is always satisfied,
+    // with ok == false on failure, rejection or shutdown.
+    std::future<UpstreamResponse> submit(UpstreamRequest request);
+    // Nudges the event loop, e.g. so a cancellation takes effect promptly.
+    void wake();
+
+    UpstreamClientStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace frontend
@@ -0,0 +1,107 @@
+// File: UpstreamGuard.hpp
+// Description: Declares the protection layer in front of the Duck AI
+//              upstream: a bulkhead that caps how many server threads may
+//              wait on it, a consecutive-failure circuit breaker that fails
+//              fast while the upstream is unhealthy, and timeouts derived
+//              from recently observed latency percentiles.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace frontend {
+
+struct UpstreamGuardOptions {
+    // Server threads allowed inside upstream calls at once (the bulkhead).
+    std::size_t maxInFlight{16};
+    // Consecutive failures or timeouts that open the circuit.
+    std::uint32_t failureThreshold{5};
+    // How long the circuit stays open before a single half-open probe.
+    std::chrono::milliseconds openDuration{10000};
+
+    // Adaptive timeout = p99 of recent successful calls x multiplier,
+    // clamped to [minTimeout, maxTimeout]. maxTimeout applies until
+    // minSamples latencies have been observed.
+    double timeoutMultiplier{3.0};
+    std::chrono::milliseconds minTimeout{2000};
+    std::chrono::milliseconds maxTimeout{20000};
+    std::size_t minSamples{20};
+
+    // Reads DUCKAI_BULKHEAD, DUCKAI_BREAKER_FAILURES, DUCKAI_BREAKER_OPEN_MS,
+    // DUCKAI_TIMEOUT_MIN_MS and DUCKAI_TIMEOUT_MAX_MS on top of the defaults.
+    static UpstreamGuardOptions fromEnvironment();
+};
+
+enum class CircuitState { Closed = 0, Open = 1, HalfOpen = 2 };
+
+// Which latency a successful call reports, each with its own timeout:
+// whole buffered completions, or time to the first streamed byte.
+enum class UpstreamLatencyKind { Completion = 0, FirstByte = 1 };
+
+struct UpstreamGuardStats {
+    CircuitState state{CircuitState::Closed};
+    std::size_t inFlight{0};
+    std::uint64_t admitted{0};
+    std::uint64_t rejectedBulkhead{0};
+    std::uint64_t rejectedOpen{0};
+    std::uint64_t successes{0};
+    std::uint64_t failures{0};  // includes timeouts
+    std::uint64_t timeouts{0};
+    std::uint64_t circuitOpened{0};
+    long completionTimeoutMs{0};
+    long firstByteTimeoutMs{0};
+};
+
+class UpstreamGuard {
+public:
+    enum class Admission { Admitted, BulkheadFull, CircuitOpen };
+
+    // Holds one bulkhead slot. Report the outcome with succeed() or fail();
+    // a permit dropped without either (e.g. the client went away) frees the
+    // slot without counting for or against the upstream.
+    class Permit {
+    public:
+        Permit() = default;
+        ~Permit();
+        Permit(Permit&& other) noexcept;
+        Permit& operator=(Permit&& other) noexcept;
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+
+        explicit operator bool() const { return m_guard != nullptr; }
+
+        void succeed(UpstreamLatencyKind kind, std::chrono::milliseconds latency);
+        void fail(bool timedOut);
+
+    private:
+        friend class UpstreamGuard;
+        void release();
+
+        UpstreamGuard* m_guard{nullptr};
+        bool m_probe{false};
+    };
+
+    explicit UpstreamGuard(UpstreamGuardOptions options = UpstreamGuardOptions{});
+    ~UpstreamGuard();
+
+    UpstreamGuard(const UpstreamGuard&) = delete;
+    UpstreamGuard& operator=(const UpstreamGuard&) = delete;
+
+    // Never blocks: either fills permit or says why the call must fail fast.
+    Admission tryAcquire(Permit& permit);
+
+    long timeoutMs(UpstreamLatencyKind kind) const;
+    // Remaining time the circuit stays open, rounded up to whole seconds (0 when closed).
+    long retryAfterSeconds() const;
+
+    UpstreamGuardStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace frontend
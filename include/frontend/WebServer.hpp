@@ -8,9 +8,23 @@
 #include "backend/CodeStatsFacade.hpp"
 #include "backend/Attendance.hpp"
 #include "backend/GameEngine.hpp"
+#include "backend/InstrumentedMutex.hpp"
+#include "frontend/AssetStore.hpp"
+#include "frontend/OutputQueue.hpp"
+#include "frontend/RequestScheduler.hpp"
+#include "frontend/ResponseCache.hpp"
+#include "frontend/SpectatorHub.hpp"
+#include "frontend/TrafficCapture.hpp"
+#include "frontend/UpstreamClient.hpp"
+#include "frontend/UpstreamGuard.hpp"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -24,6 +38,10 @@ public:
               LayoutManager& layoutManager,
               std::string staticDir,
               int port = 8080);
+    ~WebServer();
+
+    WebServer(const WebServer&) = delete;
+    WebServer& operator=(const WebServer&) = delete;
 
     void run();
 
@@ -33,16 +51,59 @@ private:
     backend::GameEngine& m_engine;
     LayoutManager& m_layoutManager;
     backend::CodeStatsFacade m_codeStatsFacade;
-    std::unique_ptr<backend::AttendanceRepository> m_attendanceRepo;
+    // Attendance storage is connected on a background thread so startup never
+    // waits on the database; m_attendanceRepo stays null until it is ready.
+    enum class AttendanceState { Initializing, Ready, Failed };
+    std::unique_ptr<backend::AttendanceRepository> m_attendanceRepoOwner;
+    std::atomic<backend::AttendanceRepository*> m_attendanceRepo{nullptr};
+    std::atomic<AttendanceState> m_attendanceState{AttendanceState::Initializing};
+    std::thread m_attendanceInitThread;
+    std::mutex m_attendanceInitMutex;
+    std::condition_variable m_attendanceInitCv;
+    bool m_stopping{false};
     std::size_t m_attendanceCursor{0};
     std::string m_staticDir;
     int m_port;
-    std::mutex m_engineMutex;
+    // Shared keep-alive connection pool for /duckai upstream calls.
+    UpstreamClient m_upstreamClient;
+    ResponseCache m_duckAiCache;
+    // Bulkhead, circuit breaker and adaptive timeouts for /duckai upstream calls.
+    UpstreamGuard m_duckAiGuard;
+    // Request recorder for offline replay; inert unless TANK_CAPTURE_FILE is set.
+    TrafficCapture m_capture;
+    // Admits handlers by route priority class; see priorityClassFor().
+    RequestScheduler m_scheduler;
+    // High-water mark and send timeout for every response's OutputQueue.
+    OutputQueueOptions m_outputOptions;
+    // Pages and images compiled into the binary (or TANK_ASSET_DIR).
+    AssetStore m_assets;
+    backend::InstrumentedMutex m_engineMutex{"engine"};
+    // Fires engine timers (envelope expiry, rain waves) as they fall due, so
+    // the game moves on with no requests arriving. Waits on m_engineMutex.
+    std::thread m_engineTicker;
+    std::condition_variable_any m_engineTickerCv;
+    bool m_engineTickerStopping{false};  // guarded by m_engineMutex
+    // GET /spectate subscribers. Declared last: its thread snapshots the
+    // engine, so it must stop before anything above is destroyed.
+    SpectatorHub m_spectators;
 
-    void handleClient(int clientSocket);
+    void initializeAttendanceRepository();
+    backend::AttendanceRepository* attendanceRepository() const noexcept;
+    std::string attendanceUnavailable(std::string& contentType, int& statusCode) const;
+    // Retry-After for attendance 503s: 1 s while initializing or reconnecting,
+    // the slow retry interval once the repository has failed.
+    long attendanceRetryAfterSeconds() const noexcept;
+    // acceptedTicks: backend::Tracer::now() when accept() returned.
+    void handleClient(int clientSocket, std::uint64_t acceptedTicks);
+    // Locks m_engineMutex, tracing the wait.
+    std::unique_lock<backend::InstrumentedMutex> lockEngine();
+    void runEngineTicker();
+    // After a request changed the game: wakes the ticker to recompute its
+    // deadline and pushes the new state to spectators. Call unlocked.
+    void notifyEngineChanged();
     void sendHttpResponse(int clientSocket,
                           const std::string& statusLine,
-                          const std::string& body,
+                          std::string body,
                           const std::string& contentType = "text/plain",
                           const std::vector<std::pair<std::string, std::string>>& extraHeaders = {});
     void sendNotFound(int clientSocket);
@@ -51,13 +112,57 @@ private:
     std::string handleAttendanceMark(const std::string& body,
                                      std::string& contentType,
                                      int& statusCode);
+    std::string handleAttendanceRosterPage(const std::string& query,
+                                           std::string& contentType,
+                                           int& statusCode);
+    // Holds ticket only until the first batch of rows has been fetched.
+    void streamAttendanceRoster(int clientSocket, RequestScheduler::Ticket& ticket);
+    struct DuckAiPrompt {
+        std::string apiKey;
+        std::string model;
+        std::string systemPrompt;
+        std::string message;
+        bool stream{false};
+    };
+    bool parseDuckAiPrompt(const std::string& body,
+                           DuckAiPrompt& prompt,
+                           std::string& errorBody,
+                           int& statusCode) const;
+    UpstreamRequest buildDuckAiRequest(const DuckAiPrompt& prompt, bool stream) const;
+    CachedResponse fetchDuckAiCompletion(const DuckAiPrompt& prompt);
+    // Buffered completion through the response cache.
+    std::string answerDuckAi(const DuckAiPrompt& prompt, int& statusCode);
+    std::string duckAiUnavailableBody(UpstreamGuard::Admission admission) const;
+    // Streamed completion through the response cache.
+    void streamDuckAi(int clientSocket, const DuckAiPrompt& prompt);
+    // Sends a cached or shared answer as one server-sent delta.
+    void sendCachedDuckAiStream(int clientSocket, const CachedResponse& response);
+    // Forwards upstream completion deltas to the client as server-sent events
+    // and returns the whole answer (or the error) for the cache.
+    CachedResponse relayDuckAiStream(int clientSocket, const DuckAiPrompt& prompt);
     std::string handleApiRequest(const std::string& method,
                                  const std::string& path,
                                  const std::string& body,
                                  std::string& contentType,
                                  int& statusCode);
-    std::string buildStateJson();
-    std::string loadStaticFile(const std::string& targetPath, std::string& contentType);
+    // player (from ?player=) selects whose input sequence is acknowledged.
+    std::string buildStateJson(const std::string& player);
+    std::string buildMetricsText() const;
+    // GET /debug/profile: samples CPU for ?seconds=N and replies with folded stacks.
+    void serveProfile(int clientSocket, const std::string& query);
+    // GET /debug/trace: records request spans for ?ms=N and replies with Chrome trace JSON.
+    void serveTrace(int clientSocket, const std::string& query);
+    // GET /debug/locks: contention and hold times per named lock, most waited-on first.
+    std::string buildLocksJson() const;
+    // GET /, /index.html and /static/*. Embedded assets are answered from
+    // memory with ETag revalidation and gzip when the client accepts it.
+    void serveAsset(int clientSocket,
+                    const std::string& routingPath,
+                    const std::string& ifNoneMatch,
+                    bool acceptsGzip);
+    // Sends a TANK_ASSET_DIR file as a file range, uncached.
+    // Throws std::runtime_error before writing anything if it cannot be opened.
+    void sendStaticFile(int clientSocket, const std::string& fullPath);
     backend::MoveDirection parseDirection(const std::string& payload) const;
     std::string parseAction(const std::string& payload) const;
     std::string parseDirectory(const std::string& payload) const;
@@ -0,0 +1,362 @@
+// File: AllocationTracker.cpp
+// Description: Implements allocation accounting: the replacement global
+//              operator new/delete (WITH_ALLOC_TRACKING builds only), the
+//              per-thread counter blocks and the scope tag table.
+
+#include "backend/AllocationTracker.hpp"
+
+#ifdef TANK_ALLOC_TRACKING
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace backend {
+
+namespace {
+
+constexpr std::size_t kMaxScopes = 64;
+
+struct ScopeCounters {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocatedBytes{0};
+    std::atomic<std::uint64_t> frees{0};
+    std::atomic<std::uint64_t> freedBytes{0};
+};
+
+// One per thread. Only the owning thread writes, so updates are plain
+// load/store pairs; readers sum the blocks under g_blocksMutex.
+struct CounterBlock {
+    ScopeCounters scopes[kMaxScopes];
+    CounterBlock* next{nullptr};
+    CounterBlock* prev{nullptr};
+};
+
+// Slot 0 collects allocations made outside any scope.
+std::atomic<const char*> g_scopeNames[kMaxScopes] = {{"untagged"}};
+
+std::mutex g_blocksMutex;
+CounterBlock* g_blocks = nullptr;
+// Counts of exited threads, plus allocations made during thread teardown.
+CounterBlock g_retired;
+
+thread_local CounterBlock* t_block = nullptr;
+thread_local bool t_exited = false;
+thread_local std::uint8_t t_scope = 0;
+
+void addOwned(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void addShared(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+struct BlockOwner {
+    CounterBlock block;
+
+    BlockOwner() {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        block.next = g_blocks;
+        if (g_blocks) {
+            g_blocks->prev = &block;
+        }
+        g_blocks = &block;
+    }
+
+    ~BlockOwner() {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        for (std::size_t i = 0; i < kMaxScopes; ++i) {
+            addShared(g_retired.scopes[i].allocations, block.scopes[i].allocations.load());
+            addShared(g_retired.scopes[i].allocatedBytes, block.scopes[i].allocatedBytes.load());
+            addShared(g_retired.scopes[i].frees, block.scopes[i].frees.load());
+            addShared(g_retired.scopes[i].freedBytes, block.scopes[i].freedBytes.load());
+        }
+        if (block.prev) {
+            block.prev->next = block.next;
+        } else {
+            g_blocks = block.next;
+        }
+        if (block.next) {
+            block.next->prev = block.prev;
+        }
+        t_block = nullptr;
+        t_exited = true;
+    }
+};
+
+// Null once the thread's block has been torn down.
+CounterBlock* threadBlock() {
+    if (t_block || t_exited) {
+        return t_block;
+    }
+    thread_local BlockOwner owner;
+    t_block = &owner.block;
+    return t_block;
+}
+
+std::size_t usableSize(void* pointer) {
+#if defined(__APPLE__)
+    return malloc_size(pointer);
+#else
+    return malloc_usable_size(pointer);
+#endif
+}
+
+void countAllocation(void* pointer) {
+    const std::uint64_t bytes = usableSize(pointer);
+    if (CounterBlock* block = threadBlock()) {
+        addOwned(block->scopes[t_scope].allocations, 1);
+        addOwned(block->scopes[t_scope].allocatedBytes, bytes);
+    } else {
+        addShared(g_retired.scopes[t_scope].allocations, 1);
+        addShared(g_retired.scopes[t_scope].allocatedBytes, bytes);
+    }
+}
+
+void countFree(void* pointer) {
+    const std::uint64_t bytes = usableSize(pointer);
+    if (CounterBlock* block = threadBlock()) {
+        addOwned(block->scopes[t_scope].frees, 1);
+        addOwned(block->scopes[t_scope].freedBytes, bytes);
+    } else {
+        addShared(g_retired.scopes[t_scope].frees, 1);
+        addShared(g_retired.scopes[t_scope].freedBytes, bytes);
+    }
+}
+
+// Tags are interned lock-free into a fixed table so scopes never allocate.
+std::uint8_t scopeIndex(const char* tag) {
+    for (std::size_t i = 1; i < kMaxScopes; ++i) {
+        const char* name = g_scopeNames[i].load(std::memory_order_acquire);
+        if (!name && g_scopeNames[i].compare_exchange_strong(name, tag, std::memory_order_acq_rel)) {
+            return static_cast<std::uint8_t>(i);
+        }
+        if (name == tag || std::strcmp(name, tag) == 0) {
+            return static_cast<std::uint8_t>(i);
+        }
+    }
+    return 0;
+}
+
+void* allocate(std::size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (void* pointer = std::malloc(size)) {
+            countAllocation(pointer);
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    const std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void* pointer = nullptr;
+        if (::posix_memalign(&pointer, align, size) == 0) {
+            countAllocation(pointer);
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void release(void* pointer) noexcept {
+    if (pointer) {
+        countFree(pointer);
+        std::free(pointer);
+    }
+}
+
+}  // namespace
+
+std::vector<AllocationStats> AllocationTracker::snapshot() {
+    // Allocate before taking the lock: a first allocation on this thread
+    // registers its block under the same mutex.
+    std::vector<AllocationStats> totals(kMaxScopes);
+    std::vector<AllocationStats> result;
+    result.reserve(kMaxScopes);
+    {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        const auto accumulate = [&totals](const CounterBlock& block) {
+            for (std::size_t i = 0; i < kMaxScopes; ++i) {
+                totals[i].allocations += block.scopes[i].allocations.load(std::memory_order_relaxed);
+                totals[i].allocatedBytes += block.scopes[i].allocatedBytes.load(std::memory_order_relaxed);
+                totals[i].frees += block.scopes[i].frees.load(std::memory_order_relaxed);
+                totals[i].freedBytes += block.scopes[i].freedBytes.load(std::memory_order_relaxed);
+            }
+        };
+        accumulate(g_retired);
+        for (const CounterBlock* block = g_blocks; block; block = block->next) {
+            accumulate(*block);
+        }
+    }
+    for (std::size_t i = 0; i < kMaxScopes; ++i) {
+        const char* name = g_scopeNames[i].load(std::memory_order_acquire);
+        if (name && (totals[i].allocations > 0 || totals[i].frees > 0)) {
+            totals[i].scope = name;
+            result.push_back(totals[i]);
+        }
+    }
+    return result;
+}
+
+AllocationStats AllocationTracker::threadTotals() {
+    AllocationStats totals;
+    totals.scope = "thread";
+    if (const CounterBlock* block = threadBlock()) {
+        for (const ScopeCounters& scope : block->scopes) {
+            totals.allocations += scope.allocations.load(std::memory_order_relaxed);
+            totals.allocatedBytes += scope.allocatedBytes.load(std::memory_order_relaxed);
+            totals.frees += scope.frees.load(std::memory_order_relaxed);
+            totals.freedBytes += scope.freedBytes.load(std::memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+AllocationScope::AllocationScope(const char* tag) noexcept : m_previous(t_scope) {
+    t_scope = scopeIndex(tag);
+}
+
+AllocationScope::~AllocationScope() {
+    t_scope = m_previous;
+}
+
+}  // namespace backend
+
+void* operator new(std::size_t size) {
+    return backend::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return backend::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return backend::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return backend::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return backend::allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return backend::allocateAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return backend::allocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return backend::allocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    backend::release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    backend::release(pointer);
+}
+
+#else  // TANK_ALLOC_TRACKING
+
+namespace backend {
+
+std::vector<AllocationStats> AllocationTracker::snapshot() {
+    return {};
+}
+
+AllocationStats AllocationTracker::threadTotals() {
+    return {};
+}
+
+}  // namespace backend
+
+#endif  // TANK_ALLOC_TRACKING
@@ -6,15 +6,19 @@
 //              connection details in createAttendanceRepository().
 
 #include "backend/Attendance.hpp"
+#include "backend/InstrumentedMutex.hpp"
 #include "backend/Logger.hpp"
 
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #if defined(HAVE_MYSQL)
 #if __has_include(<mysql/mysql.h>)
@@ -43,6 +47,11 @@ namespace backend {
 
 namespace {
 
+// Rows fetched per repository round trip by forEachStudent. The lock (and,
+// for MySQL, the connection) is released between batches, so other
+// attendance calls interleave with a long roster download.
+constexpr std::size_t kStudentWalkBatch = 500;
+
 class InMemoryAttendanceRepository : public AttendanceRepository {
 public:
     InMemoryAttendanceRepository() {
@@ -50,15 +59,49 @@ public:
         // these records should instead来自数据库初始化。
         m_students.push_back(Student{"2023xxxxxxxx1", "haoxiang"});
         m_students.push_back(Student{"2023xxxxxxxx2", "yuyang"});
+        // Keep studentId order so keyset pages are a binary search away.
+        std::sort(m_students.begin(), m_students.end(),
+                  [](const Student& a, const Student& b) { return a.studentId < b.studentId; });
     }
 
     std::vector<Student> listStudents() override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
         return m_students;
     }
 
+    std::vector<Student> listStudentsAfter(const std::string& afterId,
+                                           std::size_t limit) override {
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
+        auto it = m_students.begin();
+        if (!afterId.empty()) {
+            it = std::upper_bound(
+                m_students.begin(), m_students.end(), afterId,
+                [](const std::string& id, const Student& s) { return id < s.studentId; });
+        }
+        const std::size_t available = static_cast<std::size_t>(m_students.end() - it);
+        const std::size_t count = std::min(limit, available);
+        return std::vector<Student>(it, it + static_cast<std::ptrdiff_t>(count));
+    }
+
+    bool forEachStudent(const std::function<bool(const Student&)>& visitor) override {
+        std::string afterId;
+        while (true) {
+            // Copied out under the lock; the visitor runs without it.
+            const std::vector<Student> batch = listStudentsAfter(afterId, kStudentWalkBatch);
+            for (const Student& s : batch) {
+                if (!visitor(s)) {
+                    return true;
+                }
+            }
+            if (batch.size() < kStudentWalkBatch) {
+                return true;
+            }
+            afterId = batch.back().studentId;
+        }
+    }
+
     std::optional<Student> findStudentById(const std::string& studentId) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
         const auto it = std::find_if(
             m_students.begin(), m_students.end(),
             [&](const Student& s) { return s.studentId == studentId; });
@@ -69,7 +112,7 @@ public:
     }
 
     bool markAttendance(const AttendanceRecord& record) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
         m_records.push_back(record);
         return true;
     }
@@ -77,7 +120,7 @@ public:
 private:
     std::vector<Student> m_students;
     std::vector<AttendanceRecord> m_records;
-    std::mutex m_mutex;
+    InstrumentedMutex m_mutex{"attendance.memory"};
 };
 
 #if defined(HAVE_MYSQL)
@@ -109,57 +152,9 @@ std::string statusToString(AttendanceStatus status) {
 
 class MySqlAttendanceRepository : public AttendanceRepository {
 public:
-    MySqlAttendanceRepository()
-        : m_conn(mysql_init(nullptr)) {
-        if (!m_conn) {
-            throw std::runtime_error("Failed to initialize MySQL handle.");
-        }
-
-        const char* host = std::getenv("ATTENDANCE_DB_HOST");
-        const char* user = std::getenv("ATTENDANCE_DB_USER");
-        const char* password = std::getenv("ATTENDANCE_DB_PASSWORD");
-        if (!password) {
-            // Common MySQL env var names used by CLI/tools.
-            password = std::getenv("MYSQL_PWD");
-        }
-        if (!password) {
-            // Align with Makefile variable naming for convenience.
-            password = std::getenv("DB_PASSWORD");
-        }
-        const char* db = std::getenv("ATTENDANCE_DB_NAME");
-        const char* portStr = std::getenv("ATTENDANCE_DB_PORT");
-
-        if (!host) {
-            host = "localhost";
-        }
-        if (!user) {
-            user = "root";
-        }
-        if (!password) {
-            password = "";
-        }
-        if (!db) {
-            db = "attendance_db";
-        }
-
-        unsigned int port = 3306U;
-        if (portStr != nullptr) {
-            const int parsed = std::atoi(portStr);
-            if (parsed > 0) {
-                port = static_cast<unsigned int>(parsed);
-            }
-        }
-
-        if (!mysql_real_connect(m_conn, host, user, password, db, port, nullptr, 0)) {
-            std::string message = "Failed to connect MySQL: ";
-            message += mysql_error(m_conn);
-            if (std::string(message).find("Access denied") != std::string::npos) {
-                message += " (Hint: set ATTENDANCE_DB_PASSWORD / MYSQL_PWD env var)";
-            }
-            mysql_close(m_conn);
-            m_conn = nullptr;
-            throw std::runtime_error(message);
-        }
+    explicit MySqlAttendanceRepository(MySqlConnectionOptions options)
+        : m_options(std::move(options)), m_conn(nullptr) {
+        connect();
     }
 
     ~MySqlAttendanceRepository() override {
@@ -170,7 +165,7 @@ public:
     }
 
     std::vector<Student> listStudents() override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
         std::vector<Student> result;
         ensureConnectedOrQuit("listStudents");
 
@@ -201,8 +196,84 @@ public:
         return result;
     }
 
+    std::vector<Student> listStudentsAfter(const std::string& afterId,
+                                           std::size_t limit) override {
+        std::vector<Student> result;
+        fetchStudentsAfter(afterId, limit, result);
+        return result;
+    }
+
+    // Keyset page into result; false if the query failed.
+    bool fetchStudentsAfter(const std::string& afterId, std::size_t limit, std::vector<Student>& result) {
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
+        result.clear();
+        ensureConnectedOrQuit("listStudentsAfter");
+        if (limit == 0) {
+            return true;
+        }
+
+        // Keyset pagination on the primary key: cost is O(limit) regardless of page depth.
+        std::string query = "SELECT student_id, name FROM students";
+        if (!afterId.empty()) {
+            query += " WHERE student_id > '";
+            query += escape(afterId);
+            query += "'";
+        }
+        query += " ORDER BY student_id LIMIT ";
+        query += std::to_string(limit);
+
+        if (mysql_query(m_conn, query.c_str()) != 0) {
+            handleDbErrorOrQuit("listStudentsAfter mysql_query");
+            return false;
+        }
+
+        MYSQL_RES* res = mysql_store_result(m_conn);
+        if (!res) {
+            handleDbErrorOrQuit("listStudentsAfter mysql_store_result");
+            return false;
+        }
+
+        result.reserve(limit);
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(res)) != nullptr) {
+            Student s;
+            if (row[0]) {
+                s.studentId = row[0];
+            }
+            if (row[1]) {
+                s.name = row[1];
+            }
+            result.push_back(std::move(s));
+        }
+        mysql_free_result(res);
+        return true;
+    }
+
+    bool forEachStudent(const std::function<bool(const Student&)>& visitor) override {
+        // Keyset batches rather than one unbuffered result: the lock and the
+        // connection are held only while a batch is fetched, never while the
+        // visitor (typically a slow HTTP client) consumes it.
+        std::vector<Student> batch;
+        batch.reserve(kStudentWalkBatch);
+        std::string afterId;
+        while (true) {
+            if (!fetchStudentsAfter(afterId, kStudentWalkBatch, batch)) {
+                return false;
+            }
+            for (const Student& s : batch) {
+                if (!visitor(s)) {
+                    return true;
+                }
+            }
+            if (batch.size() < kStudentWalkBatch) {
+                return true;
+            }
+            afterId = batch.back().studentId;
+        }
+    }
+
     std::optional<Student> findStudentById(const std::string& studentId) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
         ensureConnectedOrQuit("findStudentById");
 
         std::string query = "SELECT student_id, name FROM students WHERE student_id = '";
@@ -238,7 +309,7 @@ public:
     }
 
     bool markAttendance(const AttendanceRecord& record) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<InstrumentedMutex> lock(m_mutex);
         ensureConnectedOrQuit("markAttendance");
 
         std::ostringstream oss;
@@ -256,11 +327,54 @@ public:
     }
 
 private:
+    void connect() {
+        m_conn = mysql_init(nullptr);
+        if (!m_conn) {
+            throw std::runtime_error("Failed to initialize MySQL handle.");
+        }
+        if (m_options.connectTimeoutSeconds > 0) {
+            mysql_options(m_conn, MYSQL_OPT_CONNECT_TIMEOUT, &m_options.connectTimeoutSeconds);
+        }
+        if (m_options.readTimeoutSeconds > 0) {
+            mysql_options(m_conn, MYSQL_OPT_READ_TIMEOUT, &m_options.readTimeoutSeconds);
+        }
+        if (m_options.writeTimeoutSeconds > 0) {
+            mysql_options(m_conn, MYSQL_OPT_WRITE_TIMEOUT, &m_options.writeTimeoutSeconds);
+        }
+
+        if (!mysql_real_connect(m_conn,
+                                m_options.host.c_str(),
+                                m_options.user.c_str(),
+                                m_options.password.c_str(),
+                                m_options.database.c_str(),
+                                m_options.port,
+                                nullptr,
+                                0)) {
+            std::string message = "Failed to connect MySQL: ";
+            message += mysql_error(m_conn);
+            if (std::string(message).find("Access denied") != std::string::npos) {
+                message += " (Hint: set ATTENDANCE_DB_PASSWORD / MYSQL_PWD env var)";
+            }
+            mysql_close(m_conn);
+            m_conn = nullptr;
+            throw std::runtime_error(message);
+        }
+    }
+
     void ensureConnectedOrQuit(const char* action) {
         if (m_conn) {
             return;
         }
-        quitNow(std::string("MySQL connection missing during ") + action + ".");
+        if (m_options.exitOnDisconnect) {
+            quitNow(std::string("MySQL connection missing during ") + action + ".");
+        }
+        // Lazy reconnect: a previous call dropped the handle after a disconnect.
+        try {
+            connect();
+        } catch (const std::exception& ex) {
+            throw AttendanceUnavailableError(std::string("MySQL reconnect failed during ") +
+                                             action + ": " + ex.what());
+        }
     }
 
     static bool isDisconnectError(unsigned int err) {
@@ -277,7 +391,12 @@ private:
             message += action;
             message += ": ";
             message += mysql_error(m_conn);
-            quitNow(message);
+            if (m_options.exitOnDisconnect) {
+                quitNow(message);
+            }
+            mysql_close(m_conn);
+            m_conn = nullptr;
+            throw AttendanceUnavailableError(message);
         }
     }
 
@@ -301,26 +420,70 @@ private:
         return out;
     }
 
+    MySqlConnectionOptions m_options;
     MYSQL* m_conn;
-    std::mutex m_mutex;
+    InstrumentedMutex m_mutex{"attendance.mysql"};
 };
 
 #endif  // HAVE_MYSQL
 
 }  // namespace
 
-std::unique_ptr<AttendanceRepository> createAttendanceRepository() {
+MySqlConnectionOptions MySqlConnectionOptions::fromEnvironment() {
+    MySqlConnectionOptions options;
+    if (const char* host = std::getenv("ATTENDANCE_DB_HOST")) {
+        options.host = host;
+    }
+    if (const char* user = std::getenv("ATTENDANCE_DB_USER")) {
+        options.user = user;
+    }
+    const char* password = std::getenv("ATTENDANCE_DB_PASSWORD");
+    if (!password) {
+        // Common MySQL env var names used by CLI/tools.
+        password = std::getenv("MYSQL_PWD");
+    }
+    if (!password) {
+        // Align with Makefile variable naming for convenience.
+        password = std::getenv("DB_PASSWORD");
+    }
+    if (password) {
+        options.password = password;
+    }
+    if (const char* db = std::getenv("ATTENDANCE_DB_NAME")) {
+        options.database = db;
+    }
+    if (const char* portStr = std::getenv("ATTENDANCE_DB_PORT")) {
+        const int parsed = std::atoi(portStr);
+        if (parsed > 0) {
+            options.port = static_cast<unsigned int>(parsed);
+        }
+    }
+    return options;
+}
+
+std::unique_ptr<AttendanceRepository> createInMemoryAttendanceRepository() {
+    return std::make_unique<InMemoryAttendanceRepository>();
+}
+
+std::unique_ptr<AttendanceRepository> createMySqlAttendanceRepository(
+    const MySqlConnectionOptions& options) {
 #if defined(HAVE_MYSQL)
-    // 当启用 HAVE_MYSQL 时，优先使用 MySQL 版本。
-    // 如果连接失败，将在 MySqlAttendanceRepository 构造函数中抛出异常，
-    // 由上层统一处理，而不再静默回退到内存实现。
-    return std::make_unique<MySqlAttendanceRepository>();
+    return std::make_unique<MySqlAttendanceRepository>(options);
 #else
-    // 点名功能不允许静默回退到内存实现：若未启用 MySQL，直接失败退出（由上层终止进程）。
+    (void)options;
     throw std::runtime_error(
         "Attendance requires a database, but this build is missing MySQL support. "
         "Rebuild with WITH_MYSQL=1 (or define HAVE_MYSQL and link mysqlclient).");
 #endif
 }
 
+std::unique_ptr<AttendanceRepository> createAttendanceRepository() {
+    // 当启用 HAVE_MYSQL 时使用 MySQL 版本；连接失败或未启用 MySQL 时抛出异常，
+    // 由上层统一处理（重试/降级），而不再静默回退到内存实现。
+    MySqlConnectionOptions options = MySqlConnectionOptions::fromEnvironment();
+    options.connectTimeoutSeconds = 3;
+    options.exitOnDisconnect = false;
+    return createMySqlAttendanceRepository(options);
+}
+
 }  // namespace backend
@@ -3,6 +3,8 @@
 
 #include "backend/CodeStats.hpp"
 
+#include "backend/AllocationTracker.hpp"
+
 #include <algorithm>
 #include <cctype>
 #include <fstream>
@@ -198,6 +200,7 @@ std::string stripInlineComment(const std::string& line) {
 
 CodeStatsResult CodeStatsAnalyzer::analyze(const std::filesystem::path& root,
                                            const CodeStatsOptions& options) {
+    AllocationScope allocationScope("codestats");
     CodeStatsResult result;
     result.includeBlankLines = options.includeBlankLines;
     result.includeCommentLines = options.includeCommentLines;
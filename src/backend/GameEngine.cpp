@@ -1,17 +1,28 @@
 // File: GameEngine.cpp
-// Description: Implements game loop coordination, envelope spawning, and timing.
+// Description: Implements game loop coordination, envelope spawning, timing
+//              and the scheduled envelope expiry and rain events.
 
 #include "backend/GameEngine.hpp"
 
+#include "backend/Logger.hpp"
+#include "backend/PoissonDiskSampler.hpp"
+#include "backend/SharedStateWriter.hpp"
+
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 
 namespace backend {
 
 namespace {
 
+constexpr std::size_t kMaxTrackedPlayers = 1024;
+// A full player table only gives up entries idle at least this long, so an
+// active player's acknowledged sequence never goes backwards.
+constexpr std::chrono::minutes kPlayerIdleEviction{10};
+
 EnvelopeSize pickRandomSize(std::mt19937& rng) {
     static std::discrete_distribution<int> distribution{50, 35, 15};
     const int index = distribution(rng);
@@ -74,27 +85,29 @@ GameEngine::GameEngine(GameConfig config)
     reset();
 }
 
+GameEngine::~GameEngine() = default;
+
 void GameEngine::reset() {
     std::cout << "GameEngine::reset start" << std::endl;
     m_stats = {};
+    m_timers.clear();
+    m_envelopeEntries.clear();
     m_envelopes.clear();
-    m_envelopes.reserve(static_cast<std::size_t>(m_config.initialEnvelopeCount));
     m_tank.setPosition({m_config.worldWidth / 2, m_config.worldHeight / 2});
     m_nextEnvelopeId = 0;
     m_paused = false;
     m_pausedAccumulated = std::chrono::duration<double>{0.0};
     m_pauseStart = {};
 
-    for (int i = 0; i < m_config.initialEnvelopeCount; ++i) {
-        std::cout << "Creating envelope " << i << std::endl;
-        m_envelopes.emplace_back(createRandomEnvelope(m_nextEnvelopeId++));
-    }
+    placeEnvelopes(static_cast<std::size_t>(m_config.initialEnvelopeCount));
+    scheduleRain();
 
     m_startTime = std::chrono::steady_clock::now();
     std::cout << "Before handleCollisions" << std::endl;
     const double exactX = m_tank.getExactX();
     const double exactY = m_tank.getExactY();
     handleCollisions(exactX, exactY);  // Ensure starting position collects envelopes if any overlap.
+    publishSharedState();
     std::cout << "GameEngine::reset end" << std::endl;
 }
 
@@ -102,14 +115,73 @@ bool GameEngine::moveTank(MoveDirection direction) {
     if (isTimeUp() || m_paused) {
         return false;
     }
+    advanceTimers();
 
     const double previousX = m_tank.getExactX();
     const double previousY = m_tank.getExactY();
     const bool moved = m_tank.move(direction, m_config.worldWidth, m_config.worldHeight);
     handleCollisions(previousX, previousY);
+    publishSharedState();
     return moved;
 }
 
+bool GameEngine::applyInput(const std::string& player, std::uint64_t sequence, MoveDirection direction) {
+    const auto now = std::chrono::steady_clock::now();
+    auto it = m_inputSequences.find(player);
+    if (it == m_inputSequences.end()) {
+        // Player ids come from clients; keep a misbehaving one from growing
+        // the table without bound. Only the least recently seen player can
+        // make room, and only once idle; otherwise the newcomer is refused.
+        if (m_inputSequences.size() >= kMaxTrackedPlayers) {
+            const TrackedPlayer& oldest = m_playerOrder.front();
+            if (now - oldest.lastSeen < kPlayerIdleEviction) {
+                Logger::instance().log("Input from new player refused: player table full.");
+                return false;
+            }
+            m_inputSequences.erase(oldest.id);
+            m_playerOrder.pop_front();
+        }
+        m_playerOrder.push_back(TrackedPlayer{player, 0, now});
+        it = m_inputSequences.emplace(player, std::prev(m_playerOrder.end())).first;
+    }
+    TrackedPlayer& tracked = *it->second;
+    tracked.lastSeen = now;
+    m_playerOrder.splice(m_playerOrder.end(), m_playerOrder, it->second);
+    if (sequence <= tracked.sequence) {
+        return false;
+    }
+    tracked.sequence = sequence;
+    return moveTank(direction);
+}
+
+std::uint64_t GameEngine::lastInputSequence(const std::string& player) const {
+    const auto it = m_inputSequences.find(player);
+    return it == m_inputSequences.end() ? 0 : it->second->sequence;
+}
+
+std::size_t GameEngine::update() {
+    const std::size_t fired = advanceTimers();
+    if (fired > 0) {
+        publishSharedState();
+    }
+    return fired;
+}
+
+std::size_t GameEngine::pendingEvents() const noexcept {
+    return m_timers.size();
+}
+
+std::chrono::milliseconds GameEngine::untilNextEvent() const {
+    const std::uint64_t limit = static_cast<std::uint64_t>(m_config.timeLimitSeconds) * 1000;
+    const std::uint64_t next = m_timers.nextTick();
+    if (m_paused || next > limit) {
+        return std::chrono::milliseconds::max();
+    }
+    // Game time runs at wall-clock speed while not paused.
+    const std::uint64_t now = gameMillis();
+    return std::chrono::milliseconds(next > now ? static_cast<std::int64_t>(next - now) : 0);
+}
+
 bool GameEngine::isTimeUp() const {
     return elapsedSeconds() >= static_cast<double>(m_config.timeLimitSeconds);
 }
@@ -155,13 +227,10 @@ int GameEngine::spawnBonusEnvelopes(int minCount, int maxCount) {
         maxCount = minCount;
     }
 
-    std::uniform_int_distribution<int> countDist(minCount, maxCount);
-    const int spawnCount = countDist(m_rng);
-    for (int i = 0; i < spawnCount; ++i) {
-        m_envelopes.emplace_back(createRandomEnvelope(m_nextEnvelopeId++));
-    }
-
-    return spawnCount;
+    advanceTimers();
+    const int spawned = spawnEnvelopes(minCount, maxCount);
+    publishSharedState();
+    return spawned;
 }
 
 void GameEngine::pause() {
@@ -170,6 +239,7 @@ void GameEngine::pause() {
     }
     m_paused = true;
     m_pauseStart = std::chrono::steady_clock::now();
+    publishSharedState();
 }
 
 void GameEngine::resume() {
@@ -182,6 +252,7 @@ void GameEngine::resume() {
     }
     m_paused = false;
     m_pauseStart = {};
+    publishSharedState();
 }
 
 bool GameEngine::togglePause() {
@@ -197,6 +268,119 @@ bool GameEngine::isPaused() const noexcept {
     return m_paused;
 }
 
+void GameEngine::exportSharedState(const std::string& name, std::size_t envelopeCapacity) {
+    m_sharedState = std::make_unique<SharedStateWriter>(name, envelopeCapacity);
+    publishSharedState();
+}
+
+std::uint64_t GameEngine::gameMillis() const {
+    return static_cast<std::uint64_t>(elapsedSeconds() * 1000.0);
+}
+
+std::size_t GameEngine::advanceTimers() {
+    const std::uint64_t limit = static_cast<std::uint64_t>(m_config.timeLimitSeconds) * 1000;
+    return m_timers.advance(std::min(gameMillis(), limit));
+}
+
+void GameEngine::publishSharedState() {
+    if (m_sharedState) {
+        m_sharedState->publish(*this);
+    }
+}
+
+// Called from timer callbacks as well, so nothing below update() may call it.
+int GameEngine::spawnEnvelopes(int minCount, int maxCount) {
+    std::uniform_int_distribution<int> countDist(minCount, maxCount);
+    const int spawnCount = countDist(m_rng);
+    placeEnvelopes(static_cast<std::size_t>(spawnCount));
+    return spawnCount;
+}
+
+void GameEngine::placeEnvelopes(std::size_t count) {
+    std::vector<EnvelopeSize> sizes(count);
+    for (EnvelopeSize& size : sizes) {
+        size = pickRandomSize(m_rng);
+    }
+
+    PoissonDiskSampler sampler(m_config.worldWidth, m_config.worldHeight, m_rng);
+    for (const auto& envelope : m_envelopes) {
+        sampler.occupy(envelope.getPosition());
+    }
+    // Same rule as createRandomEnvelope: not within collection range of the tank.
+    const Position tankPos = m_tank.getPosition();
+    const std::vector<Position> positions = sampler.sample(count, [&](Position position, std::size_t index) {
+        const int radius = radiusForSize(sizes[index]);
+        const int dxTank = position.x - tankPos.x;
+        const int dyTank = position.y - tankPos.y;
+        return dxTank * dxTank + dyTank * dyTank > radius * radius;
+    });
+
+    m_envelopes.reserve(m_envelopes.size() + count);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_envelopes.emplace_back(m_nextEnvelopeId++,
+                                 sizes[i],
+                                 randomValueForSize(sizes[i], m_rng),
+                                 positions[i],
+                                 radiusForSize(sizes[i]));
+        trackEnvelope(m_envelopes.size() - 1);
+    }
+}
+
+void GameEngine::addEnvelope() {
+    m_envelopes.emplace_back(createRandomEnvelope(m_nextEnvelopeId++));
+    trackEnvelope(m_envelopes.size() - 1);
+}
+
+void GameEngine::trackEnvelope(std::size_t index) {
+    const std::size_t id = m_envelopes[index].getId();
+    TimerId expiry = kInvalidTimer;
+    if (m_config.envelopeLifetimeSeconds > 0) {
+        const auto lifetime = static_cast<std::uint64_t>(m_config.envelopeLifetimeSeconds) * 1000;
+        expiry = m_timers.schedule(lifetime, [this, id] { expireEnvelope(id); });
+    }
+    m_envelopeEntries[id] = EnvelopeEntry{index, expiry};
+}
+
+void GameEngine::forgetEnvelope(std::size_t id) {
+    const auto it = m_envelopeEntries.find(id);
+    if (it == m_envelopeEntries.end()) {
+        return;
+    }
+    m_timers.cancel(it->second.expiry);
+    m_envelopeEntries.erase(it);
+}
+
+void GameEngine::expireEnvelope(std::size_t id) {
+    const auto it = m_envelopeEntries.find(id);
+    if (it == m_envelopeEntries.end()) {
+        return;
+    }
+    const std::size_t index = it->second.index;
+    m_envelopeEntries.erase(it);
+    if (index + 1 != m_envelopes.size()) {
+        m_envelopes[index] = m_envelopes.back();
+        m_envelopeEntries[m_envelopes[index].getId()].index = index;
+    }
+    m_envelopes.pop_back();
+    // Bonus envelopes just vanish; the base set moves somewhere new.
+    if (m_envelopes.size() < static_cast<std::size_t>(m_config.initialEnvelopeCount)) {
+        addEnvelope();
+    }
+}
+
+void GameEngine::scheduleRain() {
+    if (m_config.rainIntervalSeconds <= 0) {
+        return;
+    }
+    const auto interval = static_cast<std::uint64_t>(m_config.rainIntervalSeconds) * 1000;
+    m_timers.schedule(interval, [this] {
+        const int minCount = std::max(1, m_config.rainWaveMinCount);
+        const int spawned = spawnEnvelopes(minCount, std::max(minCount, m_config.rainWaveMaxCount));
+        Logger::instance().log("Timed rain spawned " + std::to_string(spawned) + " bonus envelopes.");
+        scheduleRain();
+    });
+}
+
 RedEnvelope GameEngine::createRandomEnvelope(std::size_t id) {
     std::uniform_int_distribution<int> widthDist(0, m_config.worldWidth - 1);
     std::uniform_int_distribution<int> heightDist(0, m_config.worldHeight - 1);
@@ -246,9 +430,11 @@ void GameEngine::respawnEnvelope(std::size_t index) {
         return;
     }
 
+    forgetEnvelope(m_envelopes[index].getId());
     // Temporarily move the envelope outside the world to avoid conflicting with itself.
     m_envelopes[index].setPosition({-10, -10});
     m_envelopes[index] = createRandomEnvelope(m_nextEnvelopeId++);
+    trackEnvelope(index);
 }
 
 void GameEngine::handleCollisions(double previousX, double previousY) {
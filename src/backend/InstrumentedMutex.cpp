@@ -0,0 +1,139 @@
+// File: InstrumentedMutex.cpp
+// Description: Implements the instrumented mutex and the registry of
+//              per-name lock counters.
+
+#include "backend/InstrumentedMutex.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+namespace backend {
+
+struct LockCounters {
+    explicit LockCounters(const char* lockName) : name(lockName) {}
+
+    const char* name;
+    std::atomic<std::uint64_t> contended{0};
+    std::atomic<std::uint64_t> waitNanos{0};
+    std::atomic<std::uint64_t> maxWaitNanos{0};
+    std::atomic<std::uint64_t> holdNanos{0};
+    std::atomic<std::uint64_t> waitBuckets[kLockHistogramBuckets] = {};
+    // Every release lands in one bucket, so their sum is the acquisition count.
+    std::atomic<std::uint64_t> holdBuckets[kLockHistogramBuckets] = {};
+};
+
+namespace {
+
+constexpr std::array<std::uint64_t, kLockHistogramBuckets - 1> kBucketBounds = {
+    256ULL,          1024ULL,          4096ULL,          16384ULL,          65536ULL,          262144ULL,
+    1048576ULL,      4194304ULL,       16777216ULL,      67108864ULL,       268435456ULL,      1073741824ULL};
+
+std::size_t bucketFor(std::uint64_t nanos) {
+    std::size_t bucket = 0;
+    while (bucket < kBucketBounds.size() && nanos > kBucketBounds[bucket]) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+std::int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Counters live for the whole process so static mutexes (e.g. the Logger's)
+// can still unlock during shutdown.
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    LockCounters* countersFor(const char* name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& counters : m_counters) {
+            if (std::strcmp(counters->name, name) == 0) {
+                return counters.get();
+            }
+        }
+        m_counters.push_back(std::make_unique<LockCounters>(name));
+        return m_counters.back().get();
+    }
+
+    std::vector<LockStatsSnapshot> snapshot() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<LockStatsSnapshot> result;
+        result.reserve(m_counters.size());
+        for (const auto& counters : m_counters) {
+            LockStatsSnapshot stats;
+            stats.name = counters->name;
+            stats.contended = counters->contended.load(std::memory_order_relaxed);
+            stats.waitNanos = counters->waitNanos.load(std::memory_order_relaxed);
+            stats.maxWaitNanos = counters->maxWaitNanos.load(std::memory_order_relaxed);
+            stats.holdNanos = counters->holdNanos.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < kLockHistogramBuckets; ++i) {
+                stats.waitBuckets[i] = counters->waitBuckets[i].load(std::memory_order_relaxed);
+                stats.holdBuckets[i] = counters->holdBuckets[i].load(std::memory_order_relaxed);
+                stats.acquisitions += stats.holdBuckets[i];
+            }
+            result.push_back(std::move(stats));
+        }
+        return result;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<LockCounters>> m_counters;
+};
+
+}  // namespace
+
+const std::array<std::uint64_t, kLockHistogramBuckets - 1>& LockRegistry::bucketBoundsNanos() {
+    return kBucketBounds;
+}
+
+std::vector<LockStatsSnapshot> LockRegistry::snapshot() {
+    return Registry::instance().snapshot();
+}
+
+InstrumentedMutex::InstrumentedMutex(const char* name) : m_counters(Registry::instance().countersFor(name)) {}
+
+void InstrumentedMutex::lock() {
+    if (m_mutex.try_lock()) {
+        m_acquiredAtNanos = nowNanos();
+        return;
+    }
+    const std::int64_t waitStart = nowNanos();
+    m_mutex.lock();
+    m_acquiredAtNanos = nowNanos();
+
+    const auto waited = static_cast<std::uint64_t>(m_acquiredAtNanos - waitStart);
+    m_counters->contended.fetch_add(1, std::memory_order_relaxed);
+    m_counters->waitNanos.fetch_add(waited, std::memory_order_relaxed);
+    m_counters->waitBuckets[bucketFor(waited)].fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t previousMax = m_counters->maxWaitNanos.load(std::memory_order_relaxed);
+    while (waited > previousMax &&
+           !m_counters->maxWaitNanos.compare_exchange_weak(previousMax, waited, std::memory_order_relaxed)) {
+    }
+}
+
+bool InstrumentedMutex::try_lock() {
+    if (!m_mutex.try_lock()) {
+        return false;
+    }
+    m_acquiredAtNanos = nowNanos();
+    return true;
+}
+
+void InstrumentedMutex::unlock() {
+    const auto held = static_cast<std::uint64_t>(nowNanos() - m_acquiredAtNanos);
+    m_mutex.unlock();
+    m_counters->holdNanos.fetch_add(held, std::memory_order_relaxed);
+    m_counters->holdBuckets[bucketFor(held)].fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace backend
@@ -4,6 +4,8 @@
 
 #include "backend/Logger.hpp"
 
+#include "backend/AllocationTracker.hpp"
+
 #include <chrono>
 #include <ctime>
 #include <filesystem>
@@ -25,13 +27,13 @@ Logger& Logger::instance() {
 }
 
 Logger::~Logger() {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<InstrumentedMutex> guard(m_mutex);
     delete m_impl;
     m_impl = nullptr;
 }
 
 void Logger::initialize(const std::string& logFilePath) {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<InstrumentedMutex> guard(m_mutex);
 
     if (!m_impl) {
         m_impl = new Impl();
@@ -53,7 +55,8 @@ void Logger::initialize(const std::string& logFilePath) {
 }
 
 void Logger::log(const std::string& message) {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    AllocationScope allocationScope("logger");
+    std::lock_guard<InstrumentedMutex> guard(m_mutex);
     if (!m_initialized || !m_impl) {
         return;
     }
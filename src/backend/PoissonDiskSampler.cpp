@@ -0,0 +1,224 @@
+// File: PoissonDiskSampler.cpp
+// Description: Implements Bridson sampling over a bucket grid with cell size
+//              equal to the spacing, so each candidate checks at most nine
+//              buckets, plus the free-cell fill once spacing reaches one cell.
+
+#include "backend/PoissonDiskSampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace backend {
+
+namespace {
+
+// Candidates tried around an active point before it is retired (Bridson's
+// k). They sit at evenly spaced angles from a random start, just outside the
+// spacing, which packs as tightly as 30 random annulus draws at a fraction
+// of the cost.
+constexpr int kCandidatesPerPoint = 12;
+// Rounding to a cell moves a point by up to sqrt(0.5); candidates start this
+// far beyond the spacing so they never land too close to their origin.
+constexpr double kSnapMargin = 0.71;
+// Random seed attempts when the active list runs dry.
+constexpr int kSeedAttempts = 30;
+// A maximal Poisson-disk set with spacing r holds about 0.65 * area / r^2
+// points; aiming slightly denser leaves room to reach the count in one pass.
+constexpr double kPackingDensity = 0.6;
+constexpr double kShrinkFactor = 0.75;
+constexpr double kTwoPi = 6.283185307179586;
+
+}  // namespace
+
+PoissonDiskSampler::PoissonDiskSampler(int width, int height, std::mt19937& rng)
+    : m_width(width), m_height(height), m_rng(rng) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Sampling area must be positive.");
+    }
+    m_occupied.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), 0);
+}
+
+void PoissonDiskSampler::occupy(Position position) {
+    if (!inBounds(position)) {
+        return;
+    }
+    std::uint8_t& cell = m_occupied[cellIndex(position)];
+    if (!cell) {
+        cell = 1;
+        m_points.push_back(position);
+    }
+}
+
+std::vector<Position> PoissonDiskSampler::sample(std::size_t count, const Accept& accept) {
+    std::vector<Position> placed;
+    placed.reserve(count);
+    if (count == 0) {
+        return placed;
+    }
+
+    const double area = static_cast<double>(m_width) * static_cast<double>(m_height);
+    double radius = std::sqrt(kPackingDensity * area / static_cast<double>(count + m_points.size()));
+    while (placed.size() < count && radius >= 1.0) {
+        runPass(radius, count, accept, placed);
+        radius *= kShrinkFactor;
+    }
+    if (placed.size() < count) {
+        fillFreeCells(count, accept, placed);
+    }
+
+    // More points than the board has cells: stack them, as single spawns do.
+    while (placed.size() < count) {
+        Position position = randomCell();
+        for (int attempt = 0; attempt < 150 && !accept(position, placed.size()); ++attempt) {
+            position = randomCell();
+        }
+        placed.push_back(position);
+    }
+    return placed;
+}
+
+void PoissonDiskSampler::runPass(double radius,
+                                 std::size_t count,
+                                 const Accept& accept,
+                                 std::vector<Position>& placed) {
+    // Bucket grid with cell size = radius: anything closer than radius to a
+    // point lies in its bucket or one of the eight around it.
+    const int gridWidth = static_cast<int>(std::ceil(m_width / radius));
+    const int gridHeight = static_cast<int>(std::ceil(m_height / radius));
+    std::vector<int> heads(static_cast<std::size_t>(gridWidth) * static_cast<std::size_t>(gridHeight), -1);
+    std::vector<int> next;
+    next.reserve(m_points.size() + count - placed.size());
+    const auto bucketOf = [&](Position position) {
+        const int gx = std::min(gridWidth - 1, static_cast<int>(position.x / radius));
+        const int gy = std::min(gridHeight - 1, static_cast<int>(position.y / radius));
+        return std::make_pair(gx, gy);
+    };
+    const auto insert = [&](std::size_t pointIndex) {
+        const auto [gx, gy] = bucketOf(m_points[pointIndex]);
+        int& head = heads[static_cast<std::size_t>(gy) * static_cast<std::size_t>(gridWidth) + static_cast<std::size_t>(gx)];
+        next.push_back(head);
+        head = static_cast<int>(pointIndex);
+    };
+    for (std::size_t i = 0; i < m_points.size(); ++i) {
+        insert(i);
+    }
+
+    const double radiusSquared = radius * radius;
+    const auto fits = [&](Position candidate) {
+        if (!inBounds(candidate) || m_occupied[cellIndex(candidate)]) {
+            return false;
+        }
+        const auto [gx, gy] = bucketOf(candidate);
+        for (int y = std::max(0, gy - 1); y <= std::min(gridHeight - 1, gy + 1); ++y) {
+            for (int x = std::max(0, gx - 1); x <= std::min(gridWidth - 1, gx + 1); ++x) {
+                for (int i = heads[static_cast<std::size_t>(y) * static_cast<std::size_t>(gridWidth) +
+                                   static_cast<std::size_t>(x)];
+                     i >= 0;
+                     i = next[static_cast<std::size_t>(i)]) {
+                    const double dx = m_points[static_cast<std::size_t>(i)].x - candidate.x;
+                    const double dy = m_points[static_cast<std::size_t>(i)].y - candidate.y;
+                    if (dx * dx + dy * dy < radiusSquared) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return accept(candidate, placed.size());
+    };
+
+    std::vector<std::size_t> active;
+    const auto add = [&](Position position) {
+        m_occupied[cellIndex(position)] = 1;
+        m_points.push_back(position);
+        insert(m_points.size() - 1);
+        active.push_back(m_points.size() - 1);
+        placed.push_back(position);
+    };
+
+    std::uniform_real_distribution<double> angleDist(0.0, kTwoPi);
+    const double distance = radius + kSnapMargin;
+    const double stepCos = std::cos(kTwoPi / kCandidatesPerPoint);
+    const double stepSin = std::sin(kTwoPi / kCandidatesPerPoint);
+    while (placed.size() < count) {
+        if (active.empty()) {
+            // Start (or restart, if a region was cut off) from a random cell.
+            bool seeded = false;
+            for (int attempt = 0; attempt < kSeedAttempts && !seeded; ++attempt) {
+                const Position candidate = randomCell();
+                if (fits(candidate)) {
+                    add(candidate);
+                    seeded = true;
+                }
+            }
+            if (!seeded) {
+                return;
+            }
+            continue;
+        }
+
+        std::uniform_int_distribution<std::size_t> pick(0, active.size() - 1);
+        const std::size_t slot = pick(m_rng);
+        const Position origin = m_points[active[slot]];
+        const double start = angleDist(m_rng);
+        double dirX = std::cos(start);
+        double dirY = std::sin(start);
+        bool found = false;
+        for (int attempt = 0; attempt < kCandidatesPerPoint; ++attempt) {
+            const Position candidate{static_cast<int>(std::lround(origin.x + distance * dirX)),
+                                     static_cast<int>(std::lround(origin.y + distance * dirY))};
+            if (fits(candidate)) {
+                add(candidate);
+                found = true;
+                break;
+            }
+            const double rotatedX = dirX * stepCos - dirY * stepSin;
+            dirY = dirX * stepSin + dirY * stepCos;
+            dirX = rotatedX;
+        }
+        if (!found) {
+            active[slot] = active.back();
+            active.pop_back();
+        }
+    }
+}
+
+void PoissonDiskSampler::fillFreeCells(std::size_t count, const Accept& accept, std::vector<Position>& placed) {
+    std::vector<Position> free;
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            if (!m_occupied[cellIndex({x, y})]) {
+                free.push_back({x, y});
+            }
+        }
+    }
+    // Partial Fisher-Yates: draw cells in random order until done.
+    std::size_t remaining = free.size();
+    while (placed.size() < count && remaining > 0) {
+        std::uniform_int_distribution<std::size_t> pick(0, remaining - 1);
+        const std::size_t chosen = pick(m_rng);
+        const Position position = free[chosen];
+        free[chosen] = free[--remaining];
+        if (accept(position, placed.size())) {
+            m_occupied[cellIndex(position)] = 1;
+            m_points.push_back(position);
+            placed.push_back(position);
+        }
+    }
+}
+
+bool PoissonDiskSampler::inBounds(Position position) const noexcept {
+    return position.x >= 0 && position.y >= 0 && position.x < m_width && position.y < m_height;
+}
+
+std::size_t PoissonDiskSampler::cellIndex(Position position) const noexcept {
+    return static_cast<std::size_t>(position.y) * static_cast<std::size_t>(m_width) + static_cast<std::size_t>(position.x);
+}
+
+Position PoissonDiskSampler::randomCell() {
+    std::uniform_int_distribution<int> widthDist(0, m_width - 1);
+    std::uniform_int_distribution<int> heightDist(0, m_height - 1);
+    return {widthDist(m_rng), heightDist(m_rng)};
+}
+
+}  // namespace backend
@@ -0,0 +1,357 @@
+// File: SamplingProfiler.cpp
+// Description: Implements the SIGPROF sampler: timer setup per platform,
+//              the async-signal-safe frame-pointer walk and stack table,
+//              and symbolization into folded stacks once sampling stops.
+
+#include "backend/SamplingProfiler.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/uio.h>
+#include <time.h>
+#include <ucontext.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/time.h>
+#include <sys/ucontext.h>
+#endif
+
+#if (defined(__linux__) || defined(__APPLE__)) && (defined(__x86_64__) || defined(__aarch64__))
+#define TANK_PROFILER_SUPPORTED 1
+#else
+#define TANK_PROFILER_SUPPORTED 0
+#endif
+
+namespace backend {
+
+namespace {
+
+constexpr std::size_t kMaxFrames = 64;
+constexpr std::size_t kTableSlots = 4096;  // power of two
+constexpr std::size_t kMaxProbes = 64;
+// A caller's frame sits above the callee's; larger jumps mean a broken chain.
+constexpr std::uintptr_t kMaxFrameBytes = 1 << 20;
+
+struct StackSlot {
+    std::atomic<std::uint64_t> hash{0};  // 0 = free
+    std::atomic<std::uint32_t> count{0};
+    std::atomic<bool> ready{false};
+    std::uint32_t depth{0};
+    std::uintptr_t frames[kMaxFrames];
+};
+
+// Fixed-size open-addressing table written from signal handlers: slots are
+// claimed with a CAS on the hash and counted with fetch_add, so concurrent
+// samples on different threads never block each other.
+struct StackTable {
+    StackSlot slots[kTableSlots];
+    std::atomic<std::uint64_t> samples{0};
+    std::atomic<std::uint64_t> dropped{0};
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "stack table needs lock-free 64-bit atomics");
+
+std::atomic<StackTable*> g_table{nullptr};
+std::atomic<int> g_activeHandlers{0};
+
+#if TANK_PROFILER_SUPPORTED
+
+#if defined(__linux__)
+pid_t g_pid = 0;
+#endif
+
+// Reads through the kernel so a corrupt frame pointer yields an error
+// instead of a fault inside the signal handler.
+bool readMemory(std::uintptr_t address, void* out, std::size_t size) {
+#if defined(__linux__)
+    iovec local{out, size};
+    iovec remote{reinterpret_cast<void*>(address), size};
+    return ::process_vm_readv(g_pid, &local, 1, &remote, 1, 0) == static_cast<ssize_t>(size);
+#else
+    vm_size_t copied = 0;
+    return ::vm_read_overwrite(mach_task_self(), static_cast<vm_address_t>(address), size,
+                               reinterpret_cast<vm_address_t>(out), &copied) == KERN_SUCCESS &&
+           copied == size;
+#endif
+}
+
+std::uint32_t captureStack(void* context, std::uintptr_t* frames) {
+    const auto* uc = static_cast<const ucontext_t*>(context);
+    std::uintptr_t pc = 0;
+    std::uintptr_t fp = 0;
+#if defined(__linux__) && defined(__x86_64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__linux__) && defined(__aarch64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext.pc);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext.regs[29]);
+#elif defined(__APPLE__) && defined(__x86_64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext->__ss.__rip);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext->__ss.__rbp);
+#elif defined(__APPLE__) && defined(__aarch64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext->__ss.__pc);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext->__ss.__fp);
+#endif
+    if (pc == 0) {
+        return 0;
+    }
+    std::uint32_t depth = 0;
+    frames[depth++] = pc;
+    // Each frame record is {caller's frame pointer, return address}.
+    while (depth < kMaxFrames && fp != 0 && fp % sizeof(std::uintptr_t) == 0) {
+        std::uintptr_t record[2];
+        if (!readMemory(fp, record, sizeof(record)) || record[1] == 0) {
+            break;
+        }
+        frames[depth++] = record[1];
+        if (record[0] <= fp || record[0] - fp > kMaxFrameBytes) {
+            break;
+        }
+        fp = record[0];
+    }
+    return depth;
+}
+
+std::uint64_t hashFrames(const std::uintptr_t* frames, std::uint32_t depth) {
+    std::uint64_t h = 0xCBF29CE484222325ULL ^ depth;
+    for (std::uint32_t i = 0; i < depth; ++i) {
+        h ^= static_cast<std::uint64_t>(frames[i]);
+        h *= 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    return h | 1;  // never 0, which marks a free slot
+}
+
+void recordStack(StackTable& table, const std::uintptr_t* frames, std::uint32_t depth) {
+    const std::uint64_t hash = hashFrames(frames, depth);
+    for (std::size_t probe = 0; probe < kMaxProbes; ++probe) {
+        StackSlot& slot = table.slots[(hash + probe) & (kTableSlots - 1)];
+        std::uint64_t current = slot.hash.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (slot.hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel)) {
+                slot.depth = depth;
+                std::memcpy(slot.frames, frames, depth * sizeof(std::uintptr_t));
+                slot.ready.store(true, std::memory_order_release);
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        // Equal 64-bit hashes are treated as the same stack.
+        if (current == hash) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    table.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void onProfilingSignal(int, siginfo_t*, void* context) {
+    const int savedErrno = errno;
+    g_activeHandlers.fetch_add(1);
+    if (StackTable* table = g_table.load()) {
+        std::uintptr_t frames[kMaxFrames];
+        const std::uint32_t depth = captureStack(context, frames);
+        if (depth > 0) {
+            recordStack(*table, frames, depth);
+        }
+        table->samples.fetch_add(1, std::memory_order_relaxed);
+    }
+    g_activeHandlers.fetch_sub(1);
+    errno = savedErrno;
+}
+
+// Arms a timer on process CPU time, so busy threads are sampled in
+// proportion to the CPU they use and idle ones not at all.
+class CpuTimer {
+public:
+    bool start(int frequencyHz) {
+        const long intervalNs = 1000000000L / frequencyHz;
+#if defined(__linux__)
+        sigevent event {};
+        event.sigev_notify = SIGEV_SIGNAL;
+        event.sigev_signo = SIGPROF;
+        if (::timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &m_timer) != 0) {
+            return false;
+        }
+        m_created = true;
+        itimerspec spec {};
+        spec.it_interval.tv_sec = intervalNs / 1000000000L;
+        spec.it_interval.tv_nsec = intervalNs % 1000000000L;
+        spec.it_value = spec.it_interval;
+        return ::timer_settime(m_timer, 0, &spec, nullptr) == 0;
+#else
+        itimerval spec {};
+        spec.it_interval.tv_sec = static_cast<time_t>(intervalNs / 1000000000L);
+        spec.it_interval.tv_usec = static_cast<suseconds_t>((intervalNs % 1000000000L) / 1000);
+        spec.it_value = spec.it_interval;
+        return ::setitimer(ITIMER_PROF, &spec, nullptr) == 0;
+#endif
+    }
+
+    ~CpuTimer() {
+#if defined(__linux__)
+        if (m_created) {
+            ::timer_delete(m_timer);
+        }
+#else
+        itimerval off {};
+        ::setitimer(ITIMER_PROF, &off, nullptr);
+#endif
+    }
+
+private:
+#if defined(__linux__)
+    timer_t m_timer{};
+    bool m_created{false};
+#endif
+};
+
+#endif  // TANK_PROFILER_SUPPORTED
+
+std::string symbolize(std::uintptr_t address) {
+    Dl_info info {};
+    if (::dladdr(reinterpret_cast<void*>(address), &info) != 0) {
+        if (info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+            std::free(demangled);
+            return name;
+        }
+        if (info.dli_fname) {
+            const char* base = std::strrchr(info.dli_fname, '/');
+            char offset[32];
+            std::snprintf(offset, sizeof(offset), "+0x%zx",
+                          static_cast<std::size_t>(address - reinterpret_cast<std::uintptr_t>(info.dli_fbase)));
+            return std::string(base ? base + 1 : info.dli_fname) + offset;
+        }
+    }
+    char raw[32];
+    std::snprintf(raw, sizeof(raw), "0x%zx", static_cast<std::size_t>(address));
+    return raw;
+}
+
+}  // namespace
+
+SamplingProfiler& SamplingProfiler::instance() {
+    static SamplingProfiler profiler;
+    return profiler;
+}
+
+bool SamplingProfiler::supported() {
+    return TANK_PROFILER_SUPPORTED != 0;
+}
+
+bool SamplingProfiler::profile(const ProfileOptions& options, ProfileResult& result, std::string& error) {
+#if TANK_PROFILER_SUPPORTED
+    bool idle = false;
+    if (!m_running.compare_exchange_strong(idle, true)) {
+        error = "A profile is already running.";
+        return false;
+    }
+    struct RunningGuard {
+        std::atomic<bool>& flag;
+        ~RunningGuard() { flag.store(false); }
+    } runningGuard{m_running};
+
+    auto table = std::make_unique<StackTable>();
+#if defined(__linux__)
+    g_pid = ::getpid();
+#endif
+
+    struct sigaction action {};
+    action.sa_sigaction = onProfilingSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    struct sigaction previous {};
+    if (::sigaction(SIGPROF, &action, &previous) != 0) {
+        error = std::string("sigaction failed: ") + std::strerror(errno);
+        return false;
+    }
+    g_table.store(table.get());
+
+    bool armed = false;
+    {
+        CpuTimer timer;
+        armed = timer.start(options.frequencyHz > 0 ? options.frequencyHz : 99);
+        if (armed) {
+            std::this_thread::sleep_for(options.duration);
+        } else {
+            error = std::string("Failed to arm profiling timer: ") + std::strerror(errno);
+        }
+    }
+
+    // Timer is gone; wait out handlers that already picked up the table.
+    g_table.store(nullptr);
+    while (g_activeHandlers.load() != 0) {
+        std::this_thread::yield();
+    }
+    // A SIGPROF still in flight must not hit the default action (terminate).
+    if (previous.sa_handler == SIG_DFL && !(previous.sa_flags & SA_SIGINFO)) {
+        struct sigaction ignore {};
+        ignore.sa_handler = SIG_IGN;
+        sigemptyset(&ignore.sa_mask);
+        ::sigaction(SIGPROF, &ignore, nullptr);
+    } else {
+        ::sigaction(SIGPROF, &previous, nullptr);
+    }
+    if (!armed) {
+        return false;
+    }
+
+    std::unordered_map<std::uintptr_t, std::string> symbols;
+    std::map<std::string, std::uint64_t> folded;
+    std::string line;
+    for (const StackSlot& slot : table->slots) {
+        if (!slot.ready.load(std::memory_order_acquire)) {
+            continue;
+        }
+        line.clear();
+        for (std::uint32_t i = slot.depth; i-- > 0;) {
+            // Return addresses point past the call; step back into it.
+            const std::uintptr_t address = i == 0 ? slot.frames[i] : slot.frames[i] - 1;
+            auto found = symbols.find(address);
+            if (found == symbols.end()) {
+                found = symbols.emplace(address, symbolize(address)).first;
+            }
+            if (!line.empty()) {
+                line += ';';
+            }
+            line += found->second;
+        }
+        folded[line] += slot.count.load(std::memory_order_relaxed);
+    }
+
+    result = ProfileResult{};
+    result.samples = table->samples.load();
+    result.dropped = table->dropped.load();
+    result.uniqueStacks = folded.size();
+    for (const auto& [stack, count] : folded) {
+        result.folded += stack;
+        result.folded += ' ';
+        result.folded += std::to_string(count);
+        result.folded += '\n';
+    }
+    return true;
+#else
+    (void)options;
+    (void)result;
+    error = "Sampling profiler is not supported on this platform.";
+    return false;
+#endif
+}
+
+}  // namespace backend
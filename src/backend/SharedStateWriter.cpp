@@ -0,0 +1,121 @@
+// File: SharedStateWriter.cpp
+// Description: Creates the POSIX shared-memory segment for the state export
+//              and implements the seqlock write: bump the sequence to odd,
+//              overwrite the snapshot in place, bump it back to even.
+
+#include "backend/SharedStateWriter.hpp"
+
+#include "backend/GameEngine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace backend {
+
+SharedStateWriter::SharedStateWriter(std::string name, std::size_t envelopeCapacity)
+    : m_name(std::move(name)) {
+    if (m_name.empty() || m_name.front() != '/') {
+        m_name.insert(m_name.begin(), '/');
+    }
+    constexpr std::size_t kMaxCapacity = std::numeric_limits<std::uint32_t>::max() / sizeof(SharedEnvelope);
+    m_capacity = static_cast<std::uint32_t>(std::clamp<std::size_t>(envelopeCapacity, 1, kMaxCapacity));
+    m_bytes = sharedStateBytes(m_capacity);
+
+    // A segment left behind by a crashed server may have another size;
+    // readers still mapping it keep their copy until they reopen.
+    ::shm_unlink(m_name.c_str());
+    const int fd = ::shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create shared state " + m_name + ": " + std::strerror(errno));
+    }
+    if (::ftruncate(fd, static_cast<off_t>(m_bytes)) != 0) {
+        const int error = errno;
+        ::close(fd);
+        ::shm_unlink(m_name.c_str());
+        throw std::runtime_error("Cannot size shared state " + m_name + ": " + std::strerror(error));
+    }
+    void* base = ::mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        const int error = errno;
+        ::shm_unlink(m_name.c_str());
+        throw std::runtime_error("Cannot map shared state " + m_name + ": " + std::strerror(error));
+    }
+
+    // The mapping starts zeroed; construct the header in place over it.
+    m_header = new (base) SharedStateHeader{};
+    m_header->magic = kSharedStateMagic;
+    m_header->version = kSharedStateVersion;
+    m_header->envelopeCapacity = m_capacity;
+    m_header->headerBytes = sizeof(SharedStateHeader);
+}
+
+SharedStateWriter::~SharedStateWriter() {
+    ::munmap(m_header, m_bytes);
+    ::shm_unlink(m_name.c_str());
+}
+
+void SharedStateWriter::publish(const GameEngine& engine) {
+    const GameConfig& config = engine.getConfig();
+    const Tank& tank = engine.getTank();
+    const CollectionStats stats = engine.getStats();
+    const std::vector<RedEnvelope>& envelopes = engine.getEnvelopes();
+    const std::size_t count = std::min<std::size_t>(envelopes.size(), m_capacity);
+    const double elapsed = engine.elapsedSeconds();
+
+    const std::uint64_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+    m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    // Readers that see any of the writes below also see the odd sequence.
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SharedStateSnapshot& snapshot = m_header->snapshot;
+    snapshot.publishCount = ++m_publishCount;
+    snapshot.publishedNanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    const double limit = static_cast<double>(config.timeLimitSeconds);
+    snapshot.elapsedMillis = static_cast<std::uint64_t>(std::min(elapsed, limit) * 1000.0);
+    snapshot.worldWidth = config.worldWidth;
+    snapshot.worldHeight = config.worldHeight;
+    snapshot.timeLimitSeconds = config.timeLimitSeconds;
+    snapshot.paused = engine.isPaused() ? 1 : 0;
+    snapshot.timeUp = engine.isTimeUp() ? 1 : 0;
+    const Position tankPosition = tank.getPosition();
+    snapshot.tankX = tankPosition.x;
+    snapshot.tankY = tankPosition.y;
+    snapshot.tankStep = tank.getMoveStep();
+    snapshot.tankDirection = static_cast<std::int32_t>(tank.getLastDirection());
+    snapshot.tankUnitsX = tank.getUnitsX();
+    snapshot.tankUnitsY = tank.getUnitsY();
+    snapshot.tankMomentumUnits = tank.getMomentumUnits();
+    snapshot.collectedCount = stats.collectedCount;
+    snapshot.collectedValue = stats.collectedValue;
+    snapshot.envelopeCount = static_cast<std::uint32_t>(count);
+    snapshot.envelopeTotal = static_cast<std::uint32_t>(std::min<std::size_t>(envelopes.size(), UINT32_MAX));
+
+    SharedEnvelope* out = sharedEnvelopes(m_header);
+    for (std::size_t i = 0; i < count; ++i) {
+        const RedEnvelope& envelope = envelopes[i];
+        const Position position = envelope.getPosition();
+        out[i] = SharedEnvelope{static_cast<std::uint64_t>(envelope.getId()),
+                                position.x,
+                                position.y,
+                                envelope.getValue(),
+                                static_cast<std::uint8_t>(envelope.getSize()),
+                                static_cast<std::uint8_t>(envelope.getCollectionRadius()),
+                                {0, 0}};
+    }
+
+    m_header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+}  // namespace backend
@@ -4,19 +4,27 @@
 #include "backend/Tank.hpp"
 
 #include <algorithm>
-#include <cmath>
 
 namespace backend {
 
+namespace {
+
+// Nearest cell for a non-negative unit coordinate, halves rounding up.
+int toCell(std::int64_t units) noexcept {
+    return static_cast<int>((units + Tank::kUnitsPerCell / 2) / Tank::kUnitsPerCell);
+}
+
+}  // namespace
+
 Tank::Tank(Position startPosition, int moveStep)
     : m_position(startPosition),
       m_moveStep(std::max(1, moveStep)),
-      m_exactX(static_cast<double>(startPosition.x)),
-      m_exactY(static_cast<double>(startPosition.y)) {
-    const double base = static_cast<double>(m_moveStep);
-    m_momentumIncrement = base * 0.45;
-    m_momentumDecay = base * 0.6;
-    m_momentumMax = base * 3.5;
+      m_unitsX(startPosition.x * kUnitsPerCell),
+      m_unitsY(startPosition.y * kUnitsPerCell) {
+    const std::int64_t base = m_moveStep * kUnitsPerCell;
+    m_momentumIncrement = base * 45 / 100;
+    m_momentumDecay = base * 60 / 100;
+    m_momentumMax = base * 350 / 100;
 }
 
 Position Tank::getPosition() const noexcept {
@@ -24,33 +32,50 @@ Position Tank::getPosition() const noexcept {
 }
 
 double Tank::getExactX() const noexcept {
-    return m_exactX;
+    return static_cast<double>(m_unitsX) / kUnitsPerCell;
 }
 
 double Tank::getExactY() const noexcept {
-    return m_exactY;
+    return static_cast<double>(m_unitsY) / kUnitsPerCell;
 }
 
 int Tank::getMoveStep() const noexcept {
     return m_moveStep;
 }
 
+std::int64_t Tank::getUnitsX() const noexcept {
+    return m_unitsX;
+}
+
+std::int64_t Tank::getUnitsY() const noexcept {
+    return m_unitsY;
+}
+
+std::int64_t Tank::getMomentumUnits() const noexcept {
+    return m_currentMomentum;
+}
+
+MoveDirection Tank::getLastDirection() const noexcept {
+    return m_lastDirection;
+}
+
+// Keep in step with predictTankMove() in web/index.html.
 bool Tank::move(MoveDirection direction, int worldWidth, int worldHeight) noexcept {
     if (direction == MoveDirection::None) {
-        m_currentMomentum = 0.0;
+        m_currentMomentum = 0;
         m_lastDirection = MoveDirection::None;
         return false;
     }
 
     if (m_lastDirection == direction) {
         m_currentMomentum = std::min(m_currentMomentum + m_momentumIncrement, m_momentumMax);
-    } else if (m_currentMomentum > 0.0) {
-        m_currentMomentum = std::max(0.0, m_currentMomentum - m_momentumDecay);
+    } else if (m_currentMomentum > 0) {
+        m_currentMomentum = std::max<std::int64_t>(0, m_currentMomentum - m_momentumDecay);
     }
-    const double delta = static_cast<double>(m_moveStep) + m_currentMomentum;
+    const std::int64_t delta = m_moveStep * kUnitsPerCell + m_currentMomentum;
 
-    double nextX = m_exactX;
-    double nextY = m_exactY;
+    std::int64_t nextX = m_unitsX;
+    std::int64_t nextY = m_unitsY;
     switch (direction) {
         case MoveDirection::Up:
             nextY -= delta;
@@ -68,10 +93,10 @@ bool Tank::move(MoveDirection direction, int worldWidth, int worldHeight) noexce
             break;
     }
 
-    const double minX = 0.0;
-    const double minY = 0.0;
-    const double maxX = std::max(0, worldWidth - 1);
-    const double maxY = std::max(0, worldHeight - 1);
+    const std::int64_t minX = 0;
+    const std::int64_t minY = 0;
+    const std::int64_t maxX = std::max(0, worldWidth - 1) * kUnitsPerCell;
+    const std::int64_t maxY = std::max(0, worldHeight - 1) * kUnitsPerCell;
 
     bool clamped = false;
     if (nextX < minX) {
@@ -91,14 +116,13 @@ bool Tank::move(MoveDirection direction, int worldWidth, int worldHeight) noexce
     }
 
     if (clamped) {
-        m_currentMomentum = 0.0;
+        m_currentMomentum = 0;
     }
 
     const Position previous = m_position;
-    m_exactX = nextX;
-    m_exactY = nextY;
-    m_position = {static_cast<int>(std::round(nextX)),
-                  static_cast<int>(std::round(nextY))};
+    m_unitsX = nextX;
+    m_unitsY = nextY;
+    m_position = {toCell(nextX), toCell(nextY)};
     m_lastDirection = direction;
 
     return m_position.x != previous.x || m_position.y != previous.y;
@@ -106,9 +130,9 @@ bool Tank::move(MoveDirection direction, int worldWidth, int worldHeight) noexce
 
 void Tank::setPosition(Position newPosition) noexcept {
     m_position = newPosition;
-    m_exactX = static_cast<double>(newPosition.x);
-    m_exactY = static_cast<double>(newPosition.y);
-    m_currentMomentum = 0.0;
+    m_unitsX = newPosition.x * kUnitsPerCell;
+    m_unitsY = newPosition.y * kUnitsPerCell;
+    m_currentMomentum = 0;
     m_lastDirection = MoveDirection::None;
 }
 
@@ -0,0 +1,197 @@
+// File: TimerWheel.cpp
+// Description: Implements the hierarchical timing wheel: slot placement by
+//              the highest tick digit that differs from now, cascading of
+//              coarse slots as time reaches them, and bitmap-driven skipping
+//              of empty stretches.
+
+#include "backend/TimerWheel.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace backend {
+
+namespace {
+
+int highestBit(std::uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+int lowestBit(std::uint64_t value) {
+    return __builtin_ctzll(value);
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel() {
+    for (auto& level : m_heads) {
+        level.fill(kNil);
+    }
+}
+
+TimerId TimerWheel::schedule(std::uint64_t delayTicks, Callback callback) {
+    delayTicks = std::clamp<std::uint64_t>(delayTicks, 1, kMaxDelay);
+    std::uint32_t index = 0;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    Node& node = m_nodes[index];
+    node.expiry = m_now + delayTicks;
+    node.callback = std::move(callback);
+    node.active = true;
+    link(index);
+    ++m_size;
+    return (static_cast<TimerId>(node.generation) << 32) | (static_cast<TimerId>(index) + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (!lookup(id)) {
+        return false;
+    }
+    const auto index = static_cast<std::uint32_t>((id & 0xffffffffULL) - 1);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+bool TimerWheel::pending(TimerId id) const noexcept {
+    return lookup(id) != nullptr;
+}
+
+std::size_t TimerWheel::advance(std::uint64_t target) {
+    std::size_t fired = 0;
+    for (std::uint64_t tick = nextTick(); tick <= target; tick = nextTick()) {
+        m_now = tick;
+        // Coarse slots first: each cascade may refill the level below it.
+        for (std::size_t level = kLevels - 1; level > 0; --level) {
+            const std::size_t shift = level * kSlotBits;
+            if ((tick & ((std::uint64_t{1} << shift) - 1)) == 0) {
+                cascade(level, static_cast<std::size_t>((tick >> shift) & (kSlots - 1)));
+            }
+        }
+        fired += fireSlot(static_cast<std::size_t>(tick & (kSlots - 1)));
+    }
+    m_now = std::max(m_now, target);
+    return fired;
+}
+
+void TimerWheel::clear() {
+    for (std::uint32_t index = 0; index < m_nodes.size(); ++index) {
+        if (m_nodes[index].active) {
+            release(index);
+        }
+    }
+    for (auto& level : m_heads) {
+        level.fill(kNil);
+    }
+    m_occupied.fill(0);
+    m_now = 0;
+}
+
+void TimerWheel::link(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    const std::uint64_t differing = node.expiry ^ m_now;
+    std::size_t level = differing == 0 ? 0 : static_cast<std::size_t>(highestBit(differing)) / kSlotBits;
+    level = std::min(level, kLevels - 1);
+    const auto slot = static_cast<std::size_t>((node.expiry >> (level * kSlotBits)) & (kSlots - 1));
+    node.level = static_cast<std::uint8_t>(level);
+    node.slot = static_cast<std::uint8_t>(slot);
+    node.prev = kNil;
+    node.next = m_heads[level][slot];
+    if (node.next != kNil) {
+        m_nodes[node.next].prev = index;
+    }
+    m_heads[level][slot] = index;
+    m_occupied[level] |= std::uint64_t{1} << slot;
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    if (node.prev != kNil) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_heads[node.level][node.slot] = node.next;
+        if (node.next == kNil) {
+            m_occupied[node.level] &= ~(std::uint64_t{1} << node.slot);
+        }
+    }
+    if (node.next != kNil) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = kNil;
+    node.next = kNil;
+}
+
+void TimerWheel::release(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    node.callback = nullptr;
+    node.active = false;
+    ++node.generation;
+    m_free.push_back(index);
+    --m_size;
+}
+
+std::uint64_t TimerWheel::nextTick() const noexcept {
+    // A slot at level L always lies after every slot below it, so the first
+    // occupied slot past the current position at the lowest level wins.
+    for (std::size_t level = 0; level < kLevels; ++level) {
+        const std::size_t shift = level * kSlotBits;
+        const std::size_t current = static_cast<std::size_t>((m_now >> shift) & (kSlots - 1));
+        const std::uint64_t ahead = current + 1 == kSlots ? 0 : ~std::uint64_t{0} << (current + 1);
+        std::uint64_t rotation = (m_now >> (shift + kSlotBits)) << (shift + kSlotBits);
+        std::uint64_t bits = m_occupied[level] & ahead;
+        if (bits == 0 && level + 1 == kLevels && m_occupied[level] != 0) {
+            // The top level is a ring: slots at or behind the current one
+            // belong to the next rotation.
+            bits = m_occupied[level];
+            rotation += std::uint64_t{1} << (shift + kSlotBits);
+        }
+        if (bits != 0) {
+            return rotation + (static_cast<std::uint64_t>(lowestBit(bits)) << shift);
+        }
+    }
+    return UINT64_MAX;
+}
+
+void TimerWheel::cascade(std::size_t level, std::size_t slot) {
+    std::uint32_t index = m_heads[level][slot];
+    m_heads[level][slot] = kNil;
+    m_occupied[level] &= ~(std::uint64_t{1} << slot);
+    while (index != kNil) {
+        const std::uint32_t next = m_nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+std::size_t TimerWheel::fireSlot(std::size_t slot) {
+    std::size_t fired = 0;
+    // Re-read the head each time: a callback may cancel its neighbours.
+    while (m_heads[0][slot] != kNil) {
+        const std::uint32_t index = m_heads[0][slot];
+        unlink(index);
+        Callback callback = std::move(m_nodes[index].callback);
+        release(index);
+        callback();
+        ++fired;
+    }
+    return fired;
+}
+
+const TimerWheel::Node* TimerWheel::lookup(TimerId id) const noexcept {
+    const std::uint64_t low = id & 0xffffffffULL;
+    if (low == 0 || low > m_nodes.size()) {
+        return nullptr;
+    }
+    const Node& node = m_nodes[low - 1];
+    if (!node.active || node.generation != static_cast<std::uint32_t>(id >> 32)) {
+        return nullptr;
+    }
+    return &node;
+}
+
+}  // namespace backend
@@ -0,0 +1,319 @@
+// File: Tracing.cpp
+// Description: Implements request tracing: the pool of per-thread span
+//              rings, request sampling, and the Chrome trace-event export.
+
+#include "backend/Tracing.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace backend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kDetailBytes = 48;
+constexpr std::size_t kMinEventsPerThread = 64;
+constexpr std::size_t kMaxEventsPerThread = 1 << 20;
+
+struct TraceEvent {
+    const char* name;
+    std::uint64_t begin;
+    std::uint64_t end;
+    char detail[kDetailBytes];
+};
+
+// Single-writer ring: the owning thread fills a slot, then publishes it by
+// advancing head; readers copy and discard whatever the writer may have
+// overwritten meanwhile.
+struct ThreadBuffer {
+    ThreadBuffer(std::uint32_t bufferId, std::size_t capacity) : id(bufferId), events(capacity) {}
+
+    std::uint32_t id;
+    std::vector<TraceEvent> events;
+    std::atomic<std::uint64_t> head{0};
+};
+
+// Connections run on short-lived threads, so rings are pooled: a thread
+// takes one on its first recorded span and returns it on exit, and spans
+// survive the thread that wrote them.
+class BufferPool {
+public:
+    ThreadBuffer* acquire(std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty()) {
+            ThreadBuffer* buffer = m_idle.back();
+            m_idle.pop_back();
+            return buffer;
+        }
+        m_buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(m_buffers.size() + 1), capacity));
+        return m_buffers.back().get();
+    }
+
+    void release(ThreadBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.push_back(buffer);
+    }
+
+    // Copies events that began within [from, to] from every ring.
+    void collect(std::uint64_t from, std::uint64_t to, std::vector<std::pair<std::uint32_t, TraceEvent>>& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<TraceEvent> copy;
+        for (const auto& buffer : m_buffers) {
+            const std::uint64_t capacity = buffer->events.size();
+            const std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+            const std::uint64_t first = head > capacity ? head - capacity : 0;
+            copy.clear();
+            for (std::uint64_t i = first; i < head; ++i) {
+                copy.push_back(buffer->events[i % capacity]);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The slot at the new head may be half written, hence the +1.
+            const std::uint64_t headAfter = buffer->head.load(std::memory_order_relaxed);
+            const std::uint64_t valid = headAfter >= capacity ? headAfter - capacity + 1 : 0;
+            for (std::uint64_t i = std::max(first, valid); i < head; ++i) {
+                const TraceEvent& event = copy[i - first];
+                if (event.begin >= from && event.begin <= to) {
+                    out.emplace_back(buffer->id, event);
+                }
+            }
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::vector<ThreadBuffer*> m_idle;
+};
+
+// Never destroyed: threads may still exit and return rings during shutdown.
+BufferPool& bufferPool() {
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+struct ThreadState {
+    ThreadBuffer* buffer{nullptr};
+    bool sampled{false};
+
+    ~ThreadState() {
+        if (buffer) {
+            bufferPool().release(buffer);
+        }
+    }
+};
+
+thread_local ThreadState t_state;
+
+void appendJsonEscaped(std::string& out, const char* text) {
+    for (const char* p = text; *p; ++p) {
+        const unsigned char ch = static_cast<unsigned char>(*p);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += static_cast<char>(ch);
+        } else if (ch < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+            out += escaped;
+        } else {
+            out += static_cast<char>(ch);
+        }
+    }
+}
+
+void appendMicros(std::string& out, double micros) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", micros);
+    out += buffer;
+}
+
+}  // namespace
+
+TraceOptions TraceOptions::fromEnvironment() {
+    TraceOptions options;
+    if (const char* value = std::getenv("TANK_TRACE_SAMPLE_RATE")) {
+        char* endPtr = nullptr;
+        const double parsed = std::strtod(value, &endPtr);
+        if (endPtr && endPtr != value && *endPtr == '\0') {
+            options.sampleRate = std::clamp(parsed, 0.0, 1.0);
+        }
+    }
+    if (const char* value = std::getenv("TANK_TRACE_BUFFER_EVENTS")) {
+        char* endPtr = nullptr;
+        const unsigned long long parsed = std::strtoull(value, &endPtr, 10);
+        if (endPtr && endPtr != value && *endPtr == '\0' && parsed > 0) {
+            options.eventsPerThread = static_cast<std::size_t>(parsed);
+        }
+    }
+    return options;
+}
+
+struct Tracer::Impl {
+    // Sampling as an integer rate so beginRequest stays branch-cheap.
+    std::atomic<std::uint64_t> samplesPerMillion{1000000};
+    std::atomic<std::size_t> eventsPerThread{1024};
+    std::atomic<std::uint64_t> requests{0};
+};
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() : m_impl(std::make_unique<Impl>()) {
+    configure(TraceOptions::fromEnvironment());
+}
+
+Tracer::~Tracer() = default;
+
+void Tracer::configure(const TraceOptions& options) {
+    m_impl->samplesPerMillion.store(static_cast<std::uint64_t>(std::clamp(options.sampleRate, 0.0, 1.0) * 1e6));
+    m_impl->eventsPerThread.store(std::clamp(options.eventsPerThread, kMinEventsPerThread, kMaxEventsPerThread));
+}
+
+void Tracer::beginRequest() {
+    if (m_captures.load(std::memory_order_relaxed) == 0) {
+        t_state.sampled = false;
+        return;
+    }
+    // Evenly spaced: request n is sampled when n * rate crosses an integer.
+    const std::uint64_t n = m_impl->requests.fetch_add(1, std::memory_order_relaxed);
+    const std::uint64_t rate = m_impl->samplesPerMillion.load(std::memory_order_relaxed);
+    t_state.sampled = (n + 1) * rate / 1000000 != n * rate / 1000000;
+}
+
+bool Tracer::sampled() const noexcept {
+    return t_state.sampled;
+}
+
+void Tracer::record(const char* name, std::uint64_t beginTicks, std::uint64_t endTicks, std::string_view detail) {
+    if (!t_state.sampled) {
+        return;
+    }
+    if (!t_state.buffer) {
+        t_state.buffer = bufferPool().acquire(m_impl->eventsPerThread.load(std::memory_order_relaxed));
+    }
+    ThreadBuffer& buffer = *t_state.buffer;
+    const std::uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer.events[index % buffer.events.size()];
+    event.name = name;
+    event.begin = beginTicks;
+    event.end = endTicks;
+    const std::size_t length = std::min(detail.size(), kDetailBytes - 1);
+    std::memcpy(event.detail, detail.data(), length);
+    event.detail[length] = '\0';
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+std::string Tracer::capture(std::chrono::milliseconds window) {
+    const std::uint64_t startTicks = now();
+    const Clock::time_point startTime = Clock::now();
+    m_captures.fetch_add(1);
+    std::this_thread::sleep_for(window);
+    m_captures.fetch_sub(1);
+    const std::uint64_t endTicks = now();
+    const Clock::time_point endTime = Clock::now();
+
+    // Calibrate ticks against the steady clock over the capture itself.
+    const double elapsedMicros = std::chrono::duration<double, std::micro>(endTime - startTime).count();
+    const double ticksPerMicro =
+        elapsedMicros > 0.0 && endTicks > startTicks ? static_cast<double>(endTicks - startTicks) / elapsedMicros : 1e3;
+
+    std::vector<std::pair<std::uint32_t, TraceEvent>> events;
+    bufferPool().collect(startTicks, endTicks, events);
+    std::sort(events.begin(), events.end(),
+              [](const auto& a, const auto& b) { return a.second.begin < b.second.begin; });
+
+    const long pid = static_cast<long>(::getpid());
+    std::string out;
+    out.reserve(256 + events.size() * 128);
+    out += R"({"displayTimeUnit":"ms","otherData":{"windowMs":)";
+    out += std::to_string(window.count());
+    out += R"(,"sampleRate":)";
+    out += std::to_string(static_cast<double>(m_impl->samplesPerMillion.load()) / 1e6);
+    out += R"(,"events":)";
+    out += std::to_string(events.size());
+    out += R"(},"traceEvents":[{"name":"process_name","ph":"M","pid":)";
+    out += std::to_string(pid);
+    out += R"(,"tid":0,"args":{"name":"tank_red_envelope"}})";
+
+    std::vector<std::uint32_t> threads;
+    for (const auto& [thread, event] : events) {
+        threads.push_back(thread);
+    }
+    std::sort(threads.begin(), threads.end());
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+    for (const std::uint32_t thread : threads) {
+        out += R"(,{"name":"thread_name","ph":"M","pid":)";
+        out += std::to_string(pid);
+        out += R"(,"tid":)";
+        out += std::to_string(thread);
+        out += R"(,"args":{"name":"worker )";
+        out += std::to_string(thread);
+        out += R"("}})";
+    }
+
+    for (const auto& [thread, event] : events) {
+        out += R"(,{"name":")";
+        out += event.name;
+        out += R"(","cat":"request","ph":"X","pid":)";
+        out += std::to_string(pid);
+        out += R"(,"tid":)";
+        out += std::to_string(thread);
+        out += R"(,"ts":)";
+        appendMicros(out, static_cast<double>(event.begin - startTicks) / ticksPerMicro);
+        out += R"(,"dur":)";
+        appendMicros(out, event.end > event.begin ? static_cast<double>(event.end - event.begin) / ticksPerMicro : 0.0);
+        if (event.detail[0] != '\0') {
+            out += R"(,"args":{"detail":")";
+            appendJsonEscaped(out, event.detail);
+            out += R"("})";
+        }
+        out += '}';
+    }
+    out += "]}";
+    return out;
+}
+
+std::uint64_t Tracer::now() noexcept {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+TraceSpan::TraceSpan(const char* name) noexcept : m_name(Tracer::instance().sampled() ? name : nullptr) {
+    if (m_name) {
+        m_begin = Tracer::now();
+    }
+}
+
+void TraceSpan::setDetail(std::string_view detail) {
+    if (m_name) {
+        m_detail.assign(detail.substr(0, kDetailBytes - 1));
+    }
+}
+
+void TraceSpan::end() {
+    if (!m_name) {
+        return;
+    }
+    Tracer::instance().record(m_name, m_begin, Tracer::now(), m_detail);
+    m_name = nullptr;
+}
+
+}  // namespace backend
@@ -0,0 +1,52 @@
+// File: AssetStore.cpp
+// Description: Implements embedded asset lookup and the TANK_ASSET_DIR
+//              development override.
+
+#include "frontend/AssetStore.hpp"
+
+#include <cstdlib>
+#include <utility>
+
+namespace frontend {
+
+AssetStoreOptions AssetStoreOptions::fromEnvironment(std::string pagesDir) {
+    AssetStoreOptions options;
+    options.pagesDir = std::move(pagesDir);
+    if (const char* dir = std::getenv("TANK_ASSET_DIR")) {
+        options.overrideDir = dir;
+    }
+    return options;
+}
+
+AssetStore::AssetStore(AssetStoreOptions options) : m_options(std::move(options)) {
+    m_index.reserve(kEmbeddedAssetCount);
+    for (std::size_t i = 0; i < kEmbeddedAssetCount; ++i) {
+        m_index.emplace(kEmbeddedAssets[i].path, &kEmbeddedAssets[i]);
+    }
+}
+
+const EmbeddedAsset* AssetStore::find(std::string_view path) const {
+    if (path == "/") {
+        path = "/index.html";
+    }
+    const auto it = m_index.find(path);
+    return it != m_index.end() ? it->second : nullptr;
+}
+
+std::string AssetStore::overridePath(std::string_view path) const {
+    if (path == "/") {
+        path = "/index.html";
+    }
+    if (path.empty() || path.front() != '/' || path.find("..") != std::string_view::npos) {
+        return {};
+    }
+    std::string fullPath = m_options.overrideDir;
+    if (path.rfind("/static/", 0) != 0) {
+        fullPath += '/';
+        fullPath += m_options.pagesDir;
+    }
+    fullPath.append(path.data(), path.size());
+    return fullPath;
+}
+
+}  // namespace frontend
@@ -0,0 +1,123 @@
+// File: ChunkedJsonWriter.cpp
+// Description: Implements chunked HTTP streaming of JSON documents so large
+//              payloads can be produced row by row with a bounded buffer.
+
+#include "frontend/ChunkedJsonWriter.hpp"
+
+#include <cstdio>
+#include <utility>
+
+namespace frontend {
+
+void appendJsonEscaped(std::string& out, std::string_view value) {
+    for (char ch : value) {
+        switch (ch) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04X",
+                                  static_cast<unsigned int>(static_cast<unsigned char>(ch)));
+                    out += escaped;
+                } else {
+                    out += ch;
+                }
+                break;
+        }
+    }
+}
+
+ChunkedJsonWriter::ChunkedJsonWriter(int clientSocket, const OutputQueueOptions& output, std::size_t chunkSize)
+    : m_output(clientSocket, output), m_chunkSize(chunkSize == 0 ? 1 : chunkSize) {
+    m_buffer.reserve(m_chunkSize + 256);
+}
+
+bool ChunkedJsonWriter::begin(const std::string& statusLine, const std::string& contentType) {
+    std::string header;
+    header.reserve(160);
+    header += statusLine;
+    header += "\r\nContent-Type: ";
+    header += contentType;
+    header += "\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n";
+    return m_output.append(std::move(header));
+}
+
+bool ChunkedJsonWriter::writeRaw(std::string_view text) {
+    if (failed()) {
+        return false;
+    }
+    m_buffer.append(text.data(), text.size());
+    if (m_buffer.size() >= m_chunkSize) {
+        return flushChunk();
+    }
+    return true;
+}
+
+bool ChunkedJsonWriter::writeString(std::string_view value) {
+    if (failed()) {
+        return false;
+    }
+    m_buffer.push_back('"');
+    appendJsonEscaped(m_buffer, value);
+    m_buffer.push_back('"');
+    if (m_buffer.size() >= m_chunkSize) {
+        return flushChunk();
+    }
+    return true;
+}
+
+bool ChunkedJsonWriter::flush() {
+    // flushChunk() skips the write when nothing new is buffered.
+    return flushChunk() && m_output.trySend();
+}
+
+bool ChunkedJsonWriter::finish() {
+    if (!flushChunk()) {
+        return false;
+    }
+    return m_output.append("0\r\n\r\n") && m_output.flush();
+}
+
+bool ChunkedJsonWriter::failed() const noexcept {
+    return m_output.failed();
+}
+
+bool ChunkedJsonWriter::flushChunk() {
+    if (failed()) {
+        return false;
+    }
+    if (m_buffer.empty()) {
+        return true;
+    }
+    char sizeLine[24];
+    const int sizeLen = std::snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", m_buffer.size());
+    std::string chunk;
+    chunk.reserve(static_cast<std::size_t>(sizeLen) + m_buffer.size() + 2);
+    chunk.append(sizeLine, static_cast<std::size_t>(sizeLen));
+    chunk += m_buffer;
+    chunk += "\r\n";
+    m_buffer.clear();
+    return m_output.append(std::move(chunk)) && m_output.trySend();
+}
+
+}  // namespace frontend
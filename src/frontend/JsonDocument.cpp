@@ -0,0 +1,620 @@
+// File: JsonDocument.cpp
+// Description: Implements the two-stage on-demand JSON reader. Stage one
+//              finds structural characters outside strings 64 bytes at a
+//              time (quote/backslash/operator bitmasks, odd-backslash
+//              carry and prefix-XOR string masks); stage two walks that
+//              index lazily for member and element lookups.
+
+#include "frontend/JsonDocument.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace frontend {
+
+namespace {
+
+constexpr std::size_t kBlockSize = 64;
+
+bool isJsonSpace(char ch) {
+    return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+}
+
+bool isStructural(char ch) {
+    return ch == '{' || ch == '}' || ch == '[' || ch == ']' || ch == ':' || ch == ',';
+}
+
+std::uint32_t skipSpace(std::string_view json, std::uint32_t pos) {
+    while (pos < json.size() && isJsonSpace(json[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+void appendUtf8(std::string& out, std::uint32_t code) {
+    if (code <= 0x7F) {
+        out.push_back(static_cast<char>(code));
+    } else if (code <= 0x7FF) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code <= 0xFFFF) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+bool parseHex4(std::string_view text, std::size_t pos, std::uint32_t& code) {
+    if (pos + 4 > text.size()) {
+        return false;
+    }
+    code = 0;
+    for (std::size_t i = pos; i < pos + 4; ++i) {
+        const char ch = text[i];
+        code <<= 4;
+        if (ch >= '0' && ch <= '9') {
+            code |= static_cast<std::uint32_t>(ch - '0');
+        } else if (ch >= 'a' && ch <= 'f') {
+            code |= static_cast<std::uint32_t>(ch - 'a' + 10);
+        } else if (ch >= 'A' && ch <= 'F') {
+            code |= static_cast<std::uint32_t>(ch - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decodes the text between a string's quotes; copies escape-free runs whole.
+bool decodeString(std::string_view body, std::string& out) {
+    out.clear();
+    out.reserve(body.size());
+    std::size_t pos = 0;
+    while (pos < body.size()) {
+        const std::size_t slash = body.find('\\', pos);
+        if (slash == std::string_view::npos) {
+            out.append(body.data() + pos, body.size() - pos);
+            return true;
+        }
+        out.append(body.data() + pos, slash - pos);
+        if (slash + 1 >= body.size()) {
+            return false;
+        }
+        const char esc = body[slash + 1];
+        pos = slash + 2;
+        switch (esc) {
+            case '"':
+            case '\\':
+            case '/':
+                out.push_back(esc);
+                break;
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case 'u': {
+                std::uint32_t code = 0;
+                if (!parseHex4(body, pos, code)) {
+                    return false;
+                }
+                pos += 4;
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    std::uint32_t low = 0;
+                    if (pos + 6 <= body.size() && body[pos] == '\\' && body[pos + 1] == 'u' &&
+                        parseHex4(body, pos + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        pos += 6;
+                    } else {
+                        code = 0xFFFD;  // Unpaired surrogate.
+                    }
+                } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                    code = 0xFFFD;
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+#if defined(__SSE2__)
+
+struct BlockMasks {
+    std::uint64_t quote{0};
+    std::uint64_t backslash{0};
+    std::uint64_t operators{0};  // { } [ ] : ,
+};
+
+BlockMasks classifyBlock(const char* block) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    // '[' | 0x20 == '{' and ']' | 0x20 == '}', so two compares cover all brackets.
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+
+    BlockMasks masks;
+    for (int lane = 0; lane < 4; ++lane) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+        const __m128i folded = _mm_or_si128(bytes, caseBit);
+        const __m128i ops = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, colon), _mm_cmpeq_epi8(bytes, comma)));
+        const int shift = lane * 16;
+        masks.quote |= static_cast<std::uint64_t>(
+                           static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote))))
+                       << shift;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+                               _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, backslash))))
+                           << shift;
+        masks.operators |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(ops)))
+                           << shift;
+    }
+    return masks;
+}
+
+// Bits of characters preceded by an odd-length run of backslashes; runs may
+// continue from the previous block (carry).
+std::uint64_t findEscaped(std::uint64_t backslash, std::uint64_t& prevEndsOddBackslash) {
+    constexpr std::uint64_t kEvenBits = 0x5555555555555555ULL;
+    constexpr std::uint64_t kOddBits = ~kEvenBits;
+    const std::uint64_t startEdges = backslash & ~(backslash << 1);
+    const std::uint64_t evenStartMask = kEvenBits ^ prevEndsOddBackslash;
+    const std::uint64_t evenStarts = startEdges & evenStartMask;
+    const std::uint64_t oddStarts = startEdges & ~evenStartMask;
+    const std::uint64_t evenCarries = backslash + evenStarts;
+    std::uint64_t oddCarries = 0;
+    const bool endsOddBackslash = __builtin_add_overflow(backslash, oddStarts, &oddCarries);
+    oddCarries |= prevEndsOddBackslash;
+    prevEndsOddBackslash = endsOddBackslash ? 1ULL : 0ULL;
+    const std::uint64_t evenCarryEnds = evenCarries & ~backslash;
+    const std::uint64_t oddCarryEnds = oddCarries & ~backslash;
+    return (evenCarryEnds & kOddBits) | (oddCarryEnds & kEvenBits);
+}
+
+// Bit i set when an odd number of bits at or below i are set.
+std::uint64_t prefixXor(std::uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+#endif
+
+}  // namespace
+
+JsonDocument::JsonDocument(std::string_view json, JsonIndexMode mode) : m_json(json) {
+    if (json.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        return;
+    }
+    m_entries.reserve(std::min<std::size_t>(json.size() / 4 + 2, 1024));
+    if (mode == JsonIndexMode::Auto && simdAvailable()) {
+        buildIndexSimd();
+    } else {
+        buildIndexScalar();
+    }
+    if (!m_valid) {
+        return;
+    }
+    m_entries.push_back({static_cast<std::uint32_t>(json.size()), 0});
+    m_valid = matchBrackets();
+    if (!m_valid) {
+        return;
+    }
+
+    // Exactly one value followed only by whitespace.
+    const JsonValue top(this, skipSpace(m_json, 0), 0);
+    if (top.m_begin >= m_json.size() || top.endEntry() != m_entries.size() - 1) {
+        m_valid = false;
+        return;
+    }
+    const std::string_view text = top.raw();
+    m_valid = !text.empty() && top.type() != JsonType::Invalid &&
+              skipSpace(m_json, static_cast<std::uint32_t>(text.data() - m_json.data() + text.size())) ==
+                  m_json.size();
+}
+
+bool JsonDocument::simdAvailable() {
+#if defined(__SSE2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JsonDocument::buildIndexScalar() {
+    bool inString = false;
+    bool escaped = false;
+    for (std::uint32_t i = 0; i < m_json.size(); ++i) {
+        const char ch = m_json[i];
+        // Like the SIMD path, a backslash escapes the next byte even outside
+        // strings (invalid JSON either way), so both modes index identically.
+        if (escaped) {
+            escaped = false;
+        } else if (ch == '\\') {
+            escaped = true;
+        } else if (inString) {
+            if (ch == '"') {
+                inString = false;
+            }
+        } else if (ch == '"') {
+            m_entries.push_back({i, 0});
+            inString = true;
+        } else if (isStructural(ch)) {
+            m_entries.push_back({i, 0});
+        }
+    }
+    m_valid = !inString;
+}
+
+void JsonDocument::buildIndexSimd() {
+#if defined(__SSE2__)
+    std::uint64_t prevEndsOddBackslash = 0;
+    std::uint64_t prevInString = 0;
+    char tail[kBlockSize];
+    for (std::size_t base = 0; base < m_json.size(); base += kBlockSize) {
+        const char* block = m_json.data() + base;
+        const std::size_t remaining = m_json.size() - base;
+        if (remaining < kBlockSize) {
+            // Pad the final partial block with spaces, which are never structural.
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, remaining);
+            block = tail;
+        }
+        BlockMasks masks = classifyBlock(block);
+        const std::uint64_t escaped = findEscaped(masks.backslash, prevEndsOddBackslash);
+        masks.quote &= ~escaped;
+        masks.operators &= ~escaped;
+        const std::uint64_t inString = prefixXor(masks.quote) ^ prevInString;
+        prevInString = static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+
+        // Opening quotes are the quotes still inside the string mask.
+        std::uint64_t structural = (masks.operators & ~inString) | (masks.quote & inString);
+        while (structural != 0) {
+            m_entries.push_back({static_cast<std::uint32_t>(base) +
+                                     static_cast<std::uint32_t>(__builtin_ctzll(structural)),
+                                 0});
+            structural &= structural - 1;
+        }
+    }
+    m_valid = prevInString == 0;
+#else
+    buildIndexScalar();
+#endif
+}
+
+bool JsonDocument::matchBrackets() {
+    // The stack of open brackets is threaded through their own matching
+    // fields (each points at the enclosing opener) until they are closed.
+    constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t open = kNone;
+    for (std::uint32_t i = 0; i + 1 < m_entries.size(); ++i) {
+        const char ch = m_json[m_entries[i].position];
+        if (ch == '{' || ch == '[') {
+            m_entries[i].matching = open;
+            open = i;
+        } else if (ch == '}' || ch == ']') {
+            if (open == kNone || m_json[m_entries[open].position] != (ch == '}' ? '{' : '[')) {
+                return false;
+            }
+            const std::uint32_t enclosing = m_entries[open].matching;
+            m_entries[open].matching = i;
+            open = enclosing;
+        }
+    }
+    return open == kNone;
+}
+
+JsonValue JsonDocument::root() const {
+    if (!m_valid) {
+        return {};
+    }
+    return JsonValue(this, skipSpace(m_json, 0), 0);
+}
+
+JsonValue JsonDocument::valueAfter(std::uint32_t entry) const {
+    const std::uint32_t begin = skipSpace(m_json, entryPosition(entry) + 1);
+    const std::uint32_t next = entry + 1;
+    if (begin >= m_json.size() || next >= m_entries.size()) {
+        return {};
+    }
+    const char ch = m_json[begin];
+    if (ch == '{' || ch == '[' || ch == '"') {
+        return entryPosition(next) == begin ? JsonValue(this, begin, next) : JsonValue{};
+    }
+    // Scalars are not indexed: their entry is the terminator that follows.
+    return entryPosition(next) == begin ? JsonValue{} : JsonValue(this, begin, next);
+}
+
+JsonType JsonValue::type() const {
+    if (!m_doc) {
+        return JsonType::Invalid;
+    }
+    const char ch = m_doc->m_json[m_begin];
+    switch (ch) {
+        case '{':
+            return JsonType::Object;
+        case '[':
+            return JsonType::Array;
+        case '"':
+            return rawStringBody().data() ? JsonType::String : JsonType::Invalid;
+        default:
+            break;
+    }
+    const std::string_view text = raw();
+    if (text == "true" || text == "false") {
+        return JsonType::Boolean;
+    }
+    if (text == "null") {
+        return JsonType::Null;
+    }
+    double number = 0.0;
+    return getDouble(number) ? JsonType::Number : JsonType::Invalid;
+}
+
+std::uint32_t JsonValue::endEntry() const {
+    const char ch = m_doc->m_json[m_begin];
+    if (ch == '{' || ch == '[') {
+        return m_doc->matchingEntry(m_entry) + 1;
+    }
+    if (ch == '"') {
+        return m_entry + 1;
+    }
+    return m_entry;
+}
+
+std::string_view JsonValue::raw() const {
+    if (!m_doc) {
+        return {};
+    }
+    const std::string_view json = m_doc->m_json;
+    const char ch = json[m_begin];
+    std::uint32_t end = 0;
+    if (ch == '{' || ch == '[') {
+        end = m_doc->entryPosition(m_doc->matchingEntry(m_entry)) + 1;
+    } else if (ch == '"') {
+        const std::string_view body = rawStringBody();
+        if (!body.data()) {
+            return {};
+        }
+        end = static_cast<std::uint32_t>(body.data() - json.data() + body.size()) + 1;
+    } else {
+        end = m_doc->entryPosition(m_entry);
+        while (end > m_begin && isJsonSpace(json[end - 1])) {
+            --end;
+        }
+    }
+    return json.substr(m_begin, end - m_begin);
+}
+
+std::string_view JsonValue::rawStringBody() const {
+    // The closing quote is the last non-space character before the next
+    // structural entry, so the string body itself is never rescanned.
+    const std::string_view json = m_doc->m_json;
+    std::uint32_t end = m_doc->entryPosition(m_entry + 1);
+    while (end > m_begin + 1 && isJsonSpace(json[end - 1])) {
+        --end;
+    }
+    if (end <= m_begin + 1 || json[end - 1] != '"') {
+        return {};
+    }
+    return json.substr(m_begin + 1, end - 1 - (m_begin + 1));
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+    if (!m_doc || m_doc->m_json[m_begin] != '{') {
+        return {};
+    }
+    const std::uint32_t close = m_doc->matchingEntry(m_entry);
+    std::uint32_t entry = m_entry + 1;
+    std::string decoded;
+    while (entry < close) {
+        const JsonValue name(m_doc, m_doc->entryPosition(entry), entry);
+        const std::uint32_t colon = entry + 1;
+        if (m_doc->m_json[name.m_begin] != '"' || colon >= close ||
+            m_doc->m_json[m_doc->entryPosition(colon)] != ':') {
+            return {};
+        }
+        const JsonValue value = m_doc->valueAfter(colon);
+        if (!value.m_doc) {
+            return {};
+        }
+        const std::string_view body = name.rawStringBody();
+        const bool matches = body.find('\\') == std::string_view::npos
+                                 ? body == key
+                                 : decodeString(body, decoded) && decoded == key;
+        if (matches) {
+            return value;
+        }
+        const std::uint32_t after = value.endEntry();
+        if (after >= close || m_doc->m_json[m_doc->entryPosition(after)] != ',') {
+            return {};
+        }
+        entry = after + 1;
+    }
+    return {};
+}
+
+JsonValue JsonValue::operator[](std::size_t index) const {
+    if (!m_doc || m_doc->m_json[m_begin] != '[') {
+        return {};
+    }
+    const std::uint32_t close = m_doc->matchingEntry(m_entry);
+    if (skipSpace(m_doc->m_json, m_begin + 1) == m_doc->entryPosition(close)) {
+        return {};
+    }
+    JsonValue element = m_doc->valueAfter(m_entry);
+    for (std::size_t i = 0; element.m_doc; ++i) {
+        if (i == index) {
+            return element;
+        }
+        const std::uint32_t after = element.endEntry();
+        if (after >= close || m_doc->m_json[m_doc->entryPosition(after)] != ',') {
+            return {};
+        }
+        element = m_doc->valueAfter(after);
+    }
+    return {};
+}
+
+std::size_t JsonValue::size() const {
+    if (!m_doc) {
+        return 0;
+    }
+    const char ch = m_doc->m_json[m_begin];
+    if (ch != '{' && ch != '[') {
+        return 0;
+    }
+    const std::uint32_t close = m_doc->matchingEntry(m_entry);
+    if (skipSpace(m_doc->m_json, m_begin + 1) == m_doc->entryPosition(close)) {
+        return 0;
+    }
+    // Separators at this nesting level; nested containers are jumped over.
+    std::size_t count = 1;
+    for (std::uint32_t entry = m_entry + 1; entry < close; ++entry) {
+        const char c = m_doc->m_json[m_doc->entryPosition(entry)];
+        if (c == '{' || c == '[') {
+            entry = m_doc->matchingEntry(entry);
+        } else if (c == ',') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+JsonValue JsonValue::at(std::string_view path) const {
+    JsonValue current = *this;
+    std::size_t pos = 0;
+    while (pos < path.size() && current.m_doc) {
+        if (path[pos] == '.') {
+            ++pos;
+            continue;
+        }
+        if (path[pos] == '[') {
+            const std::size_t close = path.find(']', pos);
+            if (close == std::string_view::npos) {
+                return {};
+            }
+            long long index = 0;
+            const char* first = path.data() + pos + 1;
+            const char* last = path.data() + close;
+            const auto parsed = std::from_chars(first, last, index);
+            if (parsed.ec != std::errc() || parsed.ptr != last) {
+                return {};
+            }
+            if (index < 0) {
+                index += static_cast<long long>(current.size());
+                if (index < 0) {
+                    return {};
+                }
+            }
+            current = current[static_cast<std::size_t>(index)];
+            pos = close + 1;
+            continue;
+        }
+        const std::size_t end = path.find_first_of(".[", pos);
+        const std::size_t length = (end == std::string_view::npos ? path.size() : end) - pos;
+        current = current[path.substr(pos, length)];
+        pos += length;
+    }
+    return current;
+}
+
+bool JsonValue::getString(std::string& out) const {
+    if (!m_doc || m_doc->m_json[m_begin] != '"') {
+        return false;
+    }
+    const std::string_view body = rawStringBody();
+    if (!body.data()) {
+        return false;
+    }
+    std::string decoded;
+    if (!decodeString(body, decoded)) {
+        return false;
+    }
+    out = std::move(decoded);
+    return true;
+}
+
+bool JsonValue::getBool(bool& out) const {
+    const std::string_view text = raw();
+    if (text == "true" || text == "false") {
+        out = text == "true";
+        return true;
+    }
+    return false;
+}
+
+bool JsonValue::getInt64(std::int64_t& out) const {
+    const std::string_view text = raw();
+    if (text.empty() || (text[0] != '-' && (text[0] < '0' || text[0] > '9'))) {
+        return false;
+    }
+    std::int64_t value = 0;
+    const auto parsed = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (parsed.ec != std::errc() || parsed.ptr != text.data() + text.size()) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+bool JsonValue::getDouble(double& out) const {
+    const std::string_view text = raw();
+    if (text.empty() || (text[0] != '-' && (text[0] < '0' || text[0] > '9'))) {
+        return false;
+    }
+    // strtod needs a terminator; numbers are short enough to copy.
+    const std::string copy(text);
+    char* end = nullptr;
+    const double value = std::strtod(copy.c_str(), &end);
+    if (end != copy.c_str() + copy.size()) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+std::string JsonValue::stringOr(std::string fallback) const {
+    std::string value;
+    return getString(value) ? value : fallback;
+}
+
+bool JsonValue::boolOr(bool fallback) const {
+    bool value = fallback;
+    return getBool(value) ? value : fallback;
+}
+
+}  // namespace frontend
@@ -1,44 +1,981 @@
 // File: LayoutManager.cpp
-// Description: Skeleton implementation for managing global user layout
-//              preferences. Actual persistence and policy logic is pending.
+// Description: Implements the persistent layout preference store: an
+//              append-only update log plus a periodically rewritten,
+//              mmap-loaded snapshot, served to readers from immutable
+//              shards published with RCU-style pointer swaps. Themes and
+//              presets are interned and each user is a packed 32-bit record
+//              in a flat open-addressing map keyed by a hashed user id.
 
 #include "frontend/LayoutManager.hpp"
 
+#include "backend/InstrumentedMutex.hpp"
+#include "backend/Logger.hpp"
+#include "frontend/ChunkedJsonWriter.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
 namespace frontend {
 
-LayoutManager::LayoutManager() = default;
+namespace {
+
+constexpr std::size_t kShardBits = 12;
+constexpr std::size_t kShardCount = std::size_t{1} << kShardBits;
+constexpr char kSnapshotMagic[8] = {'T', 'L', 'A', 'Y', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t kSnapshotVersion = 2;
+constexpr std::uint32_t kLegacySnapshotVersion = 1;  // string records, still readable
+constexpr std::size_t kSnapshotHeaderSize = 8 + 4 + 4 + 8;
+constexpr std::size_t kLogRecordHeaderSize = 8;  // payload length + crc32
+constexpr std::uint8_t kFlagCompact = 0x01;
+constexpr std::size_t kSnapshotEntrySize = 8 + 4;    // user key + packed record
+
+// Packed record: bits 0-13 theme id, bits 14-27 preset id, bit 28 compact.
+constexpr std::uint32_t kInternBits = 14;
+constexpr std::uint32_t kMaxInternIds = 1U << kInternBits;
+constexpr std::uint32_t kInternMask = kMaxInternIds - 1;
+constexpr std::uint32_t kPackedCompactBit = 1U << (2 * kInternBits);
+
+std::uint32_t crc32(const char* data, std::size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> tbl {};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t crc = i;
+            for (int j = 0; j < 8; ++j) {
+                crc = (crc & 1U) ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U;
+            }
+            tbl[i] = crc;
+        }
+        return tbl;
+    }();
+
+    std::uint32_t crc = 0xFFFFFFFFU;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = (crc >> 8U) ^ table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFFU];
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+void writeLE16(std::string& buffer, std::uint16_t value) {
+    buffer.push_back(static_cast<char>(value & 0xFF));
+    buffer.push_back(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void writeLE32(std::string& buffer, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        buffer.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+void writeLE64(std::string& buffer, std::uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        buffer.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+std::uint16_t readLE16(const char* p) {
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint16_t>(u[0] | (u[1] << 8));
+}
+
+std::uint32_t readLE32(const char* p) {
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint32_t>(u[0]) | (static_cast<std::uint32_t>(u[1]) << 8) |
+           (static_cast<std::uint32_t>(u[2]) << 16) | (static_cast<std::uint32_t>(u[3]) << 24);
+}
+
+std::uint64_t readLE64(const char* p) {
+    return static_cast<std::uint64_t>(readLE32(p)) |
+           (static_cast<std::uint64_t>(readLE32(p + 4)) << 32);
+}
+
+void writeShortString(std::string& buffer, const std::string& value) {
+    const std::size_t length = std::min<std::size_t>(value.size(), 0xFFFF);
+    writeLE16(buffer, static_cast<std::uint16_t>(length));
+    buffer.append(value, 0, length);
+}
+
+// Record payload shared by the log and the snapshot:
+// u16 userIdLen, userId, u16 themeLen, theme, u16 presetLen, preset, u8 flags.
+void encodeRecord(std::string& buffer,
+                  const std::string& userId,
+                  const UserLayoutPreferences& preferences) {
+    writeShortString(buffer, userId);
+    writeShortString(buffer, preferences.theme);
+    writeShortString(buffer, preferences.layoutPreset);
+    buffer.push_back(static_cast<char>(preferences.compactMode ? kFlagCompact : 0));
+}
+
+// Decodes one record from [cursor, end); returns false if it is truncated.
+bool decodeRecord(const char*& cursor,
+                  const char* end,
+                  std::string& userId,
+                  UserLayoutPreferences& preferences) {
+    auto readString = [&](std::string& out) {
+        if (end - cursor < 2) {
+            return false;
+        }
+        const std::size_t length = readLE16(cursor);
+        cursor += 2;
+        if (static_cast<std::size_t>(end - cursor) < length) {
+            return false;
+        }
+        out.assign(cursor, length);
+        cursor += length;
+        return true;
+    };
+    if (!readString(userId) || !readString(preferences.theme) ||
+        !readString(preferences.layoutPreset) || cursor >= end) {
+        return false;
+    }
+    preferences.compactMode = (static_cast<std::uint8_t>(*cursor++) & kFlagCompact) != 0;
+    return true;
+}
+
+// Keys are persisted in the snapshot, so this must not depend on std::hash.
+// FNV-1a followed by the murmur3 finalizer; 0 marks an empty map slot.
+std::uint64_t userKey(const std::string& userId) {
+    std::uint64_t h = 0xCBF29CE484222325ULL;
+    for (const char c : userId) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001B3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h == 0 ? 1 : h;
+}
+
+// High bits pick the shard; the flat map probes from the low bits.
+std::size_t shardIndex(std::uint64_t key) {
+    return static_cast<std::size_t>(key >> (64 - kShardBits));
+}
+
+std::uint32_t packRecord(std::uint32_t themeId, std::uint32_t presetId, bool compact) {
+    return (themeId & kInternMask) | ((presetId & kInternMask) << kInternBits) |
+           (compact ? kPackedCompactBit : 0U);
+}
+
+std::uint32_t packedTheme(std::uint32_t packed) {
+    return packed & kInternMask;
+}
+
+std::uint32_t packedPreset(std::uint32_t packed) {
+    return (packed >> kInternBits) & kInternMask;
+}
+
+bool packedCompact(std::uint32_t packed) {
+    return (packed & kPackedCompactBit) != 0;
+}
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool syncData(int fd) {
+#if defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+// Open-addressing map from user key to packed record with linear probing.
+// Keys and values are kept in separate arrays so a probe only touches keys.
+class FlatPreferenceMap {
+public:
+    std::size_t size() const { return m_size; }
+
+    void reserve(std::size_t count) {
+        std::size_t capacity = 8;
+        while (capacity * 3 < count * 4) {
+            capacity <<= 1;
+        }
+        if (capacity > m_keys.size()) {
+            rehash(capacity);
+        }
+    }
+
+    const std::uint32_t* find(std::uint64_t key) const {
+        if (m_keys.empty()) {
+            return nullptr;
+        }
+        const std::size_t mask = m_keys.size() - 1;
+        for (std::size_t i = static_cast<std::size_t>(key) & mask;; i = (i + 1) & mask) {
+            if (m_keys[i] == key) {
+                return &m_values[i];
+            }
+            if (m_keys[i] == 0) {
+                return nullptr;
+            }
+        }
+    }
+
+    void set(std::uint64_t key, std::uint32_t value) {
+        // Keep the load factor at or below 3/4.
+        if ((m_size + 1) * 4 > m_keys.size() * 3) {
+            rehash(m_keys.empty() ? 8 : m_keys.size() * 2);
+        }
+        if (insert(key, value)) {
+            ++m_size;
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (std::size_t i = 0; i < m_keys.size(); ++i) {
+            if (m_keys[i] != 0) {
+                fn(m_keys[i], m_values[i]);
+            }
+        }
+    }
+
+private:
+    // Returns true if the key was not present before.
+    bool insert(std::uint64_t key, std::uint32_t value) {
+        const std::size_t mask = m_keys.size() - 1;
+        for (std::size_t i = static_cast<std::size_t>(key) & mask;; i = (i + 1) & mask) {
+            if (m_keys[i] == key) {
+                m_values[i] = value;
+                return false;
+            }
+            if (m_keys[i] == 0) {
+                m_keys[i] = key;
+                m_values[i] = value;
+                return true;
+            }
+        }
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<std::uint64_t> keys(capacity, 0);
+        std::vector<std::uint32_t> values(capacity, 0);
+        keys.swap(m_keys);
+        values.swap(m_values);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != 0) {
+                insert(keys[i], values[i]);
+            }
+        }
+    }
+
+    std::vector<std::uint64_t> m_keys;  // 0 = empty slot
+    std::vector<std::uint32_t> m_values;
+    std::size_t m_size{0};
+};
+
+struct Shard {
+    FlatPreferenceMap entries;
+};
+
+// Append-only string table. Only the committer interns (under commitMutex);
+// readers resolve ids without locking because an id is published in a shard
+// only after its string is in place and the table never shrinks.
+class InternTable {
+public:
+    InternTable() {
+        for (auto& chunk : m_chunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+        intern(std::string());  // id 0 is always the empty string
+    }
+
+    ~InternTable() {
+        for (auto& chunk : m_chunks) {
+            delete chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    InternTable(const InternTable&) = delete;
+    InternTable& operator=(const InternTable&) = delete;
+
+    // Used when replaying stored data, which must load even if it no
+    // longer fits; new updates go through tryIntern() and are rejected.
+    std::uint32_t intern(const std::string& value) {
+        std::uint32_t id = 0;
+        if (!tryIntern(value, id) && !m_overflowLogged) {
+            backend::Logger::instance().log("Layout intern table is full; storing '" + value +
+                                            "' as empty.");
+            m_overflowLogged = true;
+        }
+        return id;
+    }
+
+    // False if value is new and the table is full.
+    bool tryIntern(const std::string& value, std::uint32_t& id) {
+        const auto it = m_ids.find(value);
+        if (it != m_ids.end()) {
+            id = it->second;
+            return true;
+        }
+        id = m_size.load(std::memory_order_relaxed);
+        if (id >= kMaxInternIds) {
+            id = 0;
+            return false;
+        }
+        std::atomic<Chunk*>& slot = m_chunks[id / kChunkSize];
+        Chunk* chunk = slot.load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new Chunk();
+            slot.store(chunk, std::memory_order_release);
+        }
+        chunk->values[id % kChunkSize] = value;
+        m_size.store(id + 1, std::memory_order_release);
+        m_ids.emplace(value, id);
+        return true;
+    }
+
+    const std::string& lookup(std::uint32_t id) const {
+        static const std::string empty;
+        if (id >= m_size.load(std::memory_order_acquire)) {
+            return empty;
+        }
+        return m_chunks[id / kChunkSize].load(std::memory_order_acquire)->values[id % kChunkSize];
+    }
+
+    std::uint32_t size() const { return m_size.load(std::memory_order_acquire); }
+
+private:
+    static constexpr std::size_t kChunkSize = 128;
+    struct Chunk {
+        std::array<std::string, kChunkSize> values;
+    };
+
+    std::array<std::atomic<Chunk*>, kMaxInternIds / kChunkSize> m_chunks;
+    std::atomic<std::uint32_t> m_size{0};
+    std::unordered_map<std::string, std::uint32_t> m_ids;  // writer-only
+    bool m_overflowLogged{false};
+};
 
-LayoutManager::~LayoutManager() = default;
+// One RCU slot per shard. Readers bump `readers` around their access; the
+// writer swaps `current` and frees retired versions once it observes no
+// reader inside the slot (any reader arriving later sees the new version).
+struct alignas(64) ShardSlot {
+    std::atomic<const Shard*> current{nullptr};
+    std::atomic<std::uint32_t> readers{0};
+    std::vector<const Shard*> retired;  // writer-only
+};
+
+class ReadGuard {
+public:
+    explicit ReadGuard(std::atomic<std::uint32_t>& readers) : m_readers(readers) {
+        m_readers.fetch_add(1, std::memory_order_seq_cst);
+    }
+    ~ReadGuard() {
+        m_readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+private:
+    std::atomic<std::uint32_t>& m_readers;
+};
+
+// Filled in by the committer for the applyPreferencesBatch() call that
+// queued the update; an empty error means it was stored.
+struct CommitResult {
+    std::string error;
+};
+
+struct PendingUpdate {
+    std::string userId;
+    UserLayoutPreferences preferences;
+    CommitResult* result;
+};
+
+struct KeyedUpdate {
+    std::size_t shard;
+    std::uint64_t key;
+    std::uint32_t packed;
+    const PendingUpdate* update;
+};
+
+}  // namespace
+
+struct LayoutManager::Impl {
+    explicit Impl(LayoutStoreOptions opts) : options(std::move(opts)) {
+        for (ShardSlot& slot : slots) {
+            slot.current.store(new Shard(), std::memory_order_relaxed);
+        }
+    }
+
+    ~Impl() {
+        for (ShardSlot& slot : slots) {
+            delete slot.current.load(std::memory_order_relaxed);
+            for (const Shard* shard : slot.retired) {
+                delete shard;
+            }
+        }
+        if (logFd >= 0) {
+            ::close(logFd);
+        }
+    }
+
+    std::filesystem::path snapshotPath() const {
+        return std::filesystem::path(options.directory) / "layout.snap";
+    }
+
+    std::filesystem::path logPath() const {
+        return std::filesystem::path(options.directory) / "layout.log";
+    }
+
+    void publish(std::size_t index, const Shard* next) {
+        ShardSlot& slot = slots[index];
+        slot.retired.push_back(slot.current.exchange(next, std::memory_order_seq_cst));
+        if (slot.readers.load(std::memory_order_seq_cst) == 0) {
+            for (const Shard* shard : slot.retired) {
+                delete shard;
+            }
+            slot.retired.clear();
+        }
+    }
+
+    // Both require commitMutex: interning is writer-only.
+    std::uint32_t pack(const UserLayoutPreferences& preferences) {
+        return packRecord(themes.intern(preferences.theme), presets.intern(preferences.layoutPreset),
+                          preferences.compactMode);
+    }
+
+    bool tryPack(const UserLayoutPreferences& preferences, std::uint32_t& packed) {
+        std::uint32_t theme = 0;
+        std::uint32_t preset = 0;
+        if (!themes.tryIntern(preferences.theme, theme) ||
+            !presets.tryIntern(preferences.layoutPreset, preset)) {
+            return false;
+        }
+        packed = packRecord(theme, preset, preferences.compactMode);
+        return true;
+    }
+
+    UserLayoutPreferences unpack(std::uint32_t packed) const {
+        UserLayoutPreferences preferences;
+        preferences.theme = themes.lookup(packedTheme(packed));
+        preferences.layoutPreset = presets.lookup(packedPreset(packed));
+        preferences.compactMode = packedCompact(packed);
+        return preferences;
+    }
+
+    // Stores the batch, publishing only updates that were interned and, with
+    // a log open, appended to it. Failures are reported through each update's
+    // CommitResult; a failed call has none of its updates applied.
+    void commitBatch(const std::vector<PendingUpdate>& batch) {
+        std::lock_guard<backend::InstrumentedMutex> lock(commitMutex);
+        if (batch.empty()) {
+            return;
+        }
+
+        std::vector<KeyedUpdate> byShard;
+        byShard.reserve(batch.size());
+        for (const PendingUpdate& update : batch) {
+            const std::uint64_t key = userKey(update.userId);
+            std::uint32_t packed = 0;
+            if (!tryPack(update.preferences, packed)) {
+                update.result->error = "Layout string table is full; too many distinct themes or presets.";
+                continue;
+            }
+            byShard.push_back(KeyedUpdate{shardIndex(key), key, packed, &update});
+        }
+        // Another update from the same call may have failed after this one packed.
+        byShard.erase(std::remove_if(byShard.begin(), byShard.end(),
+                                     [](const KeyedUpdate& entry) {
+                                         return !entry.update->result->error.empty();
+                                     }),
+                      byShard.end());
+        if (byShard.empty()) {
+            return;
+        }
+
+        if (logFd >= 0 && !appendToLog(byShard)) {
+            for (const KeyedUpdate& entry : byShard) {
+                entry.update->result->error = "Failed to write the layout log.";
+            }
+            return;
+        }
+
+        // Copy-on-write only the shards this batch touches. The sort is stable so
+        // later updates to the same user still win.
+        std::stable_sort(byShard.begin(), byShard.end(),
+                         [](const KeyedUpdate& a, const KeyedUpdate& b) { return a.shard < b.shard; });
+        for (std::size_t begin = 0; begin < byShard.size();) {
+            const std::size_t index = byShard[begin].shard;
+            auto next = std::make_unique<Shard>(*slots[index].current.load(std::memory_order_relaxed));
+            std::size_t end = begin;
+            for (; end < byShard.size() && byShard[end].shard == index; ++end) {
+                next->entries.set(byShard[end].key, byShard[end].packed);
+            }
+            publish(index, next.release());
+            begin = end;
+        }
+    }
+
+    // Appends the updates and syncs if configured. On failure the log is cut
+    // back to where it was, so a partial record cannot hide later ones from
+    // replay. Requires commitMutex.
+    bool appendToLog(const std::vector<KeyedUpdate>& updates) {
+        std::string buffer;
+        std::string payload;
+        for (const KeyedUpdate& entry : updates) {
+            payload.clear();
+            encodeRecord(payload, entry.update->userId, entry.update->preferences);
+            writeLE32(buffer, static_cast<std::uint32_t>(payload.size()));
+            writeLE32(buffer, crc32(payload.data(), payload.size()));
+            buffer += payload;
+        }
+        const off_t logEnd = ::lseek(logFd, 0, SEEK_END);
+        if (logEnd >= 0 && writeAll(logFd, buffer.data(), buffer.size()) &&
+            (!options.syncOnCommit || syncData(logFd))) {
+            recordsSinceSnapshot += updates.size();
+            return true;
+        }
+        backend::Logger::instance().log(std::string("Layout log append failed: ") + std::strerror(errno));
+        if (logEnd >= 0 && ::ftruncate(logFd, logEnd) != 0) {
+            backend::Logger::instance().log("Layout log could not be cut back after a failed append.");
+        }
+        return false;
+    }
+
+    void writeSnapshot() {
+        std::lock_guard<backend::InstrumentedMutex> lock(commitMutex);
+        const std::filesystem::path finalPath = snapshotPath();
+        const std::filesystem::path tmpPath = finalPath.string() + ".tmp";
+        const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            backend::Logger::instance().log("Layout snapshot open failed: " + tmpPath.string());
+            return;
+        }
+
+        std::uint64_t count = 0;
+        for (const ShardSlot& slot : slots) {
+            count += slot.current.load(std::memory_order_relaxed)->entries.size();
+        }
+
+        std::string buffer;
+        buffer.reserve(1 << 20);
+        buffer.append(kSnapshotMagic, sizeof(kSnapshotMagic));
+        writeLE32(buffer, kSnapshotVersion);
+        writeLE32(buffer, 0);
+        writeLE64(buffer, count);
+        for (const InternTable* table : {&themes, &presets}) {
+            const std::uint32_t size = table->size();
+            writeLE16(buffer, static_cast<std::uint16_t>(size));
+            for (std::uint32_t id = 0; id < size; ++id) {
+                writeShortString(buffer, table->lookup(id));
+            }
+        }
+        bool ok = true;
+        for (const ShardSlot& slot : slots) {
+            // Shards are immutable, so the snapshot needs no read guard from the writer.
+            slot.current.load(std::memory_order_relaxed)->entries.forEach(
+                [&](std::uint64_t key, std::uint32_t packed) {
+                    writeLE64(buffer, key);
+                    writeLE32(buffer, packed);
+                    if (buffer.size() >= (1 << 20)) {
+                        ok = ok && writeAll(fd, buffer.data(), buffer.size());
+                        buffer.clear();
+                    }
+                });
+        }
+        ok = ok && writeAll(fd, buffer.data(), buffer.size());
+        ok = ok && ::fsync(fd) == 0;
+        ::close(fd);
+
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(tmpPath, finalPath, ec);
+        }
+        if (!ok || ec) {
+            backend::Logger::instance().log("Layout snapshot write failed: " + finalPath.string());
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+        // Everything in the log is now covered by the snapshot.
+        if (logFd >= 0 && ::ftruncate(logFd, 0) == 0) {
+            recordsSinceSnapshot = 0;
+        }
+        backend::Logger::instance().log("Layout snapshot written with " + std::to_string(count) +
+                                        " users.");
+    }
+
+    // v2 body: theme table, preset table, then fixed-size (key, packed) entries.
+    // File ids are remapped because this process may already have interned strings.
+    std::uint64_t loadPackedEntries(const char*& cursor,
+                                    const char* end,
+                                    std::uint64_t count,
+                                    std::array<std::unique_ptr<Shard>, kShardCount>& building) {
+        std::vector<std::uint32_t> themeIds;
+        std::vector<std::uint32_t> presetIds;
+        std::string value;
+        for (auto [table, ids] : {std::make_pair(&themes, &themeIds),
+                                  std::make_pair(&presets, &presetIds)}) {
+            if (end - cursor < 2) {
+                return 0;
+            }
+            const std::size_t size = readLE16(cursor);
+            cursor += 2;
+            ids->reserve(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                if (end - cursor < 2 || static_cast<std::size_t>(end - cursor - 2) < readLE16(cursor)) {
+                    return 0;
+                }
+                const std::size_t length = readLE16(cursor);
+                value.assign(cursor + 2, length);
+                cursor += 2 + length;
+                ids->push_back(table->intern(value));
+            }
+        }
+
+        auto remap = [](const std::vector<std::uint32_t>& ids, std::uint32_t id) {
+            return id < ids.size() ? ids[id] : 0U;
+        };
+        std::uint64_t loaded = 0;
+        for (; loaded < count && static_cast<std::size_t>(end - cursor) >= kSnapshotEntrySize;
+             ++loaded) {
+            const std::uint64_t key = readLE64(cursor);
+            const std::uint32_t packed = readLE32(cursor + 8);
+            cursor += kSnapshotEntrySize;
+            if (key == 0) {
+                continue;
+            }
+            building[shardIndex(key)]->entries.set(
+                key, packRecord(remap(themeIds, packedTheme(packed)),
+                                remap(presetIds, packedPreset(packed)), packedCompact(packed)));
+        }
+        return loaded;
+    }
+
+    // v1 body: string records, as written before interning.
+    std::uint64_t loadStringEntries(const char*& cursor,
+                                    const char* end,
+                                    std::uint64_t count,
+                                    std::array<std::unique_ptr<Shard>, kShardCount>& building) {
+        std::string userId;
+        UserLayoutPreferences preferences;
+        std::uint64_t loaded = 0;
+        for (; loaded < count && decodeRecord(cursor, end, userId, preferences); ++loaded) {
+            const std::uint64_t key = userKey(userId);
+            building[shardIndex(key)]->entries.set(key, pack(preferences));
+        }
+        return loaded;
+    }
+
+    void load(std::array<std::unique_ptr<Shard>, kShardCount>& building) {
+        std::string userId;
+        UserLayoutPreferences preferences;
+
+        const int snapFd = ::open(snapshotPath().c_str(), O_RDONLY);
+        if (snapFd >= 0) {
+            struct stat info {};
+            if (::fstat(snapFd, &info) == 0 &&
+                static_cast<std::size_t>(info.st_size) >= kSnapshotHeaderSize) {
+                const std::size_t size = static_cast<std::size_t>(info.st_size);
+                void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, snapFd, 0);
+                if (mapped != MAP_FAILED) {
+                    ::madvise(mapped, size, MADV_SEQUENTIAL);
+                    const char* base = static_cast<const char*>(mapped);
+                    const char* end = base + size;
+                    const bool known = std::memcmp(base, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0;
+                    const std::uint32_t version = known ? readLE32(base + 8) : 0;
+                    if (version == kSnapshotVersion || version == kLegacySnapshotVersion) {
+                        const std::uint64_t count = readLE64(base + 16);
+                        for (auto& shard : building) {
+                            shard->entries.reserve(static_cast<std::size_t>(count / kShardCount + 16));
+                        }
+                        const char* cursor = base + kSnapshotHeaderSize;
+                        const std::uint64_t loaded =
+                            version == kSnapshotVersion
+                                ? loadPackedEntries(cursor, end, count, building)
+                                : loadStringEntries(cursor, end, count, building);
+                        if (loaded < count) {
+                            backend::Logger::instance().log("Layout snapshot truncated; loaded " +
+                                                            std::to_string(loaded) + " users.");
+                        }
+                    } else {
+                        backend::Logger::instance().log("Layout snapshot has an unknown format; ignored.");
+                    }
+                    ::munmap(mapped, size);
+                }
+            }
+            ::close(snapFd);
+        }
+
+        logFd = ::open(logPath().c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (logFd < 0) {
+            throw std::runtime_error("Failed to open layout log: " + logPath().string());
+        }
+        struct stat info {};
+        if (::fstat(logFd, &info) != 0 || info.st_size == 0) {
+            return;
+        }
+        const std::size_t size = static_cast<std::size_t>(info.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, logFd, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Failed to map layout log: " + logPath().string());
+        }
+        const char* base = static_cast<const char*>(mapped);
+        const char* cursor = base;
+        const char* end = base + size;
+        std::size_t replayed = 0;
+        while (static_cast<std::size_t>(end - cursor) >= kLogRecordHeaderSize) {
+            const std::uint32_t length = readLE32(cursor);
+            const std::uint32_t crc = readLE32(cursor + 4);
+            const char* payload = cursor + kLogRecordHeaderSize;
+            if (static_cast<std::size_t>(end - payload) < length || crc32(payload, length) != crc) {
+                break;  // Torn tail from an interrupted append.
+            }
+            const char* recordCursor = payload;
+            if (!decodeRecord(recordCursor, payload + length, userId, preferences)) {
+                break;
+            }
+            const std::uint64_t key = userKey(userId);
+            building[shardIndex(key)]->entries.set(key, pack(preferences));
+            cursor = payload + length;
+            ++replayed;
+        }
+        const std::size_t validBytes = static_cast<std::size_t>(cursor - base);
+        ::munmap(mapped, size);
+        if (validBytes < size) {
+            backend::Logger::instance().log("Layout log had a torn tail; truncating " +
+                                            std::to_string(size - validBytes) + " bytes.");
+            if (::ftruncate(logFd, static_cast<off_t>(validBytes)) != 0) {
+                throw std::runtime_error("Failed to truncate layout log.");
+            }
+        }
+        recordsSinceSnapshot = replayed;
+    }
+
+    void writerLoop() {
+        std::unique_lock<backend::InstrumentedMutex> lock(mutex);
+        while (true) {
+            workCv.wait(lock, [this] {
+                return stopping || !pending.empty() || snapshotRequests > snapshotsDone;
+            });
+
+            if (!pending.empty()) {
+                // Everything queued while the previous batch was syncing commits together.
+                std::vector<PendingUpdate> batch;
+                batch.swap(pending);
+                const std::uint64_t through = enqueuedSeq;
+                lock.unlock();
+                commitBatch(batch);
+                lock.lock();
+                committedSeq = through;
+                doneCv.notify_all();
+            }
+
+            if (snapshotRequests > snapshotsDone ||
+                recordsSinceSnapshot >= options.snapshotEveryRecords) {
+                const std::uint64_t target = snapshotRequests;
+                lock.unlock();
+                writeSnapshot();
+                lock.lock();
+                snapshotsDone = target;
+                doneCv.notify_all();
+            }
+
+            if (stopping && pending.empty()) {
+                return;
+            }
+        }
+    }
+
+    LayoutStoreOptions options;
+    std::array<ShardSlot, kShardCount> slots;
+    InternTable themes;
+    InternTable presets;
+
+    backend::InstrumentedMutex commitMutex{"layout.commit"};  // Serializes log appends, shard publication and snapshots.
+    int logFd{-1};
+    std::size_t recordsSinceSnapshot{0};
+
+    backend::InstrumentedMutex mutex{"layout.queue"};  // Guards the pending queue and the fields below.
+    std::condition_variable_any workCv;
+    std::condition_variable_any doneCv;
+    std::vector<PendingUpdate> pending;
+    std::uint64_t enqueuedSeq{0};
+    std::uint64_t committedSeq{0};
+    std::uint64_t snapshotRequests{0};
+    std::uint64_t snapshotsDone{0};
+    bool running{false};
+    bool stopping{false};
+    std::thread writer;
+};
+
+LayoutManager::LayoutManager() : LayoutManager(LayoutStoreOptions{}) {}
+
+LayoutManager::LayoutManager(LayoutStoreOptions options)
+    : m_impl(std::make_unique<Impl>(std::move(options))) {}
+
+LayoutManager::~LayoutManager() {
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+        m_impl->stopping = true;
+    }
+    m_impl->workCv.notify_all();
+    if (m_impl->writer.joinable()) {
+        m_impl->writer.join();
+    }
+}
 
 void LayoutManager::initialize() {
-    // TODO: Load persisted preferences or apply defaults.
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+        if (m_impl->running) {
+            return;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::filesystem::create_directories(m_impl->options.directory);
+
+    std::array<std::unique_ptr<Shard>, kShardCount> building;
+    {
+        std::lock_guard<backend::InstrumentedMutex> commitLock(m_impl->commitMutex);
+        for (std::size_t i = 0; i < kShardCount; ++i) {
+            building[i] = std::make_unique<Shard>(*m_impl->slots[i].current.load());
+        }
+        try {
+            m_impl->load(building);
+        } catch (...) {
+            // Stay memory-only: later updates must not land in a log that
+            // was never replayed.
+            if (m_impl->logFd >= 0) {
+                ::close(m_impl->logFd);
+                m_impl->logFd = -1;
+            }
+            throw;
+        }
+        for (std::size_t i = 0; i < kShardCount; ++i) {
+            m_impl->publish(i, building[i].release());
+        }
+    }
+
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    backend::Logger::instance().log("Layout store loaded " + std::to_string(userCount()) +
+                                    " users from '" + m_impl->options.directory + "' in " +
+                                    std::to_string(elapsedMs) + " ms.");
+
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    m_impl->running = true;
+    m_impl->writer = std::thread(&Impl::writerLoop, m_impl.get());
 }
 
 void LayoutManager::applyPreferences(const std::string& userId,
                                      const UserLayoutPreferences& preferences) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_userPreferences[userId] = preferences;
+    applyPreferencesBatch({{userId, preferences}});
+}
+
+void LayoutManager::applyPreferencesBatch(
+    const std::vector<std::pair<std::string, UserLayoutPreferences>>& updates) {
+    std::unique_lock<backend::InstrumentedMutex> lock(m_impl->mutex);
+    if (!m_impl->running) {
+        // Before initialize(): memory-only, applied inline.
+        lock.unlock();
+        CommitResult result;
+        std::vector<PendingUpdate> batch;
+        batch.reserve(updates.size());
+        for (const auto& [userId, preferences] : updates) {
+            batch.push_back(PendingUpdate{userId, preferences, &result});
+        }
+        m_impl->commitBatch(batch);
+        if (!result.error.empty()) {
+            throw std::runtime_error(result.error);
+        }
+        return;
+    }
+
+    // The writer fills result before committedSeq passes the ticket.
+    CommitResult result;
+    for (const auto& [userId, preferences] : updates) {
+        m_impl->pending.push_back(PendingUpdate{userId, preferences, &result});
+    }
+    const std::uint64_t ticket = ++m_impl->enqueuedSeq;
+    m_impl->workCv.notify_one();
+    m_impl->doneCv.wait(lock, [&] { return m_impl->committedSeq >= ticket; });
+    if (!result.error.empty()) {
+        throw std::runtime_error(result.error);
+    }
 }
 
 UserLayoutPreferences LayoutManager::getPreferences(const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    const auto it = m_userPreferences.find(userId);
-    if (it != m_userPreferences.end()) {
-        return it->second;
+    const std::uint64_t key = userKey(userId);
+    ShardSlot& slot = m_impl->slots[shardIndex(key)];
+    std::uint32_t packed = 0;
+    {
+        ReadGuard guard(slot.readers);
+        const std::uint32_t* found =
+            slot.current.load(std::memory_order_seq_cst)->entries.find(key);
+        if (!found) {
+            return {};
+        }
+        packed = *found;
     }
-    return {};
+    return m_impl->unpack(packed);
 }
 
 std::string LayoutManager::exportPreferences(const std::string& userId) const {
     const UserLayoutPreferences prefs = getPreferences(userId);
-    // TODO: Replace with structured serialization.
-    return "layoutPreset=" + prefs.layoutPreset + ";theme=" + prefs.theme +
-           ";compactMode=" + (prefs.compactMode ? std::string("true") : "false");
+    std::string json = R"({"userId":")";
+    appendJsonEscaped(json, userId);
+    json += R"(","theme":")";
+    appendJsonEscaped(json, prefs.theme);
+    json += R"(","layoutPreset":")";
+    appendJsonEscaped(json, prefs.layoutPreset);
+    json += R"(","compactMode":)";
+    json += prefs.compactMode ? "true" : "false";
+    json += '}';
+    return json;
 }
 
 void LayoutManager::persist() {
-    // TODO: Persist preferences to storage backend.
+    std::unique_lock<backend::InstrumentedMutex> lock(m_impl->mutex);
+    if (!m_impl->running) {
+        lock.unlock();
+        return;  // Nothing is backed by storage before initialize().
+    }
+    const std::uint64_t target = ++m_impl->snapshotRequests;
+    m_impl->workCv.notify_one();
+    m_impl->doneCv.wait(lock, [&] { return m_impl->snapshotsDone >= target; });
 }
 
-}  // namespace frontend
+std::size_t LayoutManager::userCount() const {
+    std::size_t total = 0;
+    for (ShardSlot& slot : m_impl->slots) {
+        ReadGuard guard(slot.readers);
+        total += slot.current.load(std::memory_order_seq_cst)->entries.size();
+    }
+    return total;
+}
 
+}  // namespace frontend
@@ -0,0 +1,242 @@
+// File: OutputQueue.cpp
+// Description: Implements buffered non-blocking response output: gathered
+//              writes for buffers, sendfile for file ranges, partial-write
+//              bookkeeping and the high/low-water producer pause.
+
+#include "frontend/OutputQueue.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <utility>
+
+namespace frontend {
+
+namespace {
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// Buffers gathered into one sendmsg call.
+constexpr std::size_t kMaxIovecs = 16;
+// Read size for the pread fallback where sendfile is unavailable.
+constexpr std::size_t kFileChunkBytes = 64 * 1024;
+
+std::atomic<std::uint64_t> g_bytesSent{0};
+std::atomic<std::uint64_t> g_wouldBlock{0};
+std::atomic<std::uint64_t> g_backpressurePauses{0};
+std::atomic<std::uint64_t> g_sendTimeouts{0};
+
+long long readPositiveEnv(const char* name, long long fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    const long long parsed = std::atoll(value);
+    return parsed > 0 ? parsed : fallback;
+}
+
+}  // namespace
+
+OutputQueueOptions OutputQueueOptions::fromEnvironment() {
+    OutputQueueOptions options;
+    options.highWaterBytes = static_cast<std::size_t>(
+        readPositiveEnv("TANK_OUTPUT_HIGH_WATER", static_cast<long long>(options.highWaterBytes)));
+    options.lowWaterBytes = options.highWaterBytes / 4;
+    options.sendTimeout =
+        std::chrono::milliseconds(readPositiveEnv("TANK_SEND_TIMEOUT_MS", options.sendTimeout.count()));
+    return options;
+}
+
+OutputQueue::OutputQueue(int clientSocket, const OutputQueueOptions& options)
+    : m_socket(clientSocket), m_options(options) {
+    const int flags = ::fcntl(m_socket, F_GETFL, 0);
+    if (flags >= 0 && (flags & O_NONBLOCK) == 0) {
+        ::fcntl(m_socket, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+OutputQueue::~OutputQueue() {
+    while (!m_segments.empty()) {
+        popFront();
+    }
+}
+
+bool OutputQueue::append(std::string data) {
+    if (m_failed) {
+        return false;
+    }
+    if (data.empty()) {
+        return true;
+    }
+    m_pendingBytes += data.size();
+    Segment segment;
+    segment.data = std::move(data);
+    segment.length = segment.data.size();
+    m_segments.push_back(std::move(segment));
+    return afterAppend();
+}
+
+bool OutputQueue::appendStatic(std::string_view data) {
+    if (m_failed) {
+        return false;
+    }
+    if (data.empty()) {
+        return true;
+    }
+    m_pendingBytes += data.size();
+    Segment segment;
+    segment.borrowed = data.data();
+    segment.length = data.size();
+    m_segments.push_back(std::move(segment));
+    return afterAppend();
+}
+
+bool OutputQueue::appendFile(int fd, off_t offset, std::size_t length) {
+    if (m_failed || length == 0) {
+        ::close(fd);
+        return !m_failed;
+    }
+    m_pendingBytes += length;
+    Segment segment;
+    segment.fd = fd;
+    segment.offset = offset;
+    segment.length = length;
+    m_segments.push_back(std::move(segment));
+    return afterAppend();
+}
+
+bool OutputQueue::trySend() {
+    return drain(0, false);
+}
+
+bool OutputQueue::flush() {
+    return drain(0, true);
+}
+
+OutputQueueStats OutputQueue::stats() {
+    OutputQueueStats stats;
+    stats.bytesSent = g_bytesSent.load(std::memory_order_relaxed);
+    stats.wouldBlock = g_wouldBlock.load(std::memory_order_relaxed);
+    stats.backpressurePauses = g_backpressurePauses.load(std::memory_order_relaxed);
+    stats.sendTimeouts = g_sendTimeouts.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool OutputQueue::afterAppend() {
+    if (m_pendingBytes <= m_options.highWaterBytes) {
+        return true;
+    }
+    // The client reads slower than we produce: hold the producer (and with
+    // it whatever feeds it, e.g. an upstream stream or a row cursor).
+    g_backpressurePauses.fetch_add(1, std::memory_order_relaxed);
+    return drain(m_options.lowWaterBytes, true);
+}
+
+bool OutputQueue::drain(std::size_t target, bool wait) {
+    while (!m_failed && m_pendingBytes > target) {
+        const ssize_t written = writeSome();
+        if (written < 0) {
+            m_failed = true;
+            break;
+        }
+        if (written > 0) {
+            continue;
+        }
+        g_wouldBlock.fetch_add(1, std::memory_order_relaxed);
+        if (!wait) {
+            break;
+        }
+        pollfd pfd{};
+        pfd.fd = m_socket;
+        pfd.events = POLLOUT;
+        const int ready = ::poll(&pfd, 1, static_cast<int>(m_options.sendTimeout.count()));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready == 0) {
+            g_sendTimeouts.fetch_add(1, std::memory_order_relaxed);
+            m_failed = true;
+        } else if (ready < 0 || (pfd.revents & (POLLERR | POLLNVAL)) != 0) {
+            m_failed = true;
+        }
+    }
+    return !m_failed;
+}
+
+ssize_t OutputQueue::writeSome() {
+    Segment& front = m_segments.front();
+    ssize_t written = 0;
+    if (front.fd < 0) {
+        iovec iov[kMaxIovecs];
+        std::size_t count = 0;
+        for (const Segment& segment : m_segments) {
+            if (segment.fd >= 0 || count == kMaxIovecs) {
+                break;
+            }
+            iov[count].iov_base = const_cast<char*>(segment.bytes() + segment.sent);
+            iov[count].iov_len = segment.length - segment.sent;
+            ++count;
+        }
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = count;
+        written = ::sendmsg(m_socket, &message, kSendFlags);
+    } else {
+        const std::size_t remaining = front.length - front.sent;
+#if defined(__linux__)
+        off_t offset = front.offset + static_cast<off_t>(front.sent);
+        written = ::sendfile(m_socket, front.fd, &offset, remaining);
+#else
+        char chunk[kFileChunkBytes];
+        const ssize_t got = ::pread(front.fd, chunk, std::min(remaining, sizeof(chunk)),
+                                    front.offset + static_cast<off_t>(front.sent));
+        if (got <= 0) {
+            return -1;  // file shrank underneath us
+        }
+        written = ::send(m_socket, chunk, static_cast<std::size_t>(got), kSendFlags);
+#endif
+        if (written == 0) {
+            return -1;  // file shrank underneath us
+        }
+    }
+    if (written < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+
+    g_bytesSent.fetch_add(static_cast<std::uint64_t>(written), std::memory_order_relaxed);
+    m_pendingBytes -= static_cast<std::size_t>(written);
+    std::size_t consumed = static_cast<std::size_t>(written);
+    while (consumed > 0) {
+        Segment& segment = m_segments.front();
+        const std::size_t step = std::min(consumed, segment.length - segment.sent);
+        segment.sent += step;
+        consumed -= step;
+        if (segment.sent == segment.length) {
+            popFront();
+        }
+    }
+    return written;
+}
+
+void OutputQueue::popFront() {
+    if (m_segments.front().fd >= 0) {
+        ::close(m_segments.front().fd);
+    }
+    m_segments.pop_front();
+}
+
+}  // namespace frontend
@@ -0,0 +1,304 @@
+// File: RequestScheduler.cpp
+// Description: Implements per-class request queues, slot accounting and the
+//              weighted / strict admission policies with aging.
+
+#include "frontend/RequestScheduler.hpp"
+
+#include "backend/Logger.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+namespace frontend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long long readPositiveEnv(const char* name, long long fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    const long long parsed = std::atoll(value);
+    return parsed > 0 ? parsed : fallback;
+}
+
+std::size_t bucketFor(std::uint64_t nanos) {
+    const auto& bounds = backend::LockRegistry::bucketBoundsNanos();
+    std::size_t bucket = 0;
+    while (bucket < bounds.size() && nanos > bounds[bucket]) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Input and State may use the reserved slots; everything below may not.
+bool usesReservedSlots(std::size_t classIndex) {
+    return classIndex <= static_cast<std::size_t>(PriorityClass::State);
+}
+
+struct Waiter {
+    Clock::time_point enqueuedAt{Clock::now()};
+    bool granted{false};
+    std::condition_variable_any cv;
+};
+
+}  // namespace
+
+const char* priorityClassName(PriorityClass priorityClass) {
+    switch (priorityClass) {
+        case PriorityClass::Input:
+            return "input";
+        case PriorityClass::State:
+            return "state";
+        case PriorityClass::Static:
+            return "static";
+        case PriorityClass::Analytics:
+            return "analytics";
+        case PriorityClass::Admin:
+            return "admin";
+    }
+    return "unknown";
+}
+
+RequestSchedulerOptions RequestSchedulerOptions::fromEnvironment() {
+    RequestSchedulerOptions options;
+    const std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    options.workers = static_cast<std::size_t>(
+        readPositiveEnv("TANK_SCHED_WORKERS", static_cast<long long>(std::max(options.workers, cores))));
+    if (const char* reserved = std::getenv("TANK_SCHED_RESERVED")) {
+        options.reservedSlots = static_cast<std::size_t>(std::max(0LL, std::atoll(reserved)));
+    }
+    options.reservedSlots = std::min(options.reservedSlots, options.workers - 1);
+    if (const char* policy = std::getenv("TANK_SCHED_POLICY")) {
+        const std::string value = policy;
+        if (value == "strict") {
+            options.policy = SchedulingPolicy::Strict;
+        } else if (value != "weighted") {
+            backend::Logger::instance().log("Ignoring unknown TANK_SCHED_POLICY '" + value + "'.");
+        }
+    }
+    if (const char* weights = std::getenv("TANK_SCHED_WEIGHTS")) {
+        std::istringstream stream(weights);
+        std::string token;
+        for (std::size_t i = 0; i < kPriorityClassCount && std::getline(stream, token, ','); ++i) {
+            const long long weight = std::atoll(token.c_str());
+            if (weight > 0) {
+                options.weights[i] = static_cast<std::uint32_t>(weight);
+            }
+        }
+    }
+    options.maxWait = std::chrono::milliseconds(readPositiveEnv("TANK_SCHED_MAX_WAIT_MS", options.maxWait.count()));
+    options.maxQueuedPerClass = static_cast<std::size_t>(
+        readPositiveEnv("TANK_SCHED_MAX_QUEUED", static_cast<long long>(options.maxQueuedPerClass)));
+    return options;
+}
+
+struct RequestScheduler::Impl {
+    explicit Impl(RequestSchedulerOptions opts) : options(std::move(opts)) {
+        options.workers = std::max<std::size_t>(1, options.workers);
+        options.reservedSlots = std::min(options.reservedSlots, options.workers - 1);
+    }
+
+    // Caller holds mutex.
+    bool hasFreeSlot(std::size_t classIndex) const {
+        const std::size_t limit =
+            usesReservedSlots(classIndex) ? options.workers : options.workers - options.reservedSlots;
+        return running < limit;
+    }
+
+    // Caller holds mutex. Returns the class to admit next, or
+    // kPriorityClassCount when nothing waiting can run now.
+    std::size_t pickNext(Clock::time_point now) {
+        std::size_t oldest = kPriorityClassCount;
+        for (std::size_t i = 0; i < kPriorityClassCount; ++i) {
+            if (queues[i].empty() || !hasFreeSlot(i)) {
+                continue;
+            }
+            const Clock::time_point head = queues[i].front()->enqueuedAt;
+            if (now - head >= options.maxWait &&
+                (oldest == kPriorityClassCount || head < queues[oldest].front()->enqueuedAt)) {
+                oldest = i;
+            }
+        }
+        if (oldest != kPriorityClassCount) {
+            // Only count it as a promotion if policy order would have
+            // chosen someone else.
+            const std::size_t byPolicy = pickByPolicy(false);
+            if (byPolicy != oldest) {
+                ++classes[oldest].promoted;
+            }
+            return oldest;
+        }
+        return pickByPolicy(true);
+    }
+
+    // Smooth weighted round robin (each eligible class gains its weight,
+    // the richest is admitted and pays the sum), or the first eligible
+    // class under strict priority. commit=false only peeks.
+    std::size_t pickByPolicy(bool commit) {
+        std::size_t best = kPriorityClassCount;
+        if (options.policy == SchedulingPolicy::Strict) {
+            for (std::size_t i = 0; i < kPriorityClassCount; ++i) {
+                if (!queues[i].empty() && hasFreeSlot(i)) {
+                    return i;
+                }
+            }
+            return best;
+        }
+        std::array<std::int64_t, kPriorityClassCount> next = credit;
+        std::int64_t total = 0;
+        for (std::size_t i = 0; i < kPriorityClassCount; ++i) {
+            if (queues[i].empty() || !hasFreeSlot(i)) {
+                continue;
+            }
+            next[i] += options.weights[i];
+            total += options.weights[i];
+            if (best == kPriorityClassCount || next[i] > next[best]) {
+                best = i;
+            }
+        }
+        if (commit && best != kPriorityClassCount) {
+            next[best] -= total;
+            credit = next;
+        }
+        return best;
+    }
+
+    // Caller holds mutex.
+    void admit(std::size_t classIndex, Clock::time_point enqueuedAt, Clock::time_point now) {
+        ++running;
+        ClassCounters& counters = classes[classIndex];
+        ++counters.running;
+        ++counters.admitted;
+        const auto waited =
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - enqueuedAt).count());
+        counters.waitNanos += waited;
+        counters.maxWaitNanos = std::max(counters.maxWaitNanos, waited);
+        ++counters.waitBuckets[bucketFor(waited)];
+    }
+
+    // Caller holds mutex.
+    void dispatch() {
+        const Clock::time_point now = Clock::now();
+        while (running < options.workers) {
+            const std::size_t next = pickNext(now);
+            if (next == kPriorityClassCount) {
+                return;
+            }
+            Waiter* waiter = queues[next].front();
+            queues[next].pop_front();
+            admit(next, waiter->enqueuedAt, now);
+            waiter->granted = true;
+            waiter->cv.notify_one();
+        }
+    }
+
+    struct ClassCounters {
+        std::size_t running{0};
+        std::uint64_t admitted{0};
+        std::uint64_t rejected{0};
+        std::uint64_t promoted{0};
+        std::uint64_t waitNanos{0};
+        std::uint64_t maxWaitNanos{0};
+        backend::LockHistogram waitBuckets{};
+    };
+
+    RequestSchedulerOptions options;
+    mutable backend::InstrumentedMutex mutex{"scheduler"};
+    std::size_t running{0};
+    std::array<std::deque<Waiter*>, kPriorityClassCount> queues;
+    std::array<std::int64_t, kPriorityClassCount> credit{};
+    std::array<ClassCounters, kPriorityClassCount> classes;
+};
+
+RequestScheduler::Ticket::~Ticket() {
+    release();
+}
+
+RequestScheduler::Ticket::Ticket(Ticket&& other) noexcept
+    : m_scheduler(std::exchange(other.m_scheduler, nullptr)), m_class(other.m_class) {}
+
+RequestScheduler::Ticket& RequestScheduler::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_scheduler = std::exchange(other.m_scheduler, nullptr);
+        m_class = other.m_class;
+    }
+    return *this;
+}
+
+void RequestScheduler::Ticket::release() {
+    if (!m_scheduler) {
+        return;
+    }
+    Impl& impl = *m_scheduler->m_impl;
+    std::lock_guard<backend::InstrumentedMutex> lock(impl.mutex);
+    --impl.running;
+    --impl.classes[static_cast<std::size_t>(m_class)].running;
+    impl.dispatch();
+    m_scheduler = nullptr;
+}
+
+RequestScheduler::RequestScheduler(RequestSchedulerOptions options)
+    : m_impl(std::make_unique<Impl>(std::move(options))) {}
+
+RequestScheduler::~RequestScheduler() = default;
+
+RequestScheduler::Ticket RequestScheduler::acquire(PriorityClass priorityClass) {
+    const auto classIndex = static_cast<std::size_t>(priorityClass);
+    Impl& impl = *m_impl;
+    Ticket ticket;
+    Waiter waiter;
+    std::unique_lock<backend::InstrumentedMutex> lock(impl.mutex);
+
+    // Fast path: a free slot and nobody of this class ahead of us. Anyone
+    // still queued is a lower class held back by the reserved slots.
+    if (impl.queues[classIndex].empty() && impl.hasFreeSlot(classIndex)) {
+        impl.admit(classIndex, waiter.enqueuedAt, waiter.enqueuedAt);
+        ticket.m_scheduler = this;
+        ticket.m_class = priorityClass;
+        return ticket;
+    }
+    if (impl.queues[classIndex].size() >= impl.options.maxQueuedPerClass) {
+        ++impl.classes[classIndex].rejected;
+        return ticket;
+    }
+
+    impl.queues[classIndex].push_back(&waiter);
+    impl.dispatch();
+    waiter.cv.wait(lock, [&] { return waiter.granted; });
+    ticket.m_scheduler = this;
+    ticket.m_class = priorityClass;
+    return ticket;
+}
+
+std::vector<PriorityClassStats> RequestScheduler::stats() const {
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    std::vector<PriorityClassStats> result;
+    result.reserve(kPriorityClassCount);
+    for (std::size_t i = 0; i < kPriorityClassCount; ++i) {
+        const Impl::ClassCounters& counters = m_impl->classes[i];
+        PriorityClassStats stats;
+        stats.name = priorityClassName(static_cast<PriorityClass>(i));
+        stats.queued = m_impl->queues[i].size();
+        stats.running = counters.running;
+        stats.admitted = counters.admitted;
+        stats.rejected = counters.rejected;
+        stats.promoted = counters.promoted;
+        stats.waitNanos = counters.waitNanos;
+        stats.maxWaitNanos = counters.maxWaitNanos;
+        stats.waitBuckets = counters.waitBuckets;
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+}  // namespace frontend
@@ -0,0 +1,198 @@
+// File: ResponseCache.cpp
+// Description: Implements the LRU + TTL response cache and its singleflight
+//              table of in-progress loads.
+
+#include "frontend/ResponseCache.hpp"
+
+#include "backend/InstrumentedMutex.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <future>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace frontend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Rough per-entry bookkeeping cost (list node, map node, control block).
+constexpr std::size_t kEntryOverheadBytes = 128;
+constexpr char kKeySeparator = '\x1f';
+
+void appendNormalized(std::string& out, const std::string& value) {
+    bool pendingSpace = false;
+    bool wroteAny = false;
+    for (const char ch : value) {
+        if (std::isspace(static_cast<unsigned char>(ch))) {
+            pendingSpace = wroteAny;
+            continue;
+        }
+        if (pendingSpace) {
+            out.push_back(' ');
+            pendingSpace = false;
+        }
+        out.push_back(ch);
+        wroteAny = true;
+    }
+}
+
+// Keys are full normalized prompts; hashing them with a 64-bit FNV-1a keeps
+// the table cheap while equality still compares the complete key.
+struct KeyHash {
+    std::size_t operator()(const std::string& key) const noexcept {
+        std::uint64_t h = 0xCBF29CE484222325ULL;
+        for (const char c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001B3ULL;
+        }
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+
+struct Entry {
+    std::string key;
+    std::shared_ptr<const CachedResponse> response;
+    Clock::time_point expiresAt;
+    std::size_t bytes{0};
+};
+
+using Flight = std::shared_future<std::shared_ptr<const CachedResponse>>;
+
+}  // namespace
+
+ResponseCacheOptions ResponseCacheOptions::fromEnvironment() {
+    ResponseCacheOptions options;
+    if (const char* bytes = std::getenv("DUCKAI_CACHE_BYTES")) {
+        const long long parsed = std::atoll(bytes);
+        if (parsed >= 0) {
+            options.maxBytes = static_cast<std::size_t>(parsed);
+        }
+    }
+    if (const char* ttl = std::getenv("DUCKAI_CACHE_TTL_SECONDS")) {
+        const long parsed = std::atol(ttl);
+        if (parsed > 0) {
+            options.ttl = std::chrono::seconds(parsed);
+        }
+    }
+    return options;
+}
+
+struct ResponseCache::Impl {
+    explicit Impl(ResponseCacheOptions opts) : options(std::move(opts)) {}
+
+    void erase(std::list<Entry>::iterator it) {
+        bytes -= it->bytes;
+        index.erase(it->key);
+        lru.erase(it);
+    }
+
+    void store(const std::string& key, std::shared_ptr<const CachedResponse> response) {
+        const std::size_t entryBytes = key.size() + response->body.size() + kEntryOverheadBytes;
+        if (entryBytes > options.maxEntryBytes || entryBytes > options.maxBytes) {
+            return;
+        }
+        const auto existing = index.find(key);
+        if (existing != index.end()) {
+            erase(existing->second);
+        }
+        while (!lru.empty() && bytes + entryBytes > options.maxBytes) {
+            erase(std::prev(lru.end()));
+            ++counters.evictions;
+        }
+        lru.push_front(Entry{key, std::move(response), Clock::now() + options.ttl, entryBytes});
+        index.emplace(key, lru.begin());
+        bytes += entryBytes;
+    }
+
+    ResponseCacheOptions options;
+    mutable backend::InstrumentedMutex mutex{"duckai.cache"};
+    std::list<Entry> lru;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator, KeyHash> index;
+    std::unordered_map<std::string, Flight, KeyHash> inflight;
+    std::size_t bytes{0};
+    ResponseCacheStats counters;
+};
+
+ResponseCache::ResponseCache(ResponseCacheOptions options)
+    : m_impl(std::make_unique<Impl>(std::move(options))) {}
+
+ResponseCache::~ResponseCache() = default;
+
+std::string ResponseCache::makeKey(const std::string& model,
+                                   const std::string& systemPrompt,
+                                   const std::string& message) {
+    std::string key;
+    key.reserve(model.size() + systemPrompt.size() + message.size() + 2);
+    appendNormalized(key, model);
+    key.push_back(kKeySeparator);
+    appendNormalized(key, systemPrompt);
+    key.push_back(kKeySeparator);
+    appendNormalized(key, message);
+    return key;
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::getOrLoad(const std::string& key,
+                                                               const Loader& loader) {
+    std::promise<std::shared_ptr<const CachedResponse>> leader;
+    {
+        std::unique_lock<backend::InstrumentedMutex> lock(m_impl->mutex);
+        const auto found = m_impl->index.find(key);
+        if (found != m_impl->index.end()) {
+            if (found->second->expiresAt > Clock::now()) {
+                m_impl->lru.splice(m_impl->lru.begin(), m_impl->lru, found->second);
+                ++m_impl->counters.hits;
+                return found->second->response;
+            }
+            m_impl->erase(found->second);
+            ++m_impl->counters.expirations;
+        }
+
+        const auto flight = m_impl->inflight.find(key);
+        if (flight != m_impl->inflight.end()) {
+            ++m_impl->counters.coalesced;
+            Flight shared = flight->second;
+            lock.unlock();
+            return shared.get();
+        }
+        ++m_impl->counters.misses;
+        m_impl->inflight.emplace(key, leader.get_future().share());
+    }
+
+    std::shared_ptr<const CachedResponse> response;
+    try {
+        response = std::make_shared<const CachedResponse>(loader());
+    } catch (...) {
+        {
+            std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+            m_impl->inflight.erase(key);
+        }
+        leader.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+        m_impl->inflight.erase(key);
+        if (response->statusCode >= 200 && response->statusCode < 300) {
+            m_impl->store(key, response);
+        }
+    }
+    leader.set_value(response);
+    return response;
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    ResponseCacheStats snapshot = m_impl->counters;
+    snapshot.entries = m_impl->lru.size();
+    snapshot.bytes = m_impl->bytes;
+    return snapshot;
+}
+
+}  // namespace frontend
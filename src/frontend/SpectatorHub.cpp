@@ -0,0 +1,380 @@
+// File: SpectatorHub.cpp
+// Description: Implements the spectator broadcast thread: adopting sockets,
+//              encode-once publishing, per-subscriber cursors over shared
+//              frames with latest-wins coalescing, and a poll loop that
+//              writes when sockets drain and drops closed or stuck ones.
+
+#include "frontend/SpectatorHub.hpp"
+
+#include "backend/InstrumentedMutex.hpp"
+#include "backend/Logger.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace frontend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Frame = std::shared_ptr<const std::string>;
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+long long readPositiveEnv(const char* name, long long fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    const long long parsed = std::atoll(value);
+    return parsed > 0 ? parsed : fallback;
+}
+
+const Frame& streamHeaders() {
+    static const Frame headers = std::make_shared<const std::string>(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "X-Accel-Buffering: no\r\n"
+        "Connection: close\r\n\r\n"
+        "retry: 1000\n\n");
+    return headers;
+}
+
+const Frame& keepAliveFrame() {
+    static const Frame frame = std::make_shared<const std::string>(": keep-alive\n\n");
+    return frame;
+}
+
+void setNonBlocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+struct Subscriber {
+    int fd{-1};
+    // Frame being written and how much of it has gone out.
+    Frame sending;
+    std::size_t offset{0};
+    // Newest frame published while sending was still in flight.
+    Frame latest;
+    Clock::time_point lastProgress;
+    bool closed{false};
+};
+
+}  // namespace
+
+SpectatorHubOptions SpectatorHubOptions::fromEnvironment() {
+    SpectatorHubOptions options;
+    options.minInterval = std::chrono::milliseconds(
+        readPositiveEnv("TANK_SPECTATE_MIN_INTERVAL_MS", options.minInterval.count()));
+    options.interval =
+        std::chrono::milliseconds(readPositiveEnv("TANK_SPECTATE_INTERVAL_MS", options.interval.count()));
+    options.interval = std::max(options.interval, options.minInterval);
+    options.maxSubscribers = static_cast<std::size_t>(
+        readPositiveEnv("TANK_SPECTATE_MAX", static_cast<long long>(options.maxSubscribers)));
+    return options;
+}
+
+struct SpectatorHub::Impl {
+    Impl(SpectatorHubOptions opts, Snapshot snap) : options(std::move(opts)), snapshot(std::move(snap)) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            throw std::runtime_error("SpectatorHub: cannot create wake pipe");
+        }
+        wakeRead = fds[0];
+        wakeWrite = fds[1];
+        setNonBlocking(wakeRead);
+        setNonBlocking(wakeWrite);
+        ::fcntl(wakeRead, F_SETFD, FD_CLOEXEC);
+        ::fcntl(wakeWrite, F_SETFD, FD_CLOEXEC);
+        thread = std::thread([this] { run(); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<backend::InstrumentedMutex> lock(mutex);
+            stopping = true;
+        }
+        wake();
+        thread.join();
+        for (const Subscriber& subscriber : subscribers) {
+            ::close(subscriber.fd);
+        }
+        for (int fd : incoming) {
+            ::close(fd);
+        }
+        ::close(wakeRead);
+        ::close(wakeWrite);
+    }
+
+    void wake() {
+        const char byte = 1;
+        // A full pipe already guarantees a wakeup.
+        [[maybe_unused]] const ssize_t written = ::write(wakeWrite, &byte, 1);
+    }
+
+    void run() {
+        std::vector<pollfd> pollFds;
+        bool dirty = false;
+        while (true) {
+            std::vector<int> adopted;
+            {
+                std::lock_guard<backend::InstrumentedMutex> lock(mutex);
+                if (stopping) {
+                    return;
+                }
+                adopted.swap(incoming);
+                dirty = std::exchange(notified, false) || dirty;
+            }
+
+            Clock::time_point now = Clock::now();
+            for (int fd : adopted) {
+                setNonBlocking(fd);
+                Subscriber subscriber;
+                subscriber.fd = fd;
+                subscriber.sending = streamHeaders();
+                subscriber.latest = lastFrame;
+                subscriber.lastProgress = now;
+                subscribers.push_back(std::move(subscriber));
+            }
+
+            if (!subscribers.empty()) {
+                const auto wait = dirty ? options.minInterval : options.interval;
+                if (now - lastPublish >= wait) {
+                    publish(now);
+                    dirty = false;
+                }
+                for (Subscriber& subscriber : subscribers) {
+                    writeSome(subscriber, now);
+                }
+            }
+            reap();
+
+            int timeoutMs = -1;
+            if (!subscribers.empty()) {
+                const auto wait = dirty ? options.minInterval : options.interval;
+                const auto remaining =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(lastPublish + wait - Clock::now());
+                timeoutMs = static_cast<int>(std::max<long long>(1, remaining.count() + 1));
+            }
+
+            pollFds.clear();
+            pollFds.push_back(pollfd{wakeRead, POLLIN, 0});
+            for (const Subscriber& subscriber : subscribers) {
+                const short events = static_cast<short>(POLLIN | (subscriber.sending ? POLLOUT : 0));
+                pollFds.push_back(pollfd{subscriber.fd, events, 0});
+            }
+            const int ready = ::poll(pollFds.data(), static_cast<nfds_t>(pollFds.size()), timeoutMs);
+            if (ready <= 0) {
+                continue;
+            }
+            if (pollFds[0].revents != 0) {
+                char drain[64];
+                while (::read(wakeRead, drain, sizeof(drain)) > 0) {
+                }
+            }
+            now = Clock::now();
+            for (std::size_t i = 1; i < pollFds.size(); ++i) {
+                Subscriber& subscriber = subscribers[i - 1];
+                const short revents = pollFds[i].revents;
+                if (revents & (POLLERR | POLLNVAL)) {
+                    subscriber.closed = true;
+                    continue;
+                }
+                if (revents & (POLLIN | POLLHUP)) {
+                    // Spectators never send anything after the request, so
+                    // readable means closed (or junk we discard).
+                    char scratch[512];
+                    const ssize_t got = ::recv(subscriber.fd, scratch, sizeof(scratch), 0);
+                    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                        subscriber.closed = true;
+                        continue;
+                    }
+                }
+                if (revents & POLLOUT) {
+                    writeSome(subscriber, now);
+                }
+            }
+            reap();
+        }
+    }
+
+    // Serializes once and shares the frame with every subscriber.
+    void publish(Clock::time_point now) {
+        lastPublish = now;
+        std::string payload = snapshot();
+        if (payload == lastPayload) {
+            if (now - lastChange >= options.keepAlive) {
+                lastChange = now;
+                for (Subscriber& subscriber : subscribers) {
+                    // Never displace a real update with a keep-alive.
+                    if (!subscriber.sending && !subscriber.latest) {
+                        subscriber.sending = keepAliveFrame();
+                        subscriber.offset = 0;
+                        subscriber.lastProgress = now;
+                    }
+                }
+            }
+            return;
+        }
+        lastPayload = std::move(payload);
+        lastChange = now;
+        ++sequence;
+        std::string text;
+        text.reserve(lastPayload.size() + 48);
+        text += "id: ";
+        text += std::to_string(sequence);
+        text += "\nevent: state\ndata: ";
+        text += lastPayload;
+        text += "\n\n";
+        lastFrame = std::make_shared<const std::string>(std::move(text));
+        published.fetch_add(1, std::memory_order_relaxed);
+
+        std::uint64_t replaced = 0;
+        for (Subscriber& subscriber : subscribers) {
+            if (!subscriber.sending) {
+                subscriber.sending = lastFrame;
+                subscriber.offset = 0;
+                subscriber.lastProgress = now;
+            } else {
+                replaced += subscriber.latest ? 1 : 0;
+                subscriber.latest = lastFrame;
+            }
+        }
+        coalesced.fetch_add(replaced, std::memory_order_relaxed);
+    }
+
+    void writeSome(Subscriber& subscriber, Clock::time_point now) {
+        while (subscriber.sending && !subscriber.closed) {
+            const std::string& frame = *subscriber.sending;
+            const ssize_t written = ::send(subscriber.fd,
+                                           frame.data() + subscriber.offset,
+                                           frame.size() - subscriber.offset,
+                                           kSendFlags);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+                    now - subscriber.lastProgress < options.sendTimeout) {
+                    return;
+                }
+                subscriber.closed = true;
+                return;
+            }
+            bytesSent.fetch_add(static_cast<std::uint64_t>(written), std::memory_order_relaxed);
+            subscriber.lastProgress = now;
+            subscriber.offset += static_cast<std::size_t>(written);
+            if (subscriber.offset == frame.size()) {
+                subscriber.sending = std::move(subscriber.latest);
+                subscriber.latest.reset();
+                subscriber.offset = 0;
+            }
+        }
+    }
+
+    void reap() {
+        std::size_t removed = 0;
+        for (std::size_t i = 0; i < subscribers.size();) {
+            if (!subscribers[i].closed) {
+                ++i;
+                continue;
+            }
+            ::close(subscribers[i].fd);
+            subscribers[i] = std::move(subscribers.back());
+            subscribers.pop_back();
+            ++removed;
+        }
+        if (removed > 0) {
+            dropped.fetch_add(removed, std::memory_order_relaxed);
+            subscriberCount.fetch_sub(removed, std::memory_order_relaxed);
+        }
+    }
+
+    SpectatorHubOptions options;
+    Snapshot snapshot;
+    std::thread thread;
+    int wakeRead{-1};
+    int wakeWrite{-1};
+
+    backend::InstrumentedMutex mutex{"spectators"};
+    std::vector<int> incoming;  // guarded by mutex
+    bool notified{false};  // guarded by mutex
+    bool stopping{false};  // guarded by mutex
+
+    // Hub thread only.
+    std::vector<Subscriber> subscribers;
+    std::string lastPayload;
+    Frame lastFrame;
+    Clock::time_point lastPublish{};
+    Clock::time_point lastChange{};
+    std::uint64_t sequence{0};
+
+    std::atomic<std::size_t> subscriberCount{0};
+    std::atomic<std::uint64_t> published{0};
+    std::atomic<std::uint64_t> coalesced{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> bytesSent{0};
+};
+
+SpectatorHub::SpectatorHub(SpectatorHubOptions options, Snapshot snapshot)
+    : m_impl(std::make_unique<Impl>(std::move(options), std::move(snapshot))) {}
+
+SpectatorHub::~SpectatorHub() = default;
+
+bool SpectatorHub::subscribe(int clientSocket) {
+    Impl& impl = *m_impl;
+    if (impl.subscriberCount.fetch_add(1, std::memory_order_relaxed) >= impl.options.maxSubscribers) {
+        impl.subscriberCount.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(impl.mutex);
+        impl.incoming.push_back(clientSocket);
+    }
+    impl.wake();
+    return true;
+}
+
+void SpectatorHub::notify() {
+    Impl& impl = *m_impl;
+    if (impl.subscriberCount.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(impl.mutex);
+        impl.notified = true;
+    }
+    impl.wake();
+}
+
+SpectatorHubStats SpectatorHub::stats() const {
+    SpectatorHubStats stats;
+    stats.subscribers = m_impl->subscriberCount.load(std::memory_order_relaxed);
+    stats.published = m_impl->published.load(std::memory_order_relaxed);
+    stats.coalesced = m_impl->coalesced.load(std::memory_order_relaxed);
+    stats.dropped = m_impl->dropped.load(std::memory_order_relaxed);
+    stats.bytesSent = m_impl->bytesSent.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace frontend
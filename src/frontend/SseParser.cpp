@@ -0,0 +1,73 @@
+// File: SseParser.cpp
+// Description: Implements incremental server-sent events parsing following
+//              the WHATWG event-stream line rules (LF, CR or CRLF endings).
+
+#include "frontend/SseParser.hpp"
+
+namespace frontend {
+
+void SseParser::feed(std::string_view bytes, const EventHandler& onEvent) {
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        const char ch = bytes[i];
+        if (m_skipLeadingLf) {
+            m_skipLeadingLf = false;
+            if (ch == '\n') {
+                continue;  // Second half of a CRLF split across feeds.
+            }
+        }
+        if (ch == '\r' || ch == '\n') {
+            processLine(m_line, onEvent);
+            m_line.clear();
+            if (ch == '\r') {
+                if (i + 1 < bytes.size()) {
+                    if (bytes[i + 1] == '\n') {
+                        ++i;
+                    }
+                } else {
+                    m_skipLeadingLf = true;
+                }
+            }
+            continue;
+        }
+        m_line.push_back(ch);
+    }
+}
+
+void SseParser::processLine(std::string_view line, const EventHandler& onEvent) {
+    if (line.empty()) {
+        // Blank line dispatches the event; events without data are dropped.
+        if (m_hasData) {
+            onEvent(m_pending);
+        }
+        m_pending = SseEvent{};
+        m_hasData = false;
+        return;
+    }
+    if (line.front() == ':') {
+        return;  // Comment / keep-alive.
+    }
+
+    std::string_view field = line;
+    std::string_view value;
+    const std::size_t colon = line.find(':');
+    if (colon != std::string_view::npos) {
+        field = line.substr(0, colon);
+        value = line.substr(colon + 1);
+        if (!value.empty() && value.front() == ' ') {
+            value.remove_prefix(1);
+        }
+    }
+
+    if (field == "data") {
+        if (m_hasData) {
+            m_pending.data.push_back('\n');
+        }
+        m_pending.data.append(value.data(), value.size());
+        m_hasData = true;
+    } else if (field == "event") {
+        m_pending.event.assign(value.data(), value.size());
+    }
+    // "id" and "retry" are not needed for upstream pass-through.
+}
+
+}  // namespace frontend
@@ -0,0 +1,392 @@
+// File: TrafficCapture.cpp
+// Description: Implements the binary request capture writer, body and
+//              header redaction, and the reader used by the replay tool.
+
+#include "frontend/TrafficCapture.hpp"
+
+#include "backend/InstrumentedMutex.hpp"
+#include "backend/Logger.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace frontend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr char kMagic[8] = {'T', 'A', 'N', 'K', 'C', 'A', 'P', '1'};
+constexpr std::uint8_t kFlagBodyRedacted = 0x01;
+// Upper bound for any single length field when reading, to reject garbage.
+constexpr std::uint64_t kMaxFieldBytes = 64ULL * 1024 * 1024;
+
+long long readPositiveEnv(const char* name, long long fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    const long long parsed = std::atoll(value);
+    return parsed > 0 ? parsed : fallback;
+}
+
+bool equalsIgnoreCase(const std::string& a, const char* b) {
+    const std::size_t length = std::strlen(b);
+    if (a.size() != length) {
+        return false;
+    }
+    for (std::size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Credentials never reach the capture file, whatever the route.
+bool isSensitiveHeader(const std::string& name) {
+    static const char* const kSensitive[] = {"authorization", "proxy-authorization", "cookie", "x-api-key"};
+    for (const char* sensitive : kSensitive) {
+        if (equalsIgnoreCase(name, sensitive)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void appendVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    appendVarint(out, value.size());
+    out += value;
+}
+
+void appendFixed64(std::string& out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// Cursor over one record payload; throws on overrun.
+class PayloadReader {
+public:
+    explicit PayloadReader(const std::string& data) : m_data(data) {}
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_pos >= m_data.size()) {
+                throw std::runtime_error("Capture record truncated.");
+            }
+            const auto byte = static_cast<std::uint8_t>(m_data[m_pos++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Capture varint too long.");
+    }
+
+    std::uint8_t byte() {
+        if (m_pos >= m_data.size()) {
+            throw std::runtime_error("Capture record truncated.");
+        }
+        return static_cast<std::uint8_t>(m_data[m_pos++]);
+    }
+
+    std::string string() {
+        const std::uint64_t length = varint();
+        if (length > m_data.size() - m_pos) {
+            throw std::runtime_error("Capture string overruns its record.");
+        }
+        std::string value = m_data.substr(m_pos, static_cast<std::size_t>(length));
+        m_pos += static_cast<std::size_t>(length);
+        return value;
+    }
+
+private:
+    const std::string& m_data;
+    std::size_t m_pos{0};
+};
+
+// Reads a varint from the stream; false on a clean or torn end of file.
+bool readStreamVarint(std::ifstream& in, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int ch = in.get();
+        if (ch == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(ch & 0x7F) << shift;
+        if ((ch & 0x80) == 0) {
+            return true;
+        }
+    }
+    throw std::runtime_error("Capture record length is malformed.");
+}
+
+void maskRun(std::string& body, std::size_t begin, std::size_t end) {
+    std::fill(body.begin() + static_cast<std::ptrdiff_t>(begin), body.begin() + static_cast<std::ptrdiff_t>(end),
+              'x');
+}
+
+std::string redactJson(std::string body) {
+    std::size_t pos = 0;
+    while (pos < body.size()) {
+        if (body[pos] != '"') {
+            ++pos;
+            continue;
+        }
+        std::size_t end = pos + 1;
+        while (end < body.size() && body[end] != '"') {
+            end += body[end] == '\\' ? 2 : 1;
+        }
+        end = std::min(end, body.size());
+        std::size_t next = end + 1;
+        while (next < body.size() && std::isspace(static_cast<unsigned char>(body[next]))) {
+            ++next;
+        }
+        // Keys stay readable so the shape of the request survives.
+        const bool isKey = next < body.size() && body[next] == ':';
+        if (!isKey) {
+            maskRun(body, pos + 1, end);
+        }
+        pos = end + 1;
+    }
+    return body;
+}
+
+std::string redactForm(std::string body) {
+    std::size_t pos = 0;
+    while (pos < body.size()) {
+        std::size_t end = body.find('&', pos);
+        if (end == std::string::npos) {
+            end = body.size();
+        }
+        const std::size_t eq = body.find('=', pos);
+        if (eq != std::string::npos && eq < end) {
+            maskRun(body, eq + 1, end);
+        }
+        pos = end + 1;
+    }
+    return body;
+}
+
+}  // namespace
+
+TrafficCaptureOptions TrafficCaptureOptions::fromEnvironment() {
+    TrafficCaptureOptions options;
+    if (const char* path = std::getenv("TANK_CAPTURE_FILE")) {
+        options.path = path;
+    }
+    if (const char* routes = std::getenv("TANK_CAPTURE_REDACT")) {
+        options.redactRoutes.clear();
+        const std::string list = routes;
+        std::size_t pos = 0;
+        while (pos <= list.size()) {
+            std::size_t comma = list.find(',', pos);
+            if (comma == std::string::npos) {
+                comma = list.size();
+            }
+            const std::string route = list.substr(pos, comma - pos);
+            if (!route.empty() && route != "none") {
+                options.redactRoutes.push_back(route);
+            }
+            pos = comma + 1;
+        }
+    }
+    options.maxBytes =
+        static_cast<std::uint64_t>(readPositiveEnv("TANK_CAPTURE_MAX_BYTES", static_cast<long long>(options.maxBytes)));
+    return options;
+}
+
+struct TrafficCapture::Impl {
+    explicit Impl(TrafficCaptureOptions opts) : options(std::move(opts)) {}
+
+    ~Impl() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool shouldRedact(const std::string& routingPath) const {
+        return std::find(options.redactRoutes.begin(), options.redactRoutes.end(), routingPath) !=
+               options.redactRoutes.end();
+    }
+
+    TrafficCaptureOptions options;
+    Clock::time_point startedAt{Clock::now()};
+    backend::InstrumentedMutex mutex{"capture"};
+    // Each record is one unbuffered write(2), so a killed server loses
+    // nothing that was already handled. -1 when disabled or stopped.
+    int fd{-1};
+    // Mirrors fd >= 0 so record() can skip all encoding without the mutex.
+    std::atomic<bool> active{false};
+    std::uint64_t bytesWritten{0};
+
+    bool writeAll(const std::string& data) {
+        std::size_t done = 0;
+        while (done < data.size()) {
+            const ssize_t wrote = ::write(fd, data.data() + done, data.size() - done);
+            if (wrote < 0 && errno == EINTR) {
+                continue;
+            }
+            if (wrote <= 0) {
+                return false;
+            }
+            done += static_cast<std::size_t>(wrote);
+        }
+        bytesWritten += data.size();
+        return true;
+    }
+
+    void stop(const std::string& reason) {
+        active.store(false, std::memory_order_relaxed);
+        ::close(fd);
+        fd = -1;
+        backend::Logger::instance().log("Traffic capture stopped at " + std::to_string(bytesWritten) +
+                                        " bytes (" + reason + ").");
+    }
+};
+
+TrafficCapture::TrafficCapture(TrafficCaptureOptions options)
+    : m_impl(std::make_unique<Impl>(std::move(options))) {
+    if (m_impl->options.path.empty()) {
+        return;
+    }
+    m_impl->fd = ::open(m_impl->options.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_impl->fd < 0) {
+        backend::Logger::instance().log("Traffic capture disabled: cannot open '" + m_impl->options.path + "'.");
+        return;
+    }
+    m_impl->active.store(true, std::memory_order_relaxed);
+    std::string header(kMagic, sizeof(kMagic));
+    const auto startedAtMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count();
+    appendFixed64(header, static_cast<std::uint64_t>(startedAtMicros));
+    if (!m_impl->writeAll(header)) {
+        m_impl->stop(std::strerror(errno));
+        return;
+    }
+    backend::Logger::instance().log("Capturing HTTP traffic to '" + m_impl->options.path + "'.");
+}
+
+TrafficCapture::~TrafficCapture() = default;
+
+bool TrafficCapture::enabled() const noexcept {
+    return m_impl->active.load(std::memory_order_relaxed);
+}
+
+void TrafficCapture::record(const std::string& method,
+                            const std::string& path,
+                            const std::string& routingPath,
+                            const std::vector<std::pair<std::string, std::string>>& headers,
+                            const std::string& body) {
+    if (!enabled()) {
+        return;
+    }
+    const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_impl->startedAt);
+    const bool redact = !body.empty() && m_impl->shouldRedact(routingPath);
+
+    std::string payload;
+    payload.reserve(64 + path.size() + body.size() + headers.size() * 32);
+    appendVarint(payload, static_cast<std::uint64_t>(offset.count()));
+    payload.push_back(static_cast<char>(redact ? kFlagBodyRedacted : 0));
+    appendString(payload, method);
+    appendString(payload, path);
+    appendVarint(payload, headers.size());
+    for (const auto& [name, value] : headers) {
+        appendString(payload, name);
+        appendString(payload, isSensitiveHeader(name) ? std::string("redacted") : value);
+    }
+    appendString(payload, redact ? redactBody(body) : body);
+
+    std::string framed;
+    framed.reserve(payload.size() + 10);
+    appendVarint(framed, payload.size());
+    framed += payload;
+
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    if (m_impl->fd < 0) {
+        return;
+    }
+    if (m_impl->bytesWritten + framed.size() > m_impl->options.maxBytes) {
+        m_impl->stop("TANK_CAPTURE_MAX_BYTES");
+        return;
+    }
+    if (!m_impl->writeAll(framed)) {
+        m_impl->stop(std::strerror(errno));
+    }
+}
+
+std::string TrafficCapture::redactBody(const std::string& body) {
+    const std::size_t first = body.find_first_not_of(" \t\r\n");
+    if (first != std::string::npos && (body[first] == '{' || body[first] == '[')) {
+        return redactJson(body);
+    }
+    return redactForm(body);
+}
+
+TrafficCaptureReader::TrafficCaptureReader(const std::string& path) : m_in(path, std::ios::binary) {
+    if (!m_in) {
+        throw std::runtime_error("Cannot open capture file '" + path + "'.");
+    }
+    char header[16];
+    if (!m_in.read(header, sizeof(header)) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("'" + path + "' is not a traffic capture.");
+    }
+    for (int i = 7; i >= 0; --i) {
+        m_startedAtMicros = (m_startedAtMicros << 8) | static_cast<std::uint8_t>(header[8 + i]);
+    }
+}
+
+bool TrafficCaptureReader::next(CapturedRequest& request) {
+    std::uint64_t length = 0;
+    if (!readStreamVarint(m_in, length)) {
+        return false;
+    }
+    if (length > kMaxFieldBytes) {
+        throw std::runtime_error("Capture record length out of range.");
+    }
+    std::string payload(static_cast<std::size_t>(length), '\0');
+    if (!m_in.read(&payload[0], static_cast<std::streamsize>(length))) {
+        return false;  // torn final record
+    }
+
+    PayloadReader reader(payload);
+    request = CapturedRequest{};
+    request.offsetMicros = reader.varint();
+    request.bodyRedacted = (reader.byte() & kFlagBodyRedacted) != 0;
+    request.method = reader.string();
+    request.path = reader.string();
+    const std::uint64_t headerCount = reader.varint();
+    if (headerCount > length) {
+        throw std::runtime_error("Capture header count out of range.");
+    }
+    for (std::uint64_t i = 0; i < headerCount; ++i) {
+        std::string name = reader.string();
+        std::string value = reader.string();
+        request.headers.emplace_back(std::move(name), std::move(value));
+    }
+    request.body = reader.string();
+    return true;
+}
+
+}  // namespace frontend
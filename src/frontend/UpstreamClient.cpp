@@ -0,0 +1,336 @@
+// File: UpstreamClient.cpp
+// Description: Implements the pooled upstream client. One event-loop thread
+//              owns the curl multi handle; submitters hand it transfers
+//              through a mutex-guarded queue and curl_multi_wakeup.
+
+#include "frontend/UpstreamClient.hpp"
+
+#include "backend/AllocationTracker.hpp"
+#include "backend/InstrumentedMutex.hpp"
+#include "backend/Logger.hpp"
+
+#include <curl/curl.h>
+
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+namespace frontend {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 1000;
+
+void ensureCurlInitialized() {
+    static std::once_flag flag;
+    std::call_once(flag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+std::size_t curlWriteToString(char* ptr, std::size_t size, std::size_t nmemb, void* userdata) {
+    if (!userdata) {
+        return 0;
+    }
+    auto* out = static_cast<std::string*>(userdata);
+    out->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+std::size_t readPositiveEnv(const char* name, std::size_t fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    const long parsed = std::atol(value);
+    return parsed > 0 ? static_cast<std::size_t>(parsed) : fallback;
+}
+
+struct Transfer {
+    UpstreamRequest request;
+    std::promise<UpstreamResponse> promise;
+    UpstreamResponse response;
+    CURL* easy{nullptr};
+    curl_slist* headers{nullptr};
+};
+
+std::size_t deliverChunk(char* ptr, std::size_t size, std::size_t nmemb, void* userdata) {
+    auto* transfer = static_cast<Transfer*>(userdata);
+    long status = 0;
+    curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &status);
+    // Returning a short count makes curl fail the transfer with CURLE_WRITE_ERROR.
+    return transfer->request.onData(status, ptr, size * nmemb) ? size * nmemb : 0;
+}
+
+int checkCancelled(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    const auto* transfer = static_cast<const Transfer*>(userdata);
+    return transfer->request.cancelled->load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+}  // namespace
+
+UpstreamClientOptions UpstreamClientOptions::fromEnvironment() {
+    UpstreamClientOptions options;
+    options.maxConcurrent = readPositiveEnv("DUCKAI_MAX_CONCURRENT", options.maxConcurrent);
+    options.maxQueued = readPositiveEnv("DUCKAI_MAX_QUEUED", options.maxQueued);
+    if (options.maxCachedConnections < options.maxConcurrent) {
+        options.maxCachedConnections = options.maxConcurrent;
+    }
+    return options;
+}
+
+struct UpstreamClient::Impl {
+    explicit Impl(UpstreamClientOptions opts) : options(std::move(opts)) {
+        ensureCurlInitialized();
+        multi = curl_multi_init();
+        if (!multi) {
+            throw std::runtime_error("Failed to initialize curl multi handle.");
+        }
+        curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(options.maxCachedConnections));
+        // HTTP/2 upstreams multiplex onto one connection instead of opening more.
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+
+    ~Impl() {
+        for (CURL* easy : idleHandles) {
+            curl_easy_cleanup(easy);
+        }
+        curl_multi_cleanup(multi);
+    }
+
+    // Easy handles are recycled so their per-handle state (TLS session ids,
+    // HTTP/2 settings) survives; the connection and DNS caches live in the multi.
+    CURL* acquireHandle() {
+        if (!idleHandles.empty()) {
+            CURL* easy = idleHandles.back();
+            idleHandles.pop_back();
+            curl_easy_reset(easy);
+            return easy;
+        }
+        return curl_easy_init();
+    }
+
+    void releaseHandle(CURL* easy) {
+        if (idleHandles.size() < options.maxConcurrent) {
+            idleHandles.push_back(easy);
+        } else {
+            curl_easy_cleanup(easy);
+        }
+    }
+
+    void start(Transfer* transfer) {
+        transfer->easy = acquireHandle();
+        if (!transfer->easy) {
+            transfer->response.error = "Failed to initialize curl.";
+            complete(transfer);
+            return;
+        }
+        for (const std::string& header : transfer->request.headers) {
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        }
+
+        CURL* easy = transfer->easy;
+        curl_easy_setopt(easy, CURLOPT_URL, transfer->request.url.c_str());
+        curl_easy_setopt(easy, CURLOPT_POST, 1L);
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, transfer->request.body.c_str());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->request.body.size()));
+        if (transfer->request.onData) {
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, deliverChunk);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer);
+        } else {
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, curlWriteToString);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->response.body);
+        }
+        if (transfer->request.cancelled) {
+            curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, checkCancelled);
+            curl_easy_setopt(easy, CURLOPT_XFERINFODATA, transfer);
+            curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+        }
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, transfer->request.timeoutMs);
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, options.connectTimeoutMs);
+        curl_easy_setopt(easy, CURLOPT_DNS_CACHE_TIMEOUT, options.dnsCacheTimeoutSeconds);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer);
+
+        if (curl_multi_add_handle(multi, easy) != CURLM_OK) {
+            transfer->response.error = "Failed to schedule upstream request.";
+            complete(transfer);
+            return;
+        }
+        active.insert(transfer);
+    }
+
+    void finish(CURLMsg* message) {
+        // The message is invalidated by curl_multi_remove_handle; copy it first.
+        const CURLcode result = message->data.result;
+        Transfer* transfer = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+        curl_multi_remove_handle(multi, message->easy_handle);
+        active.erase(transfer);
+
+        if (result == CURLE_OK) {
+            transfer->response.ok = true;
+            curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &transfer->response.status);
+            long newConnections = 0;
+            curl_easy_getinfo(transfer->easy, CURLINFO_NUM_CONNECTS, &newConnections);
+            transfer->response.reusedConnection = newConnections == 0;
+        } else {
+            transfer->response.error = curl_easy_strerror(result);
+            transfer->response.timedOut = result == CURLE_OPERATION_TIMEDOUT;
+        }
+        complete(transfer);
+    }
+
+    // Hands the result to the waiting caller and frees the transfer.
+    void complete(Transfer* transfer) {
+        if (transfer->easy) {
+            releaseHandle(transfer->easy);
+            transfer->easy = nullptr;
+        }
+        if (transfer->headers) {
+            curl_slist_free_all(transfer->headers);
+            transfer->headers = nullptr;
+        }
+        {
+            std::lock_guard<backend::InstrumentedMutex> lock(mutex);
+            if (transfer->response.ok) {
+                ++counters.completed;
+                if (transfer->response.reusedConnection) {
+                    ++counters.reusedConnections;
+                }
+            } else {
+                ++counters.failed;
+            }
+            counters.active = active.size();
+        }
+        transfer->promise.set_value(std::move(transfer->response));
+        delete transfer;
+    }
+
+    void eventLoop() {
+        backend::AllocationScope allocationScope("upstream_client");
+        while (true) {
+            std::vector<Transfer*> starting;
+            {
+                std::lock_guard<backend::InstrumentedMutex> lock(mutex);
+                if (stopping) {
+                    break;
+                }
+                while (!queue.empty() && active.size() + starting.size() < options.maxConcurrent) {
+                    starting.push_back(queue.front());
+                    queue.pop_front();
+                }
+                counters.queued = queue.size();
+            }
+            for (Transfer* transfer : starting) {
+                start(transfer);
+            }
+            {
+                std::lock_guard<backend::InstrumentedMutex> lock(mutex);
+                counters.active = active.size();
+            }
+
+            int running = 0;
+            curl_multi_perform(multi, &running);
+            int remaining = 0;
+            bool freedSlot = false;
+            while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+                if (message->msg == CURLMSG_DONE) {
+                    finish(message);
+                    freedSlot = true;
+                }
+            }
+            // A finished transfer frees a slot for queued work, so go around
+            // again instead of sleeping until the next socket event.
+            if (!freedSlot) {
+                curl_multi_poll(multi, nullptr, 0, kPollTimeoutMs, nullptr);
+            }
+        }
+
+        // Shutdown: fail everything still in flight or waiting.
+        for (Transfer* transfer : std::vector<Transfer*>(active.begin(), active.end())) {
+            curl_multi_remove_handle(multi, transfer->easy);
+            active.erase(transfer);
+            transfer->response.error = "Upstream client shutting down.";
+            complete(transfer);
+        }
+        std::deque<Transfer*> leftover;
+        {
+            std::lock_guard<backend::InstrumentedMutex> lock(mutex);
+            leftover.swap(queue);
+        }
+        for (Transfer* transfer : leftover) {
+            transfer->response.error = "Upstream client shutting down.";
+            complete(transfer);
+        }
+    }
+
+    UpstreamClientOptions options;
+    CURLM* multi{nullptr};
+    std::vector<CURL*> idleHandles;          // loop thread only
+    std::unordered_set<Transfer*> active;    // loop thread only
+
+    mutable backend::InstrumentedMutex mutex{"upstream.client"};  // Guards the queue, stopping and counters.
+    std::deque<Transfer*> queue;
+    bool stopping{false};
+    UpstreamClientStats counters;
+    std::thread loop;
+};
+
+UpstreamClient::UpstreamClient(UpstreamClientOptions options)
+    : m_impl(std::make_unique<Impl>(std::move(options))) {
+    m_impl->loop = std::thread(&Impl::eventLoop, m_impl.get());
+}
+
+UpstreamClient::~UpstreamClient() {
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+        m_impl->stopping = true;
+    }
+    curl_multi_wakeup(m_impl->multi);
+    if (m_impl->loop.joinable()) {
+        m_impl->loop.join();
+    }
+}
+
+std::future<UpstreamResponse> UpstreamClient::submit(UpstreamRequest request) {
+    auto* transfer = new Transfer();
+    transfer->request = std::move(request);
+    std::future<UpstreamResponse> result = transfer->promise.get_future();
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+        if (m_impl->stopping || m_impl->queue.size() >= m_impl->options.maxQueued) {
+            ++m_impl->counters.rejected;
+            transfer->response.rejected = true;
+            transfer->response.error = m_impl->stopping ? "Upstream client shutting down."
+                                                        : "Too many pending upstream requests.";
+        } else {
+            m_impl->queue.push_back(transfer);
+            m_impl->counters.queued = m_impl->queue.size();
+            transfer = nullptr;
+        }
+    }
+    if (transfer) {
+        backend::Logger::instance().log("Upstream request rejected: " + transfer->response.error);
+        transfer->promise.set_value(std::move(transfer->response));
+        delete transfer;
+        return result;
+    }
+    curl_multi_wakeup(m_impl->multi);
+    return result;
+}
+
+void UpstreamClient::wake() {
+    curl_multi_wakeup(m_impl->multi);
+}
+
+UpstreamClientStats UpstreamClient::stats() const {
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    return m_impl->counters;
+}
+
+}  // namespace frontend
@@ -0,0 +1,281 @@
+// File: UpstreamGuard.cpp
+// Description: Implements the Duck AI bulkhead, circuit breaker state
+//              machine and percentile-based adaptive timeouts.
+
+#include "frontend/UpstreamGuard.hpp"
+
+#include "backend/InstrumentedMutex.hpp"
+#include "backend/Logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace frontend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Recent successful latencies kept per kind for the p99 estimate.
+constexpr std::size_t kLatencyWindow = 256;
+
+long long readPositiveEnv(const char* name, long long fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    const long long parsed = std::atoll(value);
+    return parsed > 0 ? parsed : fallback;
+}
+
+const char* stateName(CircuitState state) {
+    switch (state) {
+        case CircuitState::Closed:
+            return "closed";
+        case CircuitState::Open:
+            return "open";
+        case CircuitState::HalfOpen:
+            return "half-open";
+    }
+    return "unknown";
+}
+
+// Fixed-size ring of the most recent samples; the timeout derived from it is
+// recomputed on every insert so readers only load an atomic.
+class LatencyWindow {
+public:
+    void add(std::uint32_t ms) {
+        m_samples[m_next] = ms;
+        m_next = (m_next + 1) % kLatencyWindow;
+        m_count = std::min(m_count + 1, kLatencyWindow);
+    }
+
+    std::size_t size() const { return m_count; }
+
+    std::uint32_t p99() const {
+        std::vector<std::uint32_t> sorted(m_samples.begin(), m_samples.begin() + m_count);
+        const std::size_t index = std::min(m_count - 1, m_count * 99 / 100);
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+
+private:
+    std::array<std::uint32_t, kLatencyWindow> m_samples{};
+    std::size_t m_next{0};
+    std::size_t m_count{0};
+};
+
+}  // namespace
+
+UpstreamGuardOptions UpstreamGuardOptions::fromEnvironment() {
+    UpstreamGuardOptions options;
+    options.maxInFlight = static_cast<std::size_t>(
+        readPositiveEnv("DUCKAI_BULKHEAD", static_cast<long long>(options.maxInFlight)));
+    options.failureThreshold = static_cast<std::uint32_t>(
+        readPositiveEnv("DUCKAI_BREAKER_FAILURES", options.failureThreshold));
+    options.openDuration = std::chrono::milliseconds(
+        readPositiveEnv("DUCKAI_BREAKER_OPEN_MS", options.openDuration.count()));
+    options.minTimeout = std::chrono::milliseconds(
+        readPositiveEnv("DUCKAI_TIMEOUT_MIN_MS", options.minTimeout.count()));
+    options.maxTimeout = std::chrono::milliseconds(
+        readPositiveEnv("DUCKAI_TIMEOUT_MAX_MS", options.maxTimeout.count()));
+    if (options.minTimeout > options.maxTimeout) {
+        options.minTimeout = options.maxTimeout;
+    }
+    return options;
+}
+
+struct UpstreamGuard::Impl {
+    explicit Impl(UpstreamGuardOptions opts) : options(std::move(opts)) {
+        for (auto& timeout : timeouts) {
+            timeout.store(static_cast<long>(options.maxTimeout.count()));
+        }
+    }
+
+    // Caller holds mutex.
+    void transition(CircuitState next) {
+        if (state == next) {
+            return;
+        }
+        std::string message = std::string("Duck AI circuit ") + stateName(state) + " -> " + stateName(next);
+        if (next == CircuitState::Open) {
+            message += " after " + std::to_string(consecutiveFailures) + " consecutive failures";
+        }
+        backend::Logger::instance().log(message + ".");
+        state = next;
+        if (next == CircuitState::Open) {
+            openedAt = Clock::now();
+            ++counters.circuitOpened;
+        }
+    }
+
+    void recordLatency(UpstreamLatencyKind kind, std::chrono::milliseconds latency) {
+        LatencyWindow& window = windows[static_cast<std::size_t>(kind)];
+        window.add(static_cast<std::uint32_t>(std::min<long long>(latency.count(), UINT32_MAX)));
+        if (window.size() < options.minSamples) {
+            return;
+        }
+        const double scaled = std::ceil(static_cast<double>(window.p99()) * options.timeoutMultiplier);
+        const long clamped = static_cast<long>(
+            std::clamp(scaled, static_cast<double>(options.minTimeout.count()),
+                       static_cast<double>(options.maxTimeout.count())));
+        timeouts[static_cast<std::size_t>(kind)].store(clamped, std::memory_order_relaxed);
+    }
+
+    UpstreamGuardOptions options;
+    mutable backend::InstrumentedMutex mutex{"duckai.guard"};
+    CircuitState state{CircuitState::Closed};
+    Clock::time_point openedAt{};
+    std::uint32_t consecutiveFailures{0};
+    bool probeInFlight{false};
+    std::size_t inFlight{0};
+    std::array<LatencyWindow, 2> windows;
+    std::array<std::atomic<long>, 2> timeouts;
+    UpstreamGuardStats counters;
+};
+
+UpstreamGuard::Permit::~Permit() {
+    release();
+}
+
+UpstreamGuard::Permit::Permit(Permit&& other) noexcept
+    : m_guard(std::exchange(other.m_guard, nullptr)), m_probe(other.m_probe) {}
+
+UpstreamGuard::Permit& UpstreamGuard::Permit::operator=(Permit&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_guard = std::exchange(other.m_guard, nullptr);
+        m_probe = other.m_probe;
+    }
+    return *this;
+}
+
+void UpstreamGuard::Permit::release() {
+    if (!m_guard) {
+        return;
+    }
+    Impl& impl = *m_guard->m_impl;
+    std::lock_guard<backend::InstrumentedMutex> lock(impl.mutex);
+    --impl.inFlight;
+    if (m_probe) {
+        // Abandoned probe: let the next caller probe instead.
+        impl.probeInFlight = false;
+    }
+    m_guard = nullptr;
+}
+
+void UpstreamGuard::Permit::succeed(UpstreamLatencyKind kind, std::chrono::milliseconds latency) {
+    if (!m_guard) {
+        return;
+    }
+    Impl& impl = *m_guard->m_impl;
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(impl.mutex);
+        ++impl.counters.successes;
+        impl.recordLatency(kind, latency);
+        impl.consecutiveFailures = 0;
+        if (m_probe) {
+            impl.probeInFlight = false;
+            m_probe = false;
+            impl.transition(CircuitState::Closed);
+        }
+    }
+    release();
+}
+
+void UpstreamGuard::Permit::fail(bool timedOut) {
+    if (!m_guard) {
+        return;
+    }
+    Impl& impl = *m_guard->m_impl;
+    {
+        std::lock_guard<backend::InstrumentedMutex> lock(impl.mutex);
+        ++impl.counters.failures;
+        if (timedOut) {
+            ++impl.counters.timeouts;
+        }
+        ++impl.consecutiveFailures;
+        if (m_probe) {
+            impl.probeInFlight = false;
+            m_probe = false;
+            impl.transition(CircuitState::Open);
+            // Reopening restarts the cool-down even if the state did not change.
+            impl.openedAt = Clock::now();
+        } else if (impl.state == CircuitState::Closed &&
+                   impl.consecutiveFailures >= impl.options.failureThreshold) {
+            impl.transition(CircuitState::Open);
+        }
+    }
+    release();
+}
+
+UpstreamGuard::UpstreamGuard(UpstreamGuardOptions options)
+    : m_impl(std::make_unique<Impl>(std::move(options))) {}
+
+UpstreamGuard::~UpstreamGuard() = default;
+
+UpstreamGuard::Admission UpstreamGuard::tryAcquire(Permit& permit) {
+    permit = Permit{};
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    bool probe = false;
+    if (m_impl->state == CircuitState::Open) {
+        if (Clock::now() - m_impl->openedAt < m_impl->options.openDuration) {
+            ++m_impl->counters.rejectedOpen;
+            return Admission::CircuitOpen;
+        }
+        m_impl->transition(CircuitState::HalfOpen);
+    }
+    if (m_impl->state == CircuitState::HalfOpen) {
+        // Exactly one request tests the upstream; everyone else still fails fast.
+        if (m_impl->probeInFlight) {
+            ++m_impl->counters.rejectedOpen;
+            return Admission::CircuitOpen;
+        }
+        probe = true;
+    }
+    if (m_impl->inFlight >= m_impl->options.maxInFlight) {
+        ++m_impl->counters.rejectedBulkhead;
+        return Admission::BulkheadFull;
+    }
+    ++m_impl->inFlight;
+    ++m_impl->counters.admitted;
+    if (probe) {
+        m_impl->probeInFlight = true;
+    }
+    permit.m_guard = this;
+    permit.m_probe = probe;
+    return Admission::Admitted;
+}
+
+long UpstreamGuard::timeoutMs(UpstreamLatencyKind kind) const {
+    return m_impl->timeouts[static_cast<std::size_t>(kind)].load(std::memory_order_relaxed);
+}
+
+long UpstreamGuard::retryAfterSeconds() const {
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    if (m_impl->state == CircuitState::Closed) {
+        return 0;
+    }
+    const auto remaining = m_impl->options.openDuration - (Clock::now() - m_impl->openedAt);
+    const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count();
+    return ms <= 0 ? 1 : static_cast<long>((ms + 999) / 1000);
+}
+
+UpstreamGuardStats UpstreamGuard::stats() const {
+    std::lock_guard<backend::InstrumentedMutex> lock(m_impl->mutex);
+    UpstreamGuardStats snapshot = m_impl->counters;
+    snapshot.state = m_impl->state;
+    snapshot.inFlight = m_impl->inFlight;
+    snapshot.completionTimeoutMs = timeoutMs(UpstreamLatencyKind::Completion);
+    snapshot.firstByteTimeoutMs = timeoutMs(UpstreamLatencyKind::FirstByte);
+    return snapshot;
+}
+
+}  // namespace frontend
@@ -4,25 +4,34 @@
 
 #include "frontend/WebServer.hpp"
 
+#include "backend/AllocationTracker.hpp"
 #include "backend/Logger.hpp"
+#include "backend/Tracing.hpp"
+#include "frontend/ChunkedJsonWriter.hpp"
+#include "frontend/JsonDocument.hpp"
 #include "frontend/LayoutManager.hpp"
+#include "frontend/SseParser.hpp"
 
 #include <arpa/inet.h>
-#include <curl/curl.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <csignal>
 #include <ctime>
 #include <cstdlib>
 #include <cctype>
+#include <cerrno>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
-#include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <numeric>
@@ -37,6 +46,33 @@ namespace frontend {
 
 namespace {
 constexpr std::size_t kReadBufferSize = 4096;
+constexpr long kDuckAiStreamTimeoutMs = 120000;
+constexpr std::size_t kMaxPendingStreamBytes = 1 << 20;
+constexpr std::size_t kMaxUpstreamErrorBytes = 4096;  // of a non-2xx body relayed to the client
+constexpr std::size_t kMaxLayoutFieldBytes = 256;
+constexpr std::chrono::milliseconds kEngineTickerMaxSleep{1000};
+constexpr std::chrono::milliseconds kStreamPollInterval{100};
+constexpr const char* kDefaultDuckAiUpstreamUrl =
+    "https://dashscope.aliyuncs.com/compatible-mode/v1/chat/completions";
+
+// The buffered /duckai answer; cached entries hold this whether the
+// completion was fetched buffered or streamed.
+std::string duckAiAnswerBody(const std::string& content) {
+    std::string answer = R"({"success":true,"choices":[{"message":{"role":"assistant","content":")";
+    appendJsonEscaped(answer, content);
+    answer += "\"}}]}";
+    return answer;
+}
+
+// DUCKAI_UPSTREAM_URL points /duckai at any OpenAI-compatible endpoint,
+// e.g. tools/mock_llm_server for local benchmarking.
+const std::string& duckAiUpstreamUrl() {
+    static const std::string url = [] {
+        const char* configured = std::getenv("DUCKAI_UPSTREAM_URL");
+        return std::string(configured && *configured ? configured : kDefaultDuckAiUpstreamUrl);
+    }();
+    return url;
+}
 
 std::string normalizePath(std::string path) {
     const std::size_t queryPos = path.find('?');
@@ -49,161 +85,177 @@ std::string normalizePath(std::string path) {
     return path;
 }
 
-void ensureCurlInitialized() {
-    static std::once_flag flag;
-    std::call_once(flag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+std::string extractQueryString(const std::string& path) {
+    const std::size_t queryPos = path.find('?');
+    if (queryPos == std::string::npos) {
+        return {};
+    }
+    return path.substr(queryPos + 1);
 }
 
-std::string extractJsonStringField(const std::string& body, const std::string& key) {
-    const std::string quotedKey = "\"" + key + "\"";
-    std::size_t pos = body.find(quotedKey);
-    if (pos == std::string::npos) {
-        return "";
+// Case-insensitive header name comparison; expected is lower case.
+bool headerNameIs(const std::string& name, const char* expected) {
+    const std::size_t length = std::strlen(expected);
+    if (name.size() != length) {
+        return false;
     }
-    pos = body.find(':', pos + quotedKey.size());
-    if (pos == std::string::npos) {
-        return "";
+    for (std::size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(name[i])) != expected[i]) {
+            return false;
+        }
     }
-    ++pos;
-    while (pos < body.size() && std::isspace(static_cast<unsigned char>(body[pos]))) {
-        ++pos;
+    return true;
+}
+
+const char* directionName(backend::MoveDirection direction) {
+    switch (direction) {
+        case backend::MoveDirection::Up:
+            return "up";
+        case backend::MoveDirection::Down:
+            return "down";
+        case backend::MoveDirection::Left:
+            return "left";
+        case backend::MoveDirection::Right:
+            return "right";
+        case backend::MoveDirection::None:
+            break;
     }
-    if (pos >= body.size() || body[pos] != '"') {
-        return "";
+    return "none";
+}
+
+// "tank":{...} with the cell position plus the exact movement state in
+// sub-cell units, which clients replay their unacknowledged moves from.
+void appendTankJson(std::ostream& oss, const backend::Tank& tank) {
+    const backend::Position position = tank.getPosition();
+    oss << R"("tank":{"x":)" << position.x << R"(,"y":)" << position.y
+        << R"(,"unitsX":)" << tank.getUnitsX() << R"(,"unitsY":)" << tank.getUnitsY()
+        << R"(,"momentum":)" << tank.getMomentumUnits()
+        << R"(,"direction":")" << directionName(tank.getLastDirection()) << R"(")"
+        << R"(,"step":)" << tank.getMoveStep() << "}";
+}
+
+std::uint64_t parseSequence(const std::string& value) {
+    if (value.empty() || value.size() > 19 ||
+        !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return 0;
     }
-    ++pos;
-    std::string output;
-    output.reserve(256);
-    while (pos < body.size()) {
-        const char ch = body[pos++];
-        if (ch == '"') {
-            return output;
-        }
-        if (ch != '\\') {
-            output.push_back(ch);
-            continue;
-        }
-        if (pos >= body.size()) {
-            return "";
-        }
-        const char esc = body[pos++];
-        switch (esc) {
-            case '"':
-            case '\\':
-            case '/':
-                output.push_back(esc);
-                break;
-            case 'b':
-                output.push_back('\b');
-                break;
-            case 'f':
-                output.push_back('\f');
-                break;
-            case 'n':
-                output.push_back('\n');
-                break;
-            case 'r':
-                output.push_back('\r');
-                break;
-            case 't':
-                output.push_back('\t');
-                break;
-            case 'u': {
-                // Best-effort: keep the escape sequence if parsing fails.
-                if (pos + 4 > body.size()) {
-                    output += "\\u";
-                    break;
-                }
-                const std::string hex = body.substr(pos, 4);
-                pos += 4;
-                char* endPtr = nullptr;
-                const long code = std::strtol(hex.c_str(), &endPtr, 16);
-                if (!endPtr || *endPtr != '\0' || code < 0 || code > 0x10FFFF) {
-                    output += "\\u" + hex;
-                    break;
-                }
-                const uint32_t u = static_cast<uint32_t>(code);
-                if (u <= 0x7F) {
-                    output.push_back(static_cast<char>(u));
-                } else if (u <= 0x7FF) {
-                    output.push_back(static_cast<char>(0xC0 | (u >> 6)));
-                    output.push_back(static_cast<char>(0x80 | (u & 0x3F)));
-                } else if (u <= 0xFFFF) {
-                    output.push_back(static_cast<char>(0xE0 | (u >> 12)));
-                    output.push_back(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
-                    output.push_back(static_cast<char>(0x80 | (u & 0x3F)));
-                } else {
-                    output.push_back(static_cast<char>(0xF0 | (u >> 18)));
-                    output.push_back(static_cast<char>(0x80 | ((u >> 12) & 0x3F)));
-                    output.push_back(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
-                    output.push_back(static_cast<char>(0x80 | (u & 0x3F)));
-                }
-                break;
-            }
-            default:
-                output.push_back(esc);
-                break;
+    return std::stoull(value);
+}
+
+// Allocation scope per route; tags must be string literals.
+const char* allocationScopeFor(const std::string& routingPath) {
+    static const char* const kRoutes[] = {
+        "/",
+        "/index.html",
+        "/state",
+        "/metrics",
+        "/spectate",
+        "/move",
+        "/reset",
+        "/rain",
+        "/pause",
+        "/duckai",
+        "/codestats",
+        "/codestats/export",
+        "/attendance/roster",
+        "/attendance/previous",
+        "/attendance/next",
+        "/attendance/mark",
+        "/layout",
+        "/print_longest_function",
+        "/print_shortest_function",
+    };
+    for (const char* route : kRoutes) {
+        if (routingPath == route) {
+            return route;
         }
     }
-    return "";
+    if (routingPath.rfind("/static/", 0) == 0) {
+        return "/static";
+    }
+    if (routingPath.rfind("/debug/", 0) == 0) {
+        return "/debug";
+    }
+    return "/unknown";
 }
 
-std::size_t curlWriteToString(char* ptr, std::size_t size, std::size_t nmemb, void* userdata) {
-    if (!userdata) {
-        return 0;
+// Scheduling class per route. Routes that mostly wait rather than compute
+// (/duckai behind its own bulkhead, the timed /debug/ captures, /spectate
+// handing its socket to the hub) return false and run without taking a
+// worker slot.
+bool priorityClassFor(const std::string& routingPath, frontend::PriorityClass& priorityClass) {
+    using frontend::PriorityClass;
+    if (routingPath == "/duckai" || routingPath == "/debug/profile" || routingPath == "/debug/trace" ||
+        routingPath == "/spectate") {
+        return false;
     }
-    auto* out = static_cast<std::string*>(userdata);
-    out->append(ptr, size * nmemb);
-    return size * nmemb;
+    if (routingPath == "/move" || routingPath == "/reset" || routingPath == "/rain" || routingPath == "/pause") {
+        priorityClass = PriorityClass::Input;
+    } else if (routingPath == "/state" || routingPath == "/layout" || routingPath.rfind("/attendance/", 0) == 0) {
+        priorityClass = routingPath == "/attendance/roster" ? PriorityClass::Analytics : PriorityClass::State;
+    } else if (routingPath == "/" || routingPath == "/index.html" || routingPath.rfind("/static/", 0) == 0) {
+        priorityClass = PriorityClass::Static;
+    } else if (routingPath == "/metrics" || routingPath.rfind("/debug/", 0) == 0) {
+        priorityClass = PriorityClass::Admin;
+    } else {
+        // /codestats, /codestats/export, /print_*_function and unknown paths.
+        priorityClass = PriorityClass::Analytics;
+    }
+    return true;
 }
 
-struct CurlSlistDeleter {
-    void operator()(curl_slist* list) const noexcept {
-        if (list) {
-            curl_slist_free_all(list);
-        }
+const char* statusText(int statusCode) {
+    switch (statusCode) {
+        case 200:
+            return "OK";
+        case 202:
+            return "Accepted";
+        case 400:
+            return "Bad Request";
+        case 403:
+            return "Forbidden";
+        case 404:
+            return "Not Found";
+        case 500:
+            return "Internal Server Error";
+        case 501:
+            return "Not Implemented";
+        case 502:
+            return "Bad Gateway";
+        case 503:
+            return "Service Unavailable";
+        case 504:
+            return "Gateway Timeout";
+        default:
+            return "Error";
     }
-};
+}
+
+// Statuses that say the upstream itself is unhealthy, as opposed to a bad request.
+bool isUpstreamFailureStatus(long status) {
+    return status == 0 || status == 429 || status >= 500;
+}
+
+// True once the peer has closed its end; a pending request byte is not a close.
+bool clientDisconnected(int clientSocket) {
+    pollfd pfd {};
+    pfd.fd = clientSocket;
+    pfd.events = POLLIN;
+    if (::poll(&pfd, 1, 0) <= 0) {
+        return false;
+    }
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        return true;
+    }
+    char probe = 0;
+    const ssize_t peeked = ::recv(clientSocket, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    return peeked == 0 || (peeked < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
 
 std::string jsonEscape(const std::string& input) {
     std::string output;
     output.reserve(input.size());
-    for (char ch : input) {
-        switch (ch) {
-            case '\\':
-                output += "\\\\";
-                break;
-            case '"':
-                output += "\\\"";
-                break;
-            case '\b':
-                output += "\\b";
-                break;
-            case '\f':
-                output += "\\f";
-                break;
-            case '\n':
-                output += "\\n";
-                break;
-            case '\r':
-                output += "\\r";
-                break;
-            case '\t':
-                output += "\\t";
-                break;
-            default:
-                if (static_cast<unsigned char>(ch) < 0x20) {
-                    std::ostringstream oss;
-                    oss << "\\u"
-                        << std::hex << std::uppercase << std::setfill('0') << std::setw(4)
-                        << static_cast<int>(static_cast<unsigned char>(ch));
-                    output += oss.str();
-                } else {
-                    output += ch;
-                }
-                break;
-        }
-    }
+    appendJsonEscaped(output, input);
     return output;
 }
 
@@ -486,16 +538,48 @@ WebServer::WebServer(backend::GameEngine& engine,
     : m_engine(engine),
       m_layoutManager(layoutManager),
       m_codeStatsFacade(),
-      m_attendanceRepo(backend::createAttendanceRepository()),
       m_attendanceCursor(0),
       m_staticDir(std::move(staticDir)),
-      m_port(port) {}
+      m_port(port),
+      m_upstreamClient(UpstreamClientOptions::fromEnvironment()),
+      m_duckAiCache(ResponseCacheOptions::fromEnvironment()),
+      m_duckAiGuard(UpstreamGuardOptions::fromEnvironment()),
+      m_capture(TrafficCaptureOptions::fromEnvironment()),
+      m_scheduler(RequestSchedulerOptions::fromEnvironment()),
+      m_outputOptions(OutputQueueOptions::fromEnvironment()),
+      m_assets(AssetStoreOptions::fromEnvironment(m_staticDir)),
+      m_spectators(SpectatorHubOptions::fromEnvironment(), [this] { return buildStateJson(std::string()); }) {
+    m_attendanceInitThread = std::thread(&WebServer::initializeAttendanceRepository, this);
+    m_engineTicker = std::thread(&WebServer::runEngineTicker, this);
+}
+
+WebServer::~WebServer() {
+    {
+        const auto guard = lockEngine();
+        m_engineTickerStopping = true;
+    }
+    m_engineTickerCv.notify_all();
+    if (m_engineTicker.joinable()) {
+        m_engineTicker.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_attendanceInitMutex);
+        m_stopping = true;
+    }
+    m_attendanceInitCv.notify_all();
+    if (m_attendanceInitThread.joinable()) {
+        m_attendanceInitThread.join();
+    }
+}
 
 int WebServer::port() const noexcept {
     return m_port;
 }
 
 void WebServer::run() {
+    // A client closing mid-response must fail the write, not kill the process.
+    std::signal(SIGPIPE, SIG_IGN);
+
     int serverSocket = -1;
     int attempt = 0;
     int currentPort = m_port;
@@ -554,11 +638,19 @@ void WebServer::run() {
             continue;
         }
 
-        std::thread(&WebServer::handleClient, this, clientSocket).detach();
+        const std::uint64_t acceptedTicks = backend::Tracer::now();
+        std::thread(&WebServer::handleClient, this, clientSocket, acceptedTicks).detach();
     }
 }
 
-void WebServer::handleClient(int clientSocket) {
+void WebServer::handleClient(int clientSocket, std::uint64_t acceptedTicks) {
+    backend::Tracer& tracer = backend::Tracer::instance();
+    tracer.beginRequest();
+    tracer.record("accept", acceptedTicks, backend::Tracer::now());
+    backend::AllocationScope connectionScope("http");
+    backend::TraceSpan requestSpan("request");
+    backend::TraceSpan readSpan("read headers");
+
     std::string request;
     request.reserve(1024);
 
@@ -579,6 +671,9 @@ void WebServer::handleClient(int clientSocket) {
         }
     }
 
+    readSpan.end();
+    backend::TraceSpan parseSpan("parse");
+
     const std::size_t headerEnd = request.find("\r\n\r\n");
     std::string headerPart = request.substr(0, headerEnd + 4);
     std::string body = request.substr(headerEnd + 4);
@@ -604,9 +699,19 @@ void WebServer::handleClient(int clientSocket) {
         return;
     }
     const std::string routingPath = normalizePath(path);
+    backend::AllocationScope routeScope(allocationScopeFor(routingPath));
+    if (tracer.sampled()) {
+        requestSpan.setDetail(method + " " + routingPath);
+    }
 
     std::string line;
     std::size_t contentLength = 0;
+    // /spectate never ends on its own, so a replay of it would never finish.
+    const bool capturing =
+        m_capture.enabled() && routingPath.rfind("/debug/", 0) != 0 && routingPath != "/spectate";
+    std::vector<std::pair<std::string, std::string>> capturedHeaders;
+    std::string ifNoneMatch;
+    bool acceptsGzip = false;
     while (std::getline(headerStream, line)) {
         if (!line.empty() && line.back() == '\r') {
             line.pop_back();
@@ -619,6 +724,15 @@ void WebServer::handleClient(int clientSocket) {
             continue;
         }
         const std::string key = line.substr(0, colonPos);
+        if (capturing) {
+            const std::size_t valueStart = line.find_first_not_of(' ', colonPos + 1);
+            capturedHeaders.emplace_back(key, valueStart == std::string::npos ? "" : line.substr(valueStart));
+        }
+        if (headerNameIs(key, "if-none-match")) {
+            ifNoneMatch = line.substr(colonPos + 1);
+        } else if (headerNameIs(key, "accept-encoding")) {
+            acceptsGzip = line.find("gzip", colonPos + 1) != std::string::npos;
+        }
         if (key == "Content-Length") {
             const std::string value = line.substr(colonPos + 1);
             try {
@@ -630,7 +744,10 @@ void WebServer::handleClient(int clientSocket) {
         }
     }
 
+    parseSpan.end();
+
     // Read remaining body if not already received.
+    backend::TraceSpan bodySpan("read body");
     while (body.size() < contentLength) {
         bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
         if (bytesRead <= 0) {
@@ -644,24 +761,62 @@ void WebServer::handleClient(int clientSocket) {
     int statusCode = 200;
     std::string responseBody;
 
+    bodySpan.end();
+    if (capturing) {
+        m_capture.record(method, path, routingPath, capturedHeaders, body);
+    }
+
     backend::Logger::instance().log("Request: " + method + " " + path);
 
+    RequestScheduler::Ticket ticket;
+    PriorityClass priorityClass = PriorityClass::Analytics;
+    if (priorityClassFor(routingPath, priorityClass)) {
+        backend::TraceSpan queueSpan("queue wait");
+        ticket = m_scheduler.acquire(priorityClass);
+        if (!ticket) {
+            backend::Logger::instance().log(std::string("Rejected ") + routingPath + ": " +
+                                            priorityClassName(priorityClass) + " queue full.");
+            sendHttpResponse(clientSocket,
+                             "HTTP/1.1 503 Service Unavailable",
+                             R"({"success":false,"error":"Server busy"})",
+                             "application/json",
+                             {{"Retry-After", "1"}});
+            return;
+        }
+    }
+
     try {
-        if (method == "GET" && (routingPath == "/" || routingPath == "/index.html")) {
-            responseBody = loadStaticFile("index.html", contentType);
+        backend::TraceSpan handlerSpan("handler");
+        if (method == "GET" &&
+            (routingPath == "/" || routingPath == "/index.html" || routingPath.rfind("/static/", 0) == 0)) {
+            ticket.release();
+            serveAsset(clientSocket, routingPath, ifNoneMatch, acceptsGzip);
+            return;
         } else if (method == "GET" && routingPath == "/state") {
-            responseBody = buildStateJson();
+            responseBody = buildStateJson(parseFormValue(extractQueryString(path), "player"));
             contentType = "application/json";
-        } else if (method == "GET" && routingPath.rfind("/static/", 0) == 0) {
-            const std::string relativePath = routingPath.substr(1);  // remove leading slash
-            try {
-                responseBody = loadStaticFile(relativePath, contentType);
-            } catch (const std::exception& ex) {
-                backend::Logger::instance().log(std::string("Static asset missing: ") + relativePath +
-                                                " (" + ex.what() + ")");
-                sendNotFound(clientSocket);
-                return;
+        } else if (method == "GET" && routingPath == "/spectate") {
+            // The hub owns the socket from here on and streams every update.
+            if (!m_spectators.subscribe(clientSocket)) {
+                sendHttpResponse(clientSocket,
+                                 "HTTP/1.1 503 Service Unavailable",
+                                 R"({"success":false,"error":"Too many spectators"})",
+                                 "application/json",
+                                 {{"Retry-After", "5"}});
             }
+            return;
+        } else if (method == "GET" && routingPath == "/metrics") {
+            responseBody = buildMetricsText();
+            contentType = "text/plain; version=0.0.4";
+        } else if (method == "GET" && routingPath == "/debug/profile") {
+            serveProfile(clientSocket, extractQueryString(path));
+            return;
+        } else if (method == "GET" && routingPath == "/debug/locks") {
+            responseBody = buildLocksJson();
+            contentType = "application/json";
+        } else if (method == "GET" && routingPath == "/debug/trace") {
+            serveTrace(clientSocket, extractQueryString(path));
+            return;
         } else if (method == "POST" && routingPath == "/move") {
             responseBody = handleApiRequest(method, routingPath, body, contentType, statusCode);
         } else if (method == "POST" && routingPath == "/reset") {
@@ -671,7 +826,17 @@ void WebServer::handleClient(int clientSocket) {
         } else if (method == "POST" && routingPath == "/pause") {
             responseBody = handleApiRequest(method, routingPath, body, contentType, statusCode);
         } else if (method == "POST" && routingPath == "/duckai") {
-            responseBody = handleApiRequest(method, routingPath, body, contentType, statusCode);
+            DuckAiPrompt prompt;
+            std::string errorBody;
+            contentType = "application/json";
+            if (!parseDuckAiPrompt(body, prompt, errorBody, statusCode)) {
+                responseBody = std::move(errorBody);
+            } else if (prompt.stream) {
+                streamDuckAi(clientSocket, prompt);
+                return;
+            } else {
+                responseBody = answerDuckAi(prompt, statusCode);
+            }
         } else if (method == "POST" && routingPath == "/codestats") {
             responseBody = handleApiRequest(method, routingPath, body, contentType, statusCode);
         } else if (method == "POST" && routingPath == "/codestats/export") {
@@ -731,10 +896,18 @@ void WebServer::handleClient(int clientSocket) {
                                             targetDir + "'.");
             std::vector<std::pair<std::string, std::string>> headers{
                 {"Content-Disposition", "attachment; filename=\"" + filename + "\""}};
-            sendHttpResponse(clientSocket, "HTTP/1.1 200 OK", payload, mime, headers);
+            // The report is built; sending it to a slow client needs no worker slot.
+            ticket.release();
+            sendHttpResponse(clientSocket, "HTTP/1.1 200 OK", std::move(payload), mime, headers);
             return;
         } else if (method == "GET" && routingPath == "/attendance/roster") {
-            responseBody = handleApiRequest(method, routingPath, body, contentType, statusCode);
+            const std::string query = extractQueryString(path);
+            if (query.empty()) {
+                // Full dumps stream straight from the repository to the socket.
+                streamAttendanceRoster(clientSocket, ticket);
+                return;
+            }
+            responseBody = handleAttendanceRosterPage(query, contentType, statusCode);
         } else if (method == "GET" && routingPath == "/attendance/previous") {
             responseBody = handleApiRequest(method, routingPath, body, contentType, statusCode);
         } else if (method == "GET" && routingPath == "/attendance/next") {
@@ -752,35 +925,66 @@ void WebServer::handleClient(int clientSocket) {
             backend::Logger::instance().log("Responded 404 for path " + routingPath + ".");
             return;
         }
+    } catch (const backend::AttendanceUnavailableError& ex) {
+        backend::Logger::instance().log(std::string("Attendance storage unavailable: ") + ex.what());
+        sendHttpResponse(clientSocket,
+                         "HTTP/1.1 503 Service Unavailable",
+                         R"({"success":false,"error":"Attendance storage temporarily unavailable"})",
+                         "application/json",
+                         {{"Retry-After", std::to_string(attendanceRetryAfterSeconds())}});
+        return;
     } catch (const std::exception& ex) {
         backend::Logger::instance().log(std::string("Internal error while handling request: ") + ex.what());
         sendInternalError(clientSocket, ex.what());
         return;
     }
+    // Writing to a slow client does not need a worker slot.
+    ticket.release();
 
     std::ostringstream statusLine;
-    statusLine << "HTTP/1.1 " << statusCode << " "
-               << (statusCode == 200 ? "OK" : (statusCode == 400 ? "Bad Request" : "Error"));
-    sendHttpResponse(clientSocket, statusLine.str(), responseBody, contentType);
+    statusLine << "HTTP/1.1 " << statusCode << " " << statusText(statusCode);
+    std::vector<std::pair<std::string, std::string>> extraHeaders;
+    if (statusCode == 503) {
+        long retryAfter = 0;
+        if (routingPath == "/duckai") {
+            retryAfter = m_duckAiGuard.retryAfterSeconds();
+        } else if (routingPath.rfind("/attendance/", 0) == 0) {
+            retryAfter = attendanceRetryAfterSeconds();
+        }
+        extraHeaders.emplace_back("Retry-After", std::to_string(retryAfter > 0 ? retryAfter : 1));
+    }
+    sendHttpResponse(clientSocket, statusLine.str(), std::move(responseBody), contentType, extraHeaders);
 }
 
 void WebServer::sendHttpResponse(int clientSocket,
                                  const std::string& statusLine,
-                                 const std::string& body,
+                                 std::string body,
                                  const std::string& contentType,
                                  const std::vector<std::pair<std::string, std::string>>& extraHeaders) {
-    std::ostringstream response;
-    response << statusLine << "\r\n";
-    response << "Content-Type: " << contentType << "\r\n";
-    response << "Content-Length: " << body.size() << "\r\n";
+    backend::TraceSpan serializeSpan("serialize");
+    std::string head;
+    head.reserve(128 + statusLine.size() + contentType.size());
+    head += statusLine;
+    head += "\r\nContent-Type: ";
+    head += contentType;
+    head += "\r\nContent-Length: ";
+    head += std::to_string(body.size());
+    head += "\r\n";
     for (const auto& header : extraHeaders) {
-        response << header.first << ": " << header.second << "\r\n";
+        head += header.first;
+        head += ": ";
+        head += header.second;
+        head += "\r\n";
     }
-    response << "Connection: close\r\n\r\n";
-    response << body;
+    head += "Connection: close\r\n\r\n";
+    serializeSpan.end();
 
-    const std::string responseStr = response.str();
-    send(clientSocket, responseStr.c_str(), responseStr.size(), 0);
+    // Head and body leave in one gathered write when the socket has room.
+    backend::TraceSpan sendSpan("send");
+    OutputQueue output(clientSocket, m_outputOptions);
+    if (output.append(std::move(head)) && output.append(std::move(body))) {
+        output.flush();
+    }
     ::close(clientSocket);
 }
 
@@ -799,6 +1003,391 @@ void WebServer::sendInternalError(int clientSocket, const std::string& message)
     sendHttpResponse(clientSocket, "HTTP/1.1 500 Internal Server Error", body, "application/json");
 }
 
+bool WebServer::parseDuckAiPrompt(const std::string& body,
+                                  DuckAiPrompt& prompt,
+                                  std::string& errorBody,
+                                  int& statusCode) const {
+    const char* apiKey = std::getenv("OPENAI_API_KEY");
+    if (!apiKey || std::string(apiKey).empty()) {
+        statusCode = 500;
+        errorBody = R"({"success":false,"error":"Missing OPENAI_API_KEY environment variable on server."})";
+        return false;
+    }
+
+    std::string message;
+    std::string model;
+    std::string systemPrompt;
+    bool stream = false;
+    const std::size_t firstChar = body.find_first_not_of(" \t\r\n");
+    if (firstChar != std::string::npos && body[firstChar] == '{') {
+        // One structural pass; each field is then a direct member lookup.
+        const JsonDocument document(body);
+        if (!document.valid()) {
+            statusCode = 400;
+            errorBody = R"({"success":false,"error":"Malformed JSON body."})";
+            return false;
+        }
+        const JsonValue root = document.root();
+        message = root["message"].stringOr("");
+        if (message.empty()) {
+            message = root["content"].stringOr("");
+        }
+        if (message.empty()) {
+            // OpenAI-style bodies: the latest turn is the question.
+            message = root.at("messages[-1].content").stringOr("");
+        }
+        model = root["model"].stringOr("");
+        systemPrompt = root["systemPrompt"].stringOr("");
+        stream = root["stream"].boolOr(false);
+    } else {
+        message = parseFormValue(body, "message");
+        model = parseFormValue(body, "model");
+        systemPrompt = parseFormValue(body, "systemPrompt");
+        stream = parseBooleanFlag(body, "stream");
+    }
+    if (message.empty()) {
+        statusCode = 400;
+        errorBody = R"({"success":false,"error":"Missing message."})";
+        return false;
+    }
+    if (model.empty()) {
+        model = "qwen-plus";
+    }
+    if (systemPrompt.empty()) {
+        systemPrompt = "You are a helpful assistant.";
+    }
+
+    prompt.apiKey = apiKey;
+    prompt.model = std::move(model);
+    prompt.systemPrompt = std::move(systemPrompt);
+    prompt.message = std::move(message);
+    prompt.stream = stream;
+    return true;
+}
+
+frontend::UpstreamRequest WebServer::buildDuckAiRequest(const DuckAiPrompt& prompt, bool stream) const {
+    UpstreamRequest request;
+    request.url = duckAiUpstreamUrl();
+    request.headers = {"Content-Type: application/json", "Authorization: Bearer " + prompt.apiKey};
+    request.body = std::string(R"({"model":")") + jsonEscape(prompt.model) +
+                   R"(","messages":[{"role":"system","content":")" + jsonEscape(prompt.systemPrompt) +
+                   R"("},{"role":"user","content":")" + jsonEscape(prompt.message) + R"("}])" +
+                   (stream ? R"(,"stream":true})" : "}");
+    // Streams are bounded by a first-byte deadline in streamDuckAi instead.
+    request.timeoutMs = stream ? kDuckAiStreamTimeoutMs
+                               : m_duckAiGuard.timeoutMs(UpstreamLatencyKind::Completion);
+    return request;
+}
+
+frontend::CachedResponse WebServer::fetchDuckAiCompletion(const DuckAiPrompt& prompt) {
+    UpstreamGuard::Permit permit;
+    const UpstreamGuard::Admission admission = m_duckAiGuard.tryAcquire(permit);
+    if (admission != UpstreamGuard::Admission::Admitted) {
+        return {503, duckAiUnavailableBody(admission)};
+    }
+
+    // The transfer runs on the shared upstream event loop; this thread only waits.
+    const auto startedAt = std::chrono::steady_clock::now();
+    backend::TraceSpan upstreamSpan("upstream wait");
+    UpstreamResponse upstream = m_upstreamClient.submit(buildDuckAiRequest(prompt, false)).get();
+    upstreamSpan.end();
+    if (upstream.rejected) {
+        return {503, R"({"success":false,"error":"Assistant is busy, please retry."})"};
+    }
+    if (!upstream.ok) {
+        permit.fail(upstream.timedOut);
+        return {upstream.timedOut ? 504 : 502,
+                std::string(R"({"success":false,"error":"Upstream request failed.","detail":")") +
+                    jsonEscape(upstream.error) + R"("})"};
+    }
+
+    const long httpStatus = upstream.status;
+    if (isUpstreamFailureStatus(httpStatus)) {
+        permit.fail(false);
+    } else {
+        permit.succeed(UpstreamLatencyKind::Completion,
+                       std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - startedAt));
+    }
+    if (httpStatus < 200 || httpStatus >= 300) {
+        const int code = static_cast<int>(httpStatus == 0 ? 502 : httpStatus);
+        if (!upstream.body.empty()) {
+            return {code, std::move(upstream.body)};
+        }
+        return {code, R"({"success":false,"error":"Upstream returned non-2xx with empty body."})"};
+    }
+
+    if (upstream.body.empty()) {
+        return {502, R"({"success":false,"error":"Upstream returned empty response."})"};
+    }
+    // Only the answer is kept (and cached); ids, usage and the rest are dropped.
+    const JsonDocument document(upstream.body);
+    std::string content;
+    if (!document.at("choices[0].message.content").getString(content)) {
+        return {502, R"({"success":false,"error":"Upstream response has no choices[0].message.content."})"};
+    }
+    return {200, duckAiAnswerBody(content)};
+}
+
+std::string WebServer::answerDuckAi(const DuckAiPrompt& prompt, int& statusCode) {
+    // Identical prompts share one upstream call and successful answers are reused.
+    const std::shared_ptr<const CachedResponse> response = m_duckAiCache.getOrLoad(
+        ResponseCache::makeKey(prompt.model, prompt.systemPrompt, prompt.message),
+        [&] { return fetchDuckAiCompletion(prompt); });
+    statusCode = response->statusCode;
+    return response->body;
+}
+
+std::string WebServer::duckAiUnavailableBody(UpstreamGuard::Admission admission) const {
+    if (admission == UpstreamGuard::Admission::CircuitOpen) {
+        return R"({"success":false,"error":"Assistant is temporarily unavailable, please retry later.","retryAfterSeconds":)" +
+               std::to_string(m_duckAiGuard.retryAfterSeconds()) + "}";
+    }
+    return R"({"success":false,"error":"Assistant is busy, please retry."})";
+}
+
+void WebServer::streamDuckAi(int clientSocket, const DuckAiPrompt& prompt) {
+    // Shares entries and in-flight calls with buffered requests. Only the
+    // caller that runs the upstream call streams it; hits and callers that
+    // waited on it get the whole answer as a single delta.
+    bool relayed = false;
+    const std::shared_ptr<const CachedResponse> response = m_duckAiCache.getOrLoad(
+        ResponseCache::makeKey(prompt.model, prompt.systemPrompt, prompt.message), [&] {
+            relayed = true;
+            return relayDuckAiStream(clientSocket, prompt);
+        });
+    if (!relayed) {
+        sendCachedDuckAiStream(clientSocket, *response);
+    }
+}
+
+void WebServer::sendCachedDuckAiStream(int clientSocket, const CachedResponse& response) {
+    std::string content;
+    if (response.statusCode < 200 || response.statusCode >= 300 ||
+        !JsonDocument(response.body).at("choices[0].message.content").getString(content)) {
+        std::vector<std::pair<std::string, std::string>> extraHeaders;
+        if (response.statusCode == 503) {
+            extraHeaders.emplace_back("Retry-After", "1");
+        }
+        sendHttpResponse(clientSocket,
+                         "HTTP/1.1 " + std::to_string(response.statusCode) + " " + statusText(response.statusCode),
+                         response.body, "application/json", extraHeaders);
+        return;
+    }
+    ChunkedJsonWriter writer(clientSocket, m_outputOptions, 4096);
+    if (!writer.begin("HTTP/1.1 200 OK", "text/event-stream")) {
+        ::close(clientSocket);
+        return;
+    }
+    std::string event = R"(data: {"delta":")";
+    appendJsonEscaped(event, content);
+    event += "\"}\n\n";
+    writer.writeRaw(event);
+    writer.writeRaw("event: done\ndata: {}\n\n");
+    writer.finish();
+    ::close(clientSocket);
+}
+
+frontend::CachedResponse WebServer::relayDuckAiStream(int clientSocket, const DuckAiPrompt& prompt) {
+    UpstreamGuard::Permit permit;
+    const UpstreamGuard::Admission admission = m_duckAiGuard.tryAcquire(permit);
+    if (admission != UpstreamGuard::Admission::Admitted) {
+        const long retryAfter = m_duckAiGuard.retryAfterSeconds();
+        const std::string body = duckAiUnavailableBody(admission);
+        sendHttpResponse(clientSocket, "HTTP/1.1 503 Service Unavailable", body, "application/json",
+                         {{"Retry-After", std::to_string(retryAfter > 0 ? retryAfter : 1)}});
+        return {503, body};
+    }
+    UpstreamRequest request = buildDuckAiRequest(prompt, true);
+
+    // The event loop only appends upstream bytes here; this thread owns the socket,
+    // so a slow browser never stalls other upstream transfers.
+    struct StreamState {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::string pending;
+        long status{0};
+    };
+    auto state = std::make_shared<StreamState>();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    request.cancelled = cancelled;
+    request.onData = [state](long status, const char* data, std::size_t size) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->status = status;
+        if (state->pending.size() + size > kMaxPendingStreamBytes) {
+            return false;  // Client is not keeping up; give up on the upstream.
+        }
+        state->pending.append(data, size);
+        state->cv.notify_one();
+        return true;
+    };
+
+    const auto startedAt = std::chrono::steady_clock::now();
+    const long firstByteTimeoutMs = m_duckAiGuard.timeoutMs(UpstreamLatencyKind::FirstByte);
+    const auto firstByteDeadline = startedAt + std::chrono::milliseconds(firstByteTimeoutMs);
+    std::future<UpstreamResponse> result = m_upstreamClient.submit(std::move(request));
+
+    ChunkedJsonWriter writer(clientSocket, m_outputOptions, 4096);
+    SseParser parser;
+    bool headersSent = false;
+    bool aborted = false;
+    std::size_t deltas = 0;
+    long long firstDeltaMs = -1;
+    long long firstByteMs = -1;
+    bool firstByteTimedOut = false;
+    std::string upstreamErrorBody;
+    std::string answer;  // the whole completion, for the cache
+    std::string chunk;
+    std::string event;
+    while (true) {
+        // Checked before draining so bytes delivered just before completion are not lost.
+        const bool finished = result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        long status = 0;
+        chunk.clear();
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (!finished && state->pending.empty()) {
+                state->cv.wait_for(lock, kStreamPollInterval);
+            }
+            chunk.swap(state->pending);
+            status = state->status;
+        }
+        if (firstByteMs < 0 && !chunk.empty()) {
+            firstByteMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - startedAt)
+                              .count();
+        } else if (firstByteMs < 0 && !finished && !firstByteTimedOut &&
+                   std::chrono::steady_clock::now() >= firstByteDeadline) {
+            // A silent upstream is cut off well before the whole-stream timeout;
+            // the loop then ends when the aborted transfer completes.
+            firstByteTimedOut = true;
+            cancelled->store(true);
+            m_upstreamClient.wake();
+        }
+
+        if (!chunk.empty() && (status < 200 || status >= 300)) {
+            // Only the start is relayed; the rest is drained and dropped.
+            if (upstreamErrorBody.size() < kMaxUpstreamErrorBytes) {
+                upstreamErrorBody.append(chunk, 0, kMaxUpstreamErrorBytes - upstreamErrorBody.size());
+            }
+        } else if (!chunk.empty()) {
+            if (!headersSent) {
+                headersSent = writer.begin("HTTP/1.1 200 OK", "text/event-stream");
+                if (!headersSent) {
+                    aborted = true;
+                    break;
+                }
+            }
+            parser.feed(chunk, [&](const SseEvent& upstreamEvent) {
+                if (upstreamEvent.data == "[DONE]") {
+                    return;
+                }
+                // OpenAI-compatible chunks carry the new text in choices[0].delta.content.
+                const JsonDocument document(upstreamEvent.data);
+                std::string delta;
+                if (!document.at("choices[0].delta.content").getString(delta) || delta.empty()) {
+                    return;
+                }
+                if (firstDeltaMs < 0) {
+                    firstDeltaMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       std::chrono::steady_clock::now() - startedAt)
+                                       .count();
+                }
+                ++deltas;
+                answer += delta;
+                event = R"(data: {"delta":")";
+                appendJsonEscaped(event, delta);
+                event += "\"}\n\n";
+                writer.writeRaw(event);
+            });
+            if (!writer.flush()) {
+                aborted = true;
+                break;
+            }
+        } else if (!finished && (!writer.flush() || clientDisconnected(clientSocket))) {
+            // Idle upstream: push out anything the client could not take earlier.
+            aborted = true;
+            break;
+        }
+        if (finished) {
+            break;
+        }
+    }
+
+    if (aborted) {
+        cancelled->store(true);
+        m_upstreamClient.wake();
+        backend::Logger::instance().log("Duck AI stream aborted by client after " +
+                                        std::to_string(deltas) + " deltas.");
+        ::close(clientSocket);
+        // Callers that waited on this stream retry and make their own call.
+        return {503, R"({"success":false,"error":"Assistant answer was interrupted, please retry."})"};
+    }
+
+    UpstreamResponse response = result.get();
+    if (firstByteTimedOut) {
+        response.timedOut = true;
+        response.error = "No response from upstream within " + std::to_string(firstByteTimeoutMs) + " ms.";
+    }
+    if (response.rejected) {
+        // Never reached the upstream; the permit is released without a verdict.
+    } else if (!response.ok || isUpstreamFailureStatus(response.status)) {
+        permit.fail(response.timedOut);
+    } else {
+        permit.succeed(UpstreamLatencyKind::FirstByte, std::chrono::milliseconds(std::max(0LL, firstByteMs)));
+    }
+
+    if (!headersSent) {
+        // Nothing was streamed, so the outcome can still be a plain JSON response.
+        int code = 502;
+        std::string payload;
+        if (response.rejected) {
+            code = 503;
+            payload = R"({"success":false,"error":"Assistant is busy, please retry."})";
+        } else if (!response.ok) {
+            code = response.timedOut ? 504 : 502;
+            payload = std::string(R"({"success":false,"error":"Upstream request failed.","detail":")") +
+                      jsonEscape(response.error) + R"("})";
+        } else if (response.status < 200 || response.status >= 300) {
+            code = static_cast<int>(response.status == 0 ? 502 : response.status);
+            payload = upstreamErrorBody.empty()
+                          ? R"({"success":false,"error":"Upstream returned non-2xx with empty body."})"
+                          : upstreamErrorBody;
+        } else {
+            payload = R"({"success":false,"error":"Upstream returned empty response."})";
+        }
+        std::vector<std::pair<std::string, std::string>> extraHeaders;
+        if (code == 503) {
+            extraHeaders.emplace_back("Retry-After", "1");
+        }
+        sendHttpResponse(clientSocket, "HTTP/1.1 " + std::to_string(code) + " " + statusText(code),
+                         payload, "application/json", extraHeaders);
+        return {code, payload};
+    }
+
+    if (!response.ok) {
+        event = "event: error\ndata: {\"error\":\"";
+        appendJsonEscaped(event, response.error);
+        event += "\"}\n\n";
+        writer.writeRaw(event);
+    }
+    writer.writeRaw("event: done\ndata: {}\n\n");
+    writer.finish();
+    ::close(clientSocket);
+
+    const auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - startedAt)
+                             .count();
+    backend::Logger::instance().log("Duck AI stream finished: " + std::to_string(deltas) +
+                                    " deltas, first after " + std::to_string(firstDeltaMs) + " ms, total " +
+                                    std::to_string(totalMs) + " ms.");
+    if (!response.ok || answer.empty()) {
+        return {502, std::string(R"({"success":false,"error":"Upstream stream failed.","detail":")") +
+                         jsonEscape(response.error) + R"("})"};
+    }
+    return {200, duckAiAnswerBody(answer)};
+}
+
 std::string WebServer::handleApiRequest(const std::string& method,
                                         const std::string& path,
                                         const std::string& body,
@@ -809,39 +1398,56 @@ std::string WebServer::handleApiRequest(const std::string& method,
 
     if (method == "POST" && path == "/move") {
         backend::MoveDirection direction = parseDirection(body);
+        // Predicting clients send player=<id>&seq=<n> and get the
+        // acknowledged sequence and exact tank state back to reconcile with.
+        const std::string player = parseFormValue(body, "player");
+        const std::uint64_t sequence = parseSequence(parseFormValue(body, "seq"));
+        const bool sequenced = !player.empty() && sequence > 0;
         bool moved = false;
         bool timeUp = false;
+        std::ostringstream oss;
         {
-            std::lock_guard<std::mutex> guard(m_engineMutex);
+            const auto guard = lockEngine();
             timeUp = m_engine.isTimeUp();
-            if (!timeUp && direction != backend::MoveDirection::None) {
+            if (sequenced) {
+                moved = m_engine.applyInput(player, sequence, direction);
+            } else if (!timeUp && direction != backend::MoveDirection::None) {
                 moved = m_engine.moveTank(direction);
             }
+            oss << R"({"success":)" << ((moved && !timeUp) ? "true" : "false") << ",";
+            oss << R"("timeUp":)" << (timeUp ? "true" : "false");
+            if (sequenced) {
+                oss << R"(,"ack":)" << m_engine.lastInputSequence(player) << ",";
+                appendTankJson(oss, m_engine.getTank());
+            }
+            oss << "}";
+        }
+        if (moved) {
+            notifyEngineChanged();
         }
         std::string logMessage = "Move request, body='" + body + "', moved=" +
                                  std::string(moved ? "true" : "false") + ", timeUp=" +
                                  std::string(timeUp ? "true" : "false") + ".";
         backend::Logger::instance().log(logMessage);
-        std::ostringstream oss;
-        oss << R"({"success":)" << ((moved && !timeUp) ? "true" : "false") << ",";
-        oss << R"("timeUp":)" << (timeUp ? "true" : "false") << "}";
         return oss.str();
     } else if (method == "POST" && path == "/reset") {
         {
-            std::lock_guard<std::mutex> guard(m_engineMutex);
+            const auto guard = lockEngine();
             const auto seed = static_cast<unsigned int>(
                 std::chrono::system_clock::now().time_since_epoch().count());
             m_engine.setRandomSeed(seed);
             m_engine.reset();
         }
+        notifyEngineChanged();
         backend::Logger::instance().log("Reset request completed and engine reseeded.");
         return R"({"success":true})";
     } else if (method == "POST" && path == "/rain") {
         int spawned = 0;
         {
-            std::lock_guard<std::mutex> guard(m_engineMutex);
+            const auto guard = lockEngine();
             spawned = m_engine.spawnBonusEnvelopes(5, 10);
         }
+        notifyEngineChanged();
         backend::Logger::instance().log("Rain request spawned " + std::to_string(spawned) +
                                         " bonus envelopes.");
         std::ostringstream oss;
@@ -851,7 +1457,7 @@ std::string WebServer::handleApiRequest(const std::string& method,
         const std::string action = parseAction(body);
         bool paused = false;
         {
-            std::lock_guard<std::mutex> guard(m_engineMutex);
+            const auto guard = lockEngine();
             if (action == "pause") {
                 m_engine.pause();
             } else if (action == "resume") {
@@ -861,99 +1467,12 @@ std::string WebServer::handleApiRequest(const std::string& method,
             }
             paused = m_engine.isPaused();
         }
+        notifyEngineChanged();
         backend::Logger::instance().log("Pause request '" + action + "' -> " +
                                         std::string(paused ? "paused" : "running") + ".");
         std::ostringstream oss;
         oss << R"({"success":true,"paused":)" << (paused ? "true" : "false") << "}";
         return oss.str();
-    } else if (method == "POST" && path == "/duckai") {
-        ensureCurlInitialized();
-
-        const char* apiKey = std::getenv("OPENAI_API_KEY");
-        if (!apiKey || std::string(apiKey).empty()) {
-            statusCode = 500;
-            return R"({"success":false,"error":"Missing OPENAI_API_KEY environment variable on server."})";
-        }
-
-        std::string message = parseFormValue(body, "message");
-        if (message.empty()) {
-            message = extractJsonStringField(body, "message");
-        }
-        if (message.empty()) {
-            message = extractJsonStringField(body, "content");
-        }
-        if (message.empty()) {
-            statusCode = 400;
-            return R"({"success":false,"error":"Missing message."})";
-        }
-
-        std::string model = parseFormValue(body, "model");
-        if (model.empty()) {
-            model = extractJsonStringField(body, "model");
-        }
-        if (model.empty()) {
-            model = "qwen-plus";
-        }
-
-        std::string systemPrompt = parseFormValue(body, "systemPrompt");
-        if (systemPrompt.empty()) {
-            systemPrompt = extractJsonStringField(body, "systemPrompt");
-        }
-        if (systemPrompt.empty()) {
-            systemPrompt = "You are a helpful assistant.";
-        }
-
-        const std::string requestJson =
-            std::string(R"({"model":")") + jsonEscape(model) + R"(","messages":[{"role":"system","content":")" +
-            jsonEscape(systemPrompt) + R"("},{"role":"user","content":")" + jsonEscape(message) + R"("}]})";
-
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            statusCode = 500;
-            return R"({"success":false,"error":"Failed to initialize curl."})";
-        }
-
-        std::string responsePayload;
-        std::unique_ptr<curl_slist, CurlSlistDeleter> headers;
-        headers.reset(curl_slist_append(headers.release(), "Content-Type: application/json"));
-        headers.reset(curl_slist_append(headers.release(),
-                                        (std::string("Authorization: Bearer ") + apiKey).c_str()));
-
-        curl_easy_setopt(curl, CURLOPT_URL,
-                         "https://dashscope.aliyuncs.com/compatible-mode/v1/chat/completions");
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers.get());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requestJson.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(requestJson.size()));
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlWriteToString);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responsePayload);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 20L);
-
-        const CURLcode res = curl_easy_perform(curl);
-        long httpStatus = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
-        curl_easy_cleanup(curl);
-
-        if (res != CURLE_OK) {
-            statusCode = 502;
-            return std::string(R"({"success":false,"error":"Upstream request failed.","detail":")") +
-                   jsonEscape(curl_easy_strerror(res)) + R"("})";
-        }
-
-        if (httpStatus < 200 || httpStatus >= 300) {
-            statusCode = static_cast<int>(httpStatus == 0 ? 502 : httpStatus);
-            if (!responsePayload.empty()) {
-                return responsePayload;
-            }
-            return R"({"success":false,"error":"Upstream returned non-2xx with empty body."})";
-        }
-
-        if (responsePayload.empty()) {
-            statusCode = 502;
-            return R"({"success":false,"error":"Upstream returned empty response."})";
-        }
-
-        return responsePayload;
     } else if (method == "POST" && path == "/codestats") {
         const std::string directory = parseDirectory(body);
         const std::string targetDir = directory.empty() ? "." : directory;
@@ -1018,39 +1537,67 @@ std::string WebServer::handleApiRequest(const std::string& method,
     } else if (method == "POST" && path == "/layout") {
         backend::Logger::instance().log("Layout customization requested.");
         contentType = "application/json";
-        statusCode = 202;
-        const std::string userId = "default";  // TODO: Extract from payload.
-        (void)body;
-        const std::string serialized = buildLayoutSettingsJson(userId);
-        return R"({"success":false,"message":"Layout manager not yet implemented","settings":")" +
-               serialized + R"("})";
-    } else if (method == "GET" && path == "/attendance/roster") {
-        contentType = "application/json";
-        if (!m_attendanceRepo) {
-            statusCode = 500;
-            return R"({"success":false,"error":"Attendance repository not configured"})";
-        }
-        const std::vector<backend::Student> students = m_attendanceRepo->listStudents();
-        std::ostringstream oss;
-        oss << R"({"success":true,"students":[)";
-        for (std::size_t i = 0; i < students.size(); ++i) {
-            const backend::Student& s = students[i];
-            oss << R"({"id":")" << jsonEscape(s.studentId) << R"(","name":")"
-                << jsonEscape(s.name) << R"("})";
-            if (i + 1 < students.size()) {
-                oss << ",";
+        // Fields left out (or empty, in a form) keep their stored value.
+        std::string userId;
+        std::string theme;
+        std::string layoutPreset;
+        bool hasCompactMode = false;
+        bool compactMode = false;
+        const std::size_t firstChar = body.find_first_not_of(" \t\r\n");
+        if (firstChar != std::string::npos && body[firstChar] == '{') {
+            const JsonDocument document(body);
+            if (!document.valid()) {
+                statusCode = 400;
+                return R"({"success":false,"error":"Malformed JSON body."})";
             }
+            const JsonValue root = document.root();
+            userId = root["userId"].stringOr("");
+            theme = root["theme"].stringOr("");
+            layoutPreset = root["layoutPreset"].stringOr("");
+            hasCompactMode = root["compactMode"].valid();
+            compactMode = root["compactMode"].boolOr(false);
+        } else {
+            userId = parseFormValue(body, "userId");
+            theme = parseFormValue(body, "theme");
+            layoutPreset = parseFormValue(body, "layoutPreset");
+            hasCompactMode = !parseFormValue(body, "compactMode").empty();
+            compactMode = parseBooleanFlag(body, "compactMode");
         }
-        oss << "]}"
-            ;
-        return oss.str();
+        if (userId.empty()) {
+            statusCode = 400;
+            return R"({"success":false,"error":"Missing userId"})";
+        }
+        if (userId.size() > kMaxLayoutFieldBytes || theme.size() > kMaxLayoutFieldBytes ||
+            layoutPreset.size() > kMaxLayoutFieldBytes) {
+            statusCode = 400;
+            return R"({"success":false,"error":"Layout field too long"})";
+        }
+
+        UserLayoutPreferences preferences = m_layoutManager.getPreferences(userId);
+        if (!theme.empty()) {
+            preferences.theme = theme;
+        }
+        if (!layoutPreset.empty()) {
+            preferences.layoutPreset = layoutPreset;
+        }
+        if (hasCompactMode) {
+            preferences.compactMode = compactMode;
+        }
+        try {
+            m_layoutManager.applyPreferences(userId, preferences);
+        } catch (const std::exception& ex) {
+            backend::Logger::instance().log(std::string("Layout update for '") + userId + "' failed: " + ex.what());
+            statusCode = 503;
+            return R"({"success":false,"error":"Layout settings could not be saved, please retry."})";
+        }
+        return R"({"success":true,"settings":)" + buildLayoutSettingsJson(userId) + "}";
     } else if (method == "GET" && path == "/attendance/previous") {
         contentType = "application/json";
-        if (!m_attendanceRepo) {
-            statusCode = 500;
-            return R"({"success":false,"error":"Attendance repository not configured"})";
+        backend::AttendanceRepository* repo = attendanceRepository();
+        if (!repo) {
+            return attendanceUnavailable(contentType, statusCode);
         }
-        const std::vector<backend::Student> students = m_attendanceRepo->listStudents();
+        const std::vector<backend::Student> students = repo->listStudents();
         if (students.empty()) {
             return R"({"success":true,"empty":true})";
         }
@@ -1064,11 +1611,11 @@ std::string WebServer::handleApiRequest(const std::string& method,
         return oss.str();
     } else if (method == "GET" && path == "/attendance/next") {
         contentType = "application/json";
-        if (!m_attendanceRepo) {
-            statusCode = 500;
-            return R"({"success":false,"error":"Attendance repository not configured"})";
+        backend::AttendanceRepository* repo = attendanceRepository();
+        if (!repo) {
+            return attendanceUnavailable(contentType, statusCode);
         }
-        const std::vector<backend::Student> students = m_attendanceRepo->listStudents();
+        const std::vector<backend::Student> students = repo->listStudents();
         if (students.empty()) {
             return R"({"success":true,"empty":true})";
         }
@@ -1091,11 +1638,39 @@ std::string WebServer::handleApiRequest(const std::string& method,
     return R"({"error":"Unsupported API path"})";
 }
 
-std::string WebServer::buildStateJson() {
-    std::lock_guard<std::mutex> guard(m_engineMutex);
+std::unique_lock<backend::InstrumentedMutex> WebServer::lockEngine() {
+    backend::TraceSpan waitSpan("engine lock wait");
+    return std::unique_lock<backend::InstrumentedMutex>(m_engineMutex);
+}
+
+void WebServer::runEngineTicker() {
+    std::unique_lock<backend::InstrumentedMutex> lock(m_engineMutex);
+    while (!m_engineTickerStopping) {
+        if (m_engine.update() > 0) {
+            lock.unlock();
+            m_spectators.notify();
+            lock.lock();
+            continue;
+        }
+        // Requests that move the deadline earlier (reset, resume) wake the
+        // ticker; the cap covers changes made without notifying.
+        const auto wait = std::clamp(m_engine.untilNextEvent(), std::chrono::milliseconds(1), kEngineTickerMaxSleep);
+        m_engineTickerCv.wait_for(lock, wait);
+    }
+}
+
+void WebServer::notifyEngineChanged() {
+    m_engineTickerCv.notify_one();
+    m_spectators.notify();
+}
+
+std::string WebServer::buildStateJson(const std::string& player) {
+    const auto guard = lockEngine();
+    m_engine.update();
+    backend::TraceSpan buildSpan("build state");
+    backend::AllocationScope allocationScope("state_json");
     const backend::GameConfig& config = m_engine.getConfig();
     const backend::CollectionStats stats = m_engine.getStats();
-    const backend::Position tankPos = m_engine.getTank().getPosition();
     const double timeLeft =
         std::max(0.0, static_cast<double>(config.timeLimitSeconds) - m_engine.elapsedSeconds());
 
@@ -1105,8 +1680,9 @@ std::string WebServer::buildStateJson() {
         << R"(,"worldHeight":)" << config.worldHeight
         << R"(,"timeLimit":)" << config.timeLimitSeconds
         << R"(,"timeLeft":)" << timeLeft
-        << R"(,"tank":{"x":)" << tankPos.x << R"(,"y":)" << tankPos.y << "},"
-        << R"("stats":{"count":)" << stats.collectedCount
+        << R"(,"ack":)" << (player.empty() ? 0 : m_engine.lastInputSequence(player)) << ",";
+    appendTankJson(oss, m_engine.getTank());
+    oss << R"(,"stats":{"count":)" << stats.collectedCount
         << R"(,"value":)" << stats.collectedValue << "},"
         << R"("paused":)" << (m_engine.isPaused() ? "true" : "false") << ","
         << R"("envelopes":[)";
@@ -1141,39 +1717,115 @@ std::string WebServer::buildStateJson() {
     return oss.str();
 }
 
-std::string WebServer::loadStaticFile(const std::string& targetPath, std::string& contentType) {
-    std::filesystem::path fullPath = std::filesystem::path(m_staticDir) / targetPath;
-    if (!std::filesystem::exists(fullPath)) {
-        fullPath = std::filesystem::path(targetPath);
+void WebServer::serveAsset(int clientSocket,
+                           const std::string& routingPath,
+                           const std::string& ifNoneMatch,
+                           bool acceptsGzip) {
+    if (m_assets.overridden()) {
+        const std::string fullPath = m_assets.overridePath(routingPath);
+        try {
+            if (fullPath.empty()) {
+                throw std::runtime_error("path escapes TANK_ASSET_DIR");
+            }
+            sendStaticFile(clientSocket, fullPath);
+        } catch (const std::exception& ex) {
+            backend::Logger::instance().log("Static asset missing: " + routingPath + " (" + ex.what() + ")");
+            sendNotFound(clientSocket);
+        }
+        return;
     }
 
-    if (!std::filesystem::exists(fullPath)) {
-        throw std::runtime_error("Static file not found: " + fullPath.string());
+    const EmbeddedAsset* asset = m_assets.find(routingPath);
+    if (!asset) {
+        backend::Logger::instance().log("Static asset missing: " + routingPath + ".");
+        sendNotFound(clientSocket);
+        return;
     }
 
-    std::ifstream file(fullPath, std::ios::binary);
-    if (!file) {
-        throw std::runtime_error("Unable to open static file: " + fullPath.string());
+    // Each encoding is a different representation, so it gets its own tag.
+    const bool gzip = acceptsGzip && asset->gzipData;
+    std::string etag = std::string("\"") + asset->hash + (gzip ? "-gz\"" : "\"");
+    std::string head;
+    head.reserve(256);
+    const bool notModified = ifNoneMatch.find(etag) != std::string::npos;
+    head += notModified ? "HTTP/1.1 304 Not Modified\r\n" : "HTTP/1.1 200 OK\r\n";
+    if (!notModified) {
+        head += "Content-Type: ";
+        head += asset->contentType;
+        head += "\r\nContent-Length: ";
+        head += std::to_string(gzip ? asset->gzipSize : asset->size);
+        head += "\r\n";
+        if (gzip) {
+            head += "Content-Encoding: gzip\r\n";
+        }
+    }
+    // Hashed paths change whenever their bytes do, so the browser can keep
+    // them without asking again; everything else is revalidated by ETag.
+    head += "ETag: " + etag + "\r\nCache-Control: ";
+    head += asset->immutable ? "public, max-age=31536000, immutable\r\n" : "no-cache\r\n";
+    if (asset->gzipData) {
+        head += "Vary: Accept-Encoding\r\n";
+    }
+    head += "Connection: close\r\n\r\n";
+
+    backend::TraceSpan sendSpan("send");
+    OutputQueue output(clientSocket, m_outputOptions);
+    bool queued = output.append(std::move(head));
+    if (queued && !notModified) {
+        const unsigned char* data = gzip ? asset->gzipData : asset->data;
+        queued = output.appendStatic(std::string_view(reinterpret_cast<const char*>(data),
+                                                      gzip ? asset->gzipSize : asset->size));
+    }
+    if (queued) {
+        output.flush();
     }
+    ::close(clientSocket);
+}
 
-    std::ostringstream buffer;
-    buffer << file.rdbuf();
+void WebServer::sendStaticFile(int clientSocket, const std::string& fullPath) {
+    const int fd = ::open(fullPath.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info {};
+    if (fd < 0 || ::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error("Unable to open static file: " + fullPath);
+    }
 
-    const std::string extension = fullPath.extension().string();
+    const std::string extension = std::filesystem::path(fullPath).extension().string();
+    std::string contentType;
     if (extension == ".html") {
         contentType = "text/html; charset=utf-8";
     } else if (extension == ".js") {
         contentType = "application/javascript";
     } else if (extension == ".css") {
         contentType = "text/css";
+    } else if (extension == ".png") {
+        contentType = "image/png";
+    } else if (extension == ".jpg" || extension == ".jpeg") {
+        contentType = "image/jpeg";
     } else {
         contentType = "application/octet-stream";
     }
 
-    return buffer.str();
+    // The body is never copied into memory: the queue sends it with
+    // sendfile() as the socket drains.
+    std::string head = "HTTP/1.1 200 OK\r\nContent-Type: " + contentType +
+                       "\r\nContent-Length: " + std::to_string(info.st_size) +
+                       "\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n";
+    backend::TraceSpan sendSpan("send");
+    OutputQueue output(clientSocket, m_outputOptions);
+    if (output.append(std::move(head)) &&
+        output.appendFile(fd, 0, static_cast<std::size_t>(info.st_size))) {
+        output.flush();
+    }
+    ::close(clientSocket);
 }
 
-backend::MoveDirection WebServer::parseDirection(const std::string& payload) const {
+backend::MoveDirection WebServer::parseDirection(const std::string& body) const {
+    // direction=<name> when present, so other fields cannot match by accident.
+    const std::string value = parseFormValue(body, "direction");
+    const std::string& payload = value.empty() ? body : value;
     if (payload.find("up") != std::string::npos) {
         return backend::MoveDirection::Up;
     }
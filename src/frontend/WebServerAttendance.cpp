@@ -4,12 +4,36 @@
 #include "frontend/WebServer.hpp"
 
 #include "backend/Attendance.hpp"
+#include "backend/Logger.hpp"
+#include "frontend/ChunkedJsonWriter.hpp"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <cstdlib>
 #include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace {
 
+constexpr std::size_t kDefaultRosterPageSize = 50;
+constexpr std::size_t kMaxRosterPageSize = 500;
+// Reconnect interval once the initial attempts have failed; also what
+// Retry-After tells clients in that state.
+constexpr long kAttendanceRetrySeconds = 30;
+
+void appendStudentJson(std::string& out, const backend::Student& student) {
+    out += R"({"id":")";
+    frontend::appendJsonEscaped(out, student.studentId);
+    out += R"(","name":")";
+    frontend::appendJsonEscaped(out, student.name);
+    out += R"("})";
+}
+
 std::string todayIsoDate() {
     const auto now = std::chrono::system_clock::now();
     const std::time_t t = std::chrono::system_clock::to_time_t(now);
@@ -30,14 +54,70 @@ std::string todayIsoDate() {
 
 namespace frontend {
 
+void WebServer::initializeAttendanceRepository() {
+    // A few quick attempts cover a database that is still starting. After
+    // that the state is Failed, but attempts continue at a slow pace so the
+    // database coming back does not need a server restart.
+    constexpr int kFastAttempts = 6;
+    auto backoff = std::chrono::milliseconds(250);
+    constexpr auto kMaxBackoff = std::chrono::milliseconds(8000);
+
+    for (int attempt = 1;; ++attempt) {
+        try {
+            std::unique_ptr<backend::AttendanceRepository> repo = backend::createAttendanceRepository();
+            m_attendanceRepoOwner = std::move(repo);
+            m_attendanceRepo.store(m_attendanceRepoOwner.get(), std::memory_order_release);
+            m_attendanceState.store(AttendanceState::Ready, std::memory_order_release);
+            backend::Logger::instance().log("Attendance repository ready after " +
+                                            std::to_string(attempt) + " attempt(s).");
+            return;
+        } catch (const std::exception& ex) {
+            backend::Logger::instance().log("Attendance repository attempt " + std::to_string(attempt) +
+                                            " failed: " + ex.what());
+        }
+
+        if (attempt == kFastAttempts) {
+            m_attendanceState.store(AttendanceState::Failed, std::memory_order_release);
+            backend::Logger::instance().log("Attendance repository unavailable; attendance routes will answer "
+                                            "503 while retrying every " +
+                                            std::to_string(kAttendanceRetrySeconds) + " s.");
+        }
+        const auto wait =
+            attempt >= kFastAttempts ? std::chrono::milliseconds(kAttendanceRetrySeconds * 1000) : backoff;
+        std::unique_lock<std::mutex> lock(m_attendanceInitMutex);
+        if (m_attendanceInitCv.wait_for(lock, wait, [this] { return m_stopping; })) {
+            return;
+        }
+        backoff = std::min(backoff * 2, kMaxBackoff);
+    }
+}
+
+long WebServer::attendanceRetryAfterSeconds() const noexcept {
+    return m_attendanceState.load(std::memory_order_acquire) == AttendanceState::Failed ? kAttendanceRetrySeconds
+                                                                                        : 1;
+}
+
+backend::AttendanceRepository* WebServer::attendanceRepository() const noexcept {
+    return m_attendanceRepo.load(std::memory_order_acquire);
+}
+
+std::string WebServer::attendanceUnavailable(std::string& contentType, int& statusCode) const {
+    contentType = "application/json";
+    statusCode = 503;
+    if (m_attendanceState.load(std::memory_order_acquire) == AttendanceState::Failed) {
+        return R"({"success":false,"error":"Attendance storage unavailable"})";
+    }
+    return R"({"success":false,"error":"Attendance storage is still initializing"})";
+}
+
 std::string WebServer::handleAttendanceMark(const std::string& body,
                                             std::string& contentType,
                                             int& statusCode) {
     contentType = "application/json";
 
-    if (!m_attendanceRepo) {
-        statusCode = 500;
-        return R"({"success":false,"error":"Attendance repository not configured"})";
+    backend::AttendanceRepository* repo = attendanceRepository();
+    if (!repo) {
+        return attendanceUnavailable(contentType, statusCode);
     }
 
     const std::string studentId = parseFormValue(body, "studentId");
@@ -71,7 +151,7 @@ std::string WebServer::handleAttendanceMark(const std::string& body,
     }
 
     backend::AttendanceRecord record{studentId, dateIso, status};
-    const bool ok = m_attendanceRepo->markAttendance(record);
+    const bool ok = repo->markAttendance(record);
     if (!ok) {
         statusCode = 500;
         return R"({"success":false,"error":"Failed to persist attendance record"})";
@@ -79,4 +159,115 @@ std::string WebServer::handleAttendanceMark(const std::string& body,
     return R"({"success":true})";
 }
 
+std::string WebServer::handleAttendanceRosterPage(const std::string& query,
+                                                  std::string& contentType,
+                                                  int& statusCode) {
+    contentType = "application/json";
+
+    backend::AttendanceRepository* repo = attendanceRepository();
+    if (!repo) {
+        return attendanceUnavailable(contentType, statusCode);
+    }
+
+    const std::string afterId = parseFormValue(query, "after");
+    std::size_t limit = kDefaultRosterPageSize;
+    const std::string limitValue = parseFormValue(query, "limit");
+    if (!limitValue.empty()) {
+        // Signed parse: strtoul would wrap "-5" and skip leading whitespace.
+        char* endPtr = nullptr;
+        const long parsed = std::strtol(limitValue.c_str(), &endPtr, 10);
+        if (!std::isdigit(static_cast<unsigned char>(limitValue.front())) || !endPtr || *endPtr != '\0' ||
+            parsed <= 0) {
+            statusCode = 400;
+            return R"({"success":false,"error":"Invalid limit"})";
+        }
+        limit = std::min<std::size_t>(static_cast<std::size_t>(parsed), kMaxRosterPageSize);
+    }
+
+    // Fetch one extra row to learn whether another page exists.
+    std::vector<backend::Student> page = repo->listStudentsAfter(afterId, limit + 1);
+    const bool hasMore = page.size() > limit;
+    if (hasMore) {
+        page.resize(limit);
+    }
+
+    std::string out;
+    out.reserve(64 + page.size() * 48);
+    out += R"({"success":true,"students":[)";
+    for (std::size_t i = 0; i < page.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        appendStudentJson(out, page[i]);
+    }
+    out += R"(],"hasMore":)";
+    out += hasMore ? "true" : "false";
+    out += R"(,"nextAfter":)";
+    if (hasMore) {
+        out += '"';
+        appendJsonEscaped(out, page.back().studentId);
+        out += '"';
+    } else {
+        out += "null";
+    }
+    out += '}';
+    return out;
+}
+
+void WebServer::streamAttendanceRoster(int clientSocket, RequestScheduler::Ticket& ticket) {
+    backend::AttendanceRepository* repo = attendanceRepository();
+    if (!repo) {
+        std::string contentType;
+        int statusCode = 0;
+        const std::string body = attendanceUnavailable(contentType, statusCode);
+        sendHttpResponse(clientSocket, "HTTP/1.1 503 Service Unavailable", body, contentType,
+                         {{"Retry-After", std::to_string(attendanceRetryAfterSeconds())}});
+        return;
+    }
+
+    ChunkedJsonWriter writer(clientSocket, m_outputOptions);
+    if (!writer.begin("HTTP/1.1 200 OK")) {
+        ::close(clientSocket);
+        return;
+    }
+
+    writer.writeRaw(R"({"success":true,"students":[)");
+    std::size_t count = 0;
+    std::string row;
+    bool completed = false;
+    try {
+        completed = repo->forEachStudent([&](const backend::Student& student) {
+            // The first batch has been read from the database; from here the
+            // pace is set by the client, which must not hold a worker slot.
+            // Later batches are short, and the repository lock already
+            // serializes them.
+            ticket.release();
+            row.clear();
+            if (count > 0) {
+                row += ',';
+            }
+            appendStudentJson(row, student);
+            ++count;
+            // Stop pulling rows as soon as the client goes away.
+            return writer.writeRaw(row);
+        });
+    } catch (const std::exception& ex) {
+        // The 200 headers (and maybe part of the body) are already out, so
+        // the generic 503/500 responses can no longer be sent; this covers
+        // AttendanceUnavailableError when MySQL drops mid-walk.
+        backend::Logger::instance().log(std::string("Roster stream failed: ") + ex.what());
+    }
+    ticket.release();
+
+    if (completed && !writer.failed()) {
+        writer.writeRaw("]}");
+        writer.finish();
+    } else {
+        // Leave the chunked body unterminated so the client sees a truncated transfer.
+        backend::Logger::instance().log("Roster stream aborted after " + std::to_string(count) +
+                                        " students.");
+    }
+    ::close(clientSocket);
+}
+
 }  // namespace frontend
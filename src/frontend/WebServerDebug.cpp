@@ -0,0 +1,161 @@
+// File: WebServerDebug.cpp
+// Description: Diagnostic endpoints under /debug/, separated from core
+//              WebServer routing.
+
+#include "frontend/WebServer.hpp"
+
+#include "backend/InstrumentedMutex.hpp"
+#include "backend/Logger.hpp"
+#include "backend/SamplingProfiler.hpp"
+#include "backend/Tracing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr long kDefaultProfileSeconds = 10;
+constexpr long kMaxProfileSeconds = 60;
+constexpr long kMaxProfileHz = 1000;
+constexpr long kDefaultTraceMs = 1000;
+constexpr long kMaxTraceMs = 10000;
+
+// Positive integer from a query value; fallback when absent, -1 when malformed.
+long parsePositive(const std::string& value, long fallback) {
+    if (value.empty()) {
+        return fallback;
+    }
+    char* endPtr = nullptr;
+    const long parsed = std::strtol(value.c_str(), &endPtr, 10);
+    if (!endPtr || *endPtr != '\0' || parsed <= 0) {
+        return -1;
+    }
+    return parsed;
+}
+
+// Upper bound of the bucket holding quantile q; the open last bucket
+// reports the observed maximum when known.
+std::uint64_t histogramQuantile(const backend::LockHistogram& buckets, double q, std::uint64_t maximum) {
+    std::uint64_t total = 0;
+    for (const std::uint64_t count : buckets) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const auto& bounds = backend::LockRegistry::bucketBoundsNanos();
+    const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        cumulative += buckets[i];
+        if (cumulative >= rank) {
+            return i < bounds.size() ? bounds[i] : std::max(maximum, bounds.back());
+        }
+    }
+    return bounds.back();
+}
+
+void appendHistogramJson(std::string& out, const backend::LockHistogram& buckets) {
+    out += '[';
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += std::to_string(buckets[i]);
+    }
+    out += ']';
+}
+
+}  // namespace
+
+namespace frontend {
+
+void WebServer::serveProfile(int clientSocket, const std::string& query) {
+    const long seconds = parsePositive(parseFormValue(query, "seconds"), kDefaultProfileSeconds);
+    const long hz = parsePositive(parseFormValue(query, "hz"), 99);
+    if (seconds < 0 || hz < 0) {
+        sendBadRequest(clientSocket, "seconds and hz must be positive integers.");
+        return;
+    }
+    if (!backend::SamplingProfiler::supported()) {
+        sendHttpResponse(clientSocket, "HTTP/1.1 501 Not Implemented",
+                         R"({"success":false,"error":"Profiling is not supported on this platform."})",
+                         "application/json");
+        return;
+    }
+
+    backend::ProfileOptions options;
+    options.duration = std::chrono::seconds(std::min(seconds, kMaxProfileSeconds));
+    options.frequencyHz = static_cast<int>(std::min(hz, kMaxProfileHz));
+    backend::Logger::instance().log("CPU profile started for " + std::to_string(options.duration.count() / 1000) +
+                                    "s at " + std::to_string(options.frequencyHz) + " Hz.");
+
+    backend::ProfileResult result;
+    std::string error;
+    if (!backend::SamplingProfiler::instance().profile(options, result, error)) {
+        backend::Logger::instance().log("CPU profile failed: " + error);
+        sendHttpResponse(clientSocket, "HTTP/1.1 503 Service Unavailable",
+                         R"({"success":false,"error":"Profiler busy or unavailable"})", "application/json",
+                         {{"Retry-After", std::to_string(options.duration.count() / 1000)}});
+        return;
+    }
+
+    backend::Logger::instance().log("CPU profile finished: " + std::to_string(result.samples) + " samples, " +
+                                    std::to_string(result.uniqueStacks) + " stacks, " +
+                                    std::to_string(result.dropped) + " dropped.");
+    sendHttpResponse(clientSocket, "HTTP/1.1 200 OK", result.folded, "text/plain; charset=utf-8",
+                     {{"X-Profile-Samples", std::to_string(result.samples)},
+                      {"X-Profile-Dropped", std::to_string(result.dropped)}});
+}
+
+void WebServer::serveTrace(int clientSocket, const std::string& query) {
+    const long ms = parsePositive(parseFormValue(query, "ms"), kDefaultTraceMs);
+    if (ms < 0) {
+        sendBadRequest(clientSocket, "ms must be a positive integer.");
+        return;
+    }
+    const std::chrono::milliseconds window(std::min(ms, kMaxTraceMs));
+    backend::Logger::instance().log("Request trace started for " + std::to_string(window.count()) + " ms.");
+    const std::string trace = backend::Tracer::instance().capture(window);
+    sendHttpResponse(clientSocket, "HTTP/1.1 200 OK", trace, "application/json");
+}
+
+std::string WebServer::buildLocksJson() const {
+    std::vector<backend::LockStatsSnapshot> locks = backend::LockRegistry::snapshot();
+    std::sort(locks.begin(), locks.end(), [](const auto& a, const auto& b) { return a.waitNanos > b.waitNanos; });
+
+    std::string out = R"({"bucketBoundsNs":[)";
+    const auto& bounds = backend::LockRegistry::bucketBoundsNanos();
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += std::to_string(bounds[i]);
+    }
+    out += R"(],"locks":[)";
+    for (std::size_t i = 0; i < locks.size(); ++i) {
+        const backend::LockStatsSnapshot& lock = locks[i];
+        if (i > 0) {
+            out += ',';
+        }
+        out += R"({"name":")" + lock.name + R"(","acquisitions":)" + std::to_string(lock.acquisitions) +
+               R"(,"contended":)" + std::to_string(lock.contended) + R"(,"wait":{"totalNs":)" +
+               std::to_string(lock.waitNanos) + R"(,"maxNs":)" + std::to_string(lock.maxWaitNanos) +
+               R"(,"p50Ns":)" + std::to_string(histogramQuantile(lock.waitBuckets, 0.50, lock.maxWaitNanos)) +
+               R"(,"p99Ns":)" + std::to_string(histogramQuantile(lock.waitBuckets, 0.99, lock.maxWaitNanos)) +
+               R"(,"histogram":)";
+        appendHistogramJson(out, lock.waitBuckets);
+        out += R"(},"hold":{"totalNs":)" + std::to_string(lock.holdNanos) + R"(,"p50Ns":)" +
+               std::to_string(histogramQuantile(lock.holdBuckets, 0.50, 0)) + R"(,"p99Ns":)" +
+               std::to_string(histogramQuantile(lock.holdBuckets, 0.99, 0)) + R"(,"histogram":)";
+        appendHistogramJson(out, lock.holdBuckets);
+        out += "}}";
+    }
+    out += "]}";
+    return out;
+}
+
+}  // namespace frontend
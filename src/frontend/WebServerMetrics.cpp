@@ -0,0 +1,243 @@
+// File: WebServerMetrics.cpp
+// Description: Prometheus text exposition for GET /metrics, separated from
+//              core WebServer routing.
+
+#include "frontend/WebServer.hpp"
+
+#include "backend/AllocationTracker.hpp"
+#include "backend/InstrumentedMutex.hpp"
+
+#include <cstdio>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+void appendMetric(std::string& out,
+                  const char* name,
+                  const char* type,
+                  const char* help,
+                  std::uint64_t value) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+    out += name;
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+void appendScopedMetric(std::string& out,
+                        const char* name,
+                        const char* help,
+                        const std::vector<backend::AllocationStats>& scopes,
+                        std::uint64_t backend::AllocationStats::*field) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " counter\n";
+    for (const backend::AllocationStats& scope : scopes) {
+        out += name;
+        out += "{scope=\"";
+        out += scope.scope;
+        out += "\"} ";
+        out += std::to_string(scope.*field);
+        out += '\n';
+    }
+}
+
+// Histogram on the lock bucket bounds, one series per row labelled
+// labelName=row.name (LockStatsSnapshot, PriorityClassStats).
+template <typename Row>
+void appendLockHistogram(std::string& out,
+                         const char* name,
+                         const char* help,
+                         const char* labelName,
+                         const std::vector<Row>& rows,
+                         backend::LockHistogram Row::*buckets,
+                         std::uint64_t Row::*sumNanos) {
+    const auto& bounds = backend::LockRegistry::bucketBoundsNanos();
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " histogram\n";
+    char number[32];
+    for (const Row& row : rows) {
+        const std::string label = std::string(labelName) + "=\"" + row.name + "\"";
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < backend::kLockHistogramBuckets; ++i) {
+            cumulative += (row.*buckets)[i];
+            if (i < bounds.size()) {
+                std::snprintf(number, sizeof(number), "%.9g", static_cast<double>(bounds[i]) / 1e9);
+            } else {
+                std::snprintf(number, sizeof(number), "+Inf");
+            }
+            out += name;
+            out += "_bucket{" + label + ",le=\"" + number + "\"} " + std::to_string(cumulative) + '\n';
+        }
+        std::snprintf(number, sizeof(number), "%.9f", static_cast<double>(row.*sumNanos) / 1e9);
+        out += name;
+        out += "_sum{" + label + "} " + number + '\n';
+        out += name;
+        out += "_count{" + label + "} " + std::to_string(cumulative) + '\n';
+    }
+}
+
+}  // namespace
+
+namespace frontend {
+
+std::string WebServer::buildMetricsText() const {
+    std::string out;
+    out.reserve(2048);
+
+    const ResponseCacheStats cache = m_duckAiCache.stats();
+    appendMetric(out, "duckai_cache_hits_total", "counter",
+                 "Duck AI prompts answered from the response cache.", cache.hits);
+    appendMetric(out, "duckai_cache_misses_total", "counter",
+                 "Duck AI prompts that required an upstream call.", cache.misses);
+    appendMetric(out, "duckai_cache_coalesced_total", "counter",
+                 "Duck AI prompts that waited on an identical in-flight upstream call.",
+                 cache.coalesced);
+    appendMetric(out, "duckai_cache_evictions_total", "counter",
+                 "Cache entries dropped to stay within the byte budget.", cache.evictions);
+    appendMetric(out, "duckai_cache_expirations_total", "counter",
+                 "Cache entries found past their TTL.", cache.expirations);
+    appendMetric(out, "duckai_cache_entries", "gauge", "Entries currently cached.", cache.entries);
+    appendMetric(out, "duckai_cache_bytes", "gauge", "Bytes currently charged to the cache.",
+                 cache.bytes);
+
+    const UpstreamClientStats upstream = m_upstreamClient.stats();
+    appendMetric(out, "upstream_requests_active", "gauge", "Upstream transfers in progress.",
+                 upstream.active);
+    appendMetric(out, "upstream_requests_queued", "gauge",
+                 "Upstream requests waiting for a concurrency slot.", upstream.queued);
+    appendMetric(out, "upstream_requests_completed_total", "counter",
+                 "Upstream transfers that finished at the HTTP level.", upstream.completed);
+    appendMetric(out, "upstream_requests_failed_total", "counter",
+                 "Upstream transfers that failed (connect, timeout, abort).", upstream.failed);
+    appendMetric(out, "upstream_requests_rejected_total", "counter",
+                 "Upstream requests refused because the queue was full.", upstream.rejected);
+    appendMetric(out, "upstream_connections_reused_total", "counter",
+                 "Upstream transfers served over a cached connection.", upstream.reusedConnections);
+
+    const UpstreamGuardStats guard = m_duckAiGuard.stats();
+    appendMetric(out, "duckai_circuit_state", "gauge", "Circuit breaker state (0 closed, 1 open, 2 half-open).",
+                 static_cast<std::uint64_t>(guard.state));
+    appendMetric(out, "duckai_circuit_opened_total", "counter", "Times the circuit breaker opened.",
+                 guard.circuitOpened);
+    appendMetric(out, "duckai_bulkhead_in_flight", "gauge", "Server threads currently inside upstream calls.",
+                 guard.inFlight);
+    appendMetric(out, "duckai_bulkhead_rejected_total", "counter",
+                 "Duck AI calls refused because the bulkhead was full.", guard.rejectedBulkhead);
+    appendMetric(out, "duckai_circuit_rejected_total", "counter",
+                 "Duck AI calls failed fast while the circuit was open.", guard.rejectedOpen);
+    appendMetric(out, "duckai_upstream_successes_total", "counter",
+                 "Upstream calls that counted as healthy.", guard.successes);
+    appendMetric(out, "duckai_upstream_failures_total", "counter",
+                 "Upstream calls that failed, timed out or returned 429/5xx.", guard.failures);
+    appendMetric(out, "duckai_upstream_timeouts_total", "counter",
+                 "Upstream calls cut off by the adaptive timeout.", guard.timeouts);
+    appendMetric(out, "duckai_timeout_completion_ms", "gauge",
+                 "Current adaptive timeout for buffered completions.",
+                 static_cast<std::uint64_t>(guard.completionTimeoutMs));
+    appendMetric(out, "duckai_timeout_first_byte_ms", "gauge",
+                 "Current adaptive first-byte timeout for streamed completions.",
+                 static_cast<std::uint64_t>(guard.firstByteTimeoutMs));
+
+    const OutputQueueStats output = OutputQueue::stats();
+    appendMetric(out, "http_output_bytes_total", "counter", "Response bytes written to client sockets.",
+                 output.bytesSent);
+    appendMetric(out, "http_output_would_block_total", "counter",
+                 "Response writes that found the client's socket buffer full.", output.wouldBlock);
+    appendMetric(out, "http_output_backpressure_pauses_total", "counter",
+                 "Times a response producer was paused at the output high-water mark.",
+                 output.backpressurePauses);
+    appendMetric(out, "http_output_send_timeouts_total", "counter",
+                 "Connections dropped because the client stopped reading.", output.sendTimeouts);
+
+    const SpectatorHubStats spectators = m_spectators.stats();
+    appendMetric(out, "spectator_subscribers", "gauge", "Open GET /spectate event streams.",
+                 static_cast<std::uint64_t>(spectators.subscribers));
+    appendMetric(out, "spectator_frames_published_total", "counter",
+                 "World updates serialized once and broadcast to spectators.", spectators.published);
+    appendMetric(out, "spectator_frames_coalesced_total", "counter",
+                 "Pending spectator frames replaced by a newer one before being sent.", spectators.coalesced);
+    appendMetric(out, "spectator_dropped_total", "counter",
+                 "Spectators disconnected or dropped for not reading.", spectators.dropped);
+    appendMetric(out, "spectator_bytes_total", "counter", "Bytes written to spectator streams.",
+                 spectators.bytesSent);
+
+    const std::vector<backend::LockStatsSnapshot> locks = backend::LockRegistry::snapshot();
+    out += "# HELP lock_acquisitions_total Acquisitions per named lock.\n# TYPE lock_acquisitions_total counter\n";
+    for (const backend::LockStatsSnapshot& lock : locks) {
+        out += "lock_acquisitions_total{lock=\"" + lock.name + "\"} " + std::to_string(lock.acquisitions) + '\n';
+    }
+    out += "# HELP lock_contended_total Acquisitions that had to wait.\n# TYPE lock_contended_total counter\n";
+    for (const backend::LockStatsSnapshot& lock : locks) {
+        out += "lock_contended_total{lock=\"" + lock.name + "\"} " + std::to_string(lock.contended) + '\n';
+    }
+    appendLockHistogram(out, "lock_wait_seconds", "Time spent blocked in contended acquisitions.", "lock", locks,
+                        &backend::LockStatsSnapshot::waitBuckets, &backend::LockStatsSnapshot::waitNanos);
+    appendLockHistogram(out, "lock_hold_seconds", "Time each lock was held.", "lock", locks,
+                        &backend::LockStatsSnapshot::holdBuckets, &backend::LockStatsSnapshot::holdNanos);
+
+    const std::vector<PriorityClassStats> classes = m_scheduler.stats();
+    const struct {
+        const char* name;
+        const char* type;
+        const char* help;
+        std::uint64_t (*value)(const PriorityClassStats&);
+    } schedulerMetrics[] = {
+        {"sched_queue_depth", "gauge", "Requests waiting for a worker slot.",
+         [](const PriorityClassStats& c) { return static_cast<std::uint64_t>(c.queued); }},
+        {"sched_running", "gauge", "Handlers currently holding a worker slot.",
+         [](const PriorityClassStats& c) { return static_cast<std::uint64_t>(c.running); }},
+        {"sched_admitted_total", "counter", "Requests granted a worker slot.",
+         [](const PriorityClassStats& c) { return c.admitted; }},
+        {"sched_rejected_total", "counter", "Requests answered 503 because the class queue was full.",
+         [](const PriorityClassStats& c) { return c.rejected; }},
+        {"sched_promoted_total", "counter", "Admissions moved ahead of policy order after waiting too long.",
+         [](const PriorityClassStats& c) { return c.promoted; }},
+    };
+    for (const auto& metric : schedulerMetrics) {
+        out += std::string("# HELP ") + metric.name + ' ' + metric.help + "\n# TYPE " + metric.name + ' ' +
+               metric.type + '\n';
+        for (const PriorityClassStats& priorityClass : classes) {
+            out += std::string(metric.name) + "{class=\"" + priorityClass.name + "\"} " +
+                   std::to_string(metric.value(priorityClass)) + '\n';
+        }
+    }
+    appendLockHistogram(out, "sched_wait_seconds", "Time requests waited for a worker slot.", "class", classes,
+                        &PriorityClassStats::waitBuckets, &PriorityClassStats::waitNanos);
+
+    // Only WITH_ALLOC_TRACKING builds count allocations.
+    if (backend::AllocationTracker::enabled()) {
+        const std::vector<backend::AllocationStats> scopes = backend::AllocationTracker::snapshot();
+        appendScopedMetric(out, "heap_allocations_total", "Heap allocations by scope.", scopes,
+                           &backend::AllocationStats::allocations);
+        appendScopedMetric(out, "heap_allocated_bytes_total", "Heap bytes allocated by scope.", scopes,
+                           &backend::AllocationStats::allocatedBytes);
+        appendScopedMetric(out, "heap_frees_total", "Heap frees by the scope active at release.", scopes,
+                           &backend::AllocationStats::frees);
+        appendScopedMetric(out, "heap_freed_bytes_total", "Heap bytes freed by the scope active at release.",
+                           scopes, &backend::AllocationStats::freedBytes);
+    }
+    return out;
+}
+
+}  // namespace frontend
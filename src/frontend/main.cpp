@@ -46,6 +46,24 @@ int resolvePort(int argc, char* argv[]) {
     return sanitizePort(port);
 }
 
+// Non-negative integer from the environment; for the timed features 0
+// turns the feature off.
+int readNonNegativeEnv(const char* name, int fallback) {
+    const char* value = std::getenv(name);
+    if (!value) {
+        return fallback;
+    }
+    try {
+        const int parsed = std::stoi(value);
+        if (parsed >= 0) {
+            return parsed;
+        }
+    } catch (...) {
+    }
+    std::cerr << "Invalid " << name << " value; using " << fallback << ".\n";
+    return fallback;
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -57,6 +75,8 @@ int main(int argc, char* argv[]) {
     config.worldHeight = 20;
     config.initialEnvelopeCount = 12;
     config.timeLimitSeconds = 60;
+    config.envelopeLifetimeSeconds = readNonNegativeEnv("TANK_ENVELOPE_TTL", config.envelopeLifetimeSeconds);
+    config.rainIntervalSeconds = readNonNegativeEnv("TANK_RAIN_INTERVAL", config.rainIntervalSeconds);
 
     backend::GameEngine engine(config);
     const auto seed =
@@ -65,11 +85,34 @@ int main(int argc, char* argv[]) {
     engine.reset();
     backend::Logger::instance().log("Engine seeded with value " + std::to_string(seed) + ".");
 
+    // Local consumers read the game from shared memory instead of polling
+    // /state; see include/backend/SharedState.hpp.
+    if (const char* shmName = std::getenv("TANK_SHM_NAME")) {
+        const int capacity = readNonNegativeEnv("TANK_SHM_ENVELOPES", 4096);
+        try {
+            engine.exportSharedState(shmName, static_cast<std::size_t>(capacity));
+            backend::Logger::instance().log(std::string("Exporting game state to shared memory ") + shmName + ".");
+        } catch (const std::exception& ex) {
+            backend::Logger::instance().log(std::string("Shared state export disabled: ") + ex.what());
+        }
+    }
+
     const int port = resolvePort(argc, argv);
     backend::Logger::instance().log("Resolved HTTP port " + std::to_string(port) + ".");
     try {
-        frontend::LayoutManager layoutManager;
-        layoutManager.initialize();
+        frontend::LayoutStoreOptions layoutOptions;
+        if (const char* layoutDir = std::getenv("TANK_LAYOUT_DIR")) {
+            layoutOptions.directory = layoutDir;
+        }
+        frontend::LayoutManager layoutManager(layoutOptions);
+        // Like attendance storage, a broken layout store must not keep the
+        // game from starting.
+        try {
+            layoutManager.initialize();
+        } catch (const std::exception& ex) {
+            backend::Logger::instance().log(std::string("Layout store unavailable, keeping preferences in memory only: ") +
+                                            ex.what());
+        }
         frontend::WebServer server(engine, layoutManager, "web", port);
         backend::Logger::instance().log("Starting web server event loop.");
         server.run();
@@ -0,0 +1,643 @@
+// File: attendance_bench.cpp
+// Description: Load generator and fault-injection harness for
+//              AttendanceRepository implementations. Drives a configurable
+//              operation mix from N threads, optionally through a local TCP
+//              proxy that injects latency and disconnects, and reports
+//              throughput plus latency percentiles per operation (and heap
+//              allocations per operation in WITH_ALLOC_TRACKING builds).
+
+#include "backend/AllocationTracker.hpp"
+#include "backend/Attendance.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Operation { Find, Page, List, Stream, Mark };
+constexpr std::size_t kOperationCount = 5;
+
+const char* operationName(Operation op) {
+    switch (op) {
+        case Operation::Find:
+            return "find";
+        case Operation::Page:
+            return "page";
+        case Operation::List:
+            return "list";
+        case Operation::Stream:
+            return "stream";
+        case Operation::Mark:
+            return "mark";
+    }
+    return "unknown";
+}
+
+struct BenchOptions {
+    std::string backend{"memory"};
+    int threads{4};
+    int connections{1};
+    double durationSeconds{5.0};
+    std::string mix{"find=50,page=20,list=5,stream=5,mark=20"};
+    int pageSize{20};
+    // Fault injection.
+    int latencyMs{0};
+    int jitterMs{0};
+    int disconnectEveryMs{0};
+    unsigned int dbTimeoutSeconds{5};
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: attendance_bench [--backend=memory|mysql] [--threads=N] [--connections=N]\n"
+           "                        [--duration=SECONDS] [--mix=find=50,page=20,list=5,stream=5,mark=20]\n"
+           "                        [--page-size=N] [--latency-ms=N] [--jitter-ms=N]\n"
+           "                        [--disconnect-every-ms=N] [--db-timeout=SECONDS]\n"
+           "\n"
+           "mysql uses the ATTENDANCE_DB_* environment variables. When latency or\n"
+           "disconnects are requested it connects through a local TCP proxy that\n"
+           "delays forwarded traffic and periodically severs every proxied\n"
+           "connection. For the in-memory backend the same faults are injected by\n"
+           "a repository decorator instead.\n";
+}
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "backend") {
+            options.backend = value;
+        } else if (key == "threads") {
+            options.threads = std::max(1, std::stoi(value));
+        } else if (key == "connections") {
+            options.connections = std::max(1, std::stoi(value));
+        } else if (key == "duration") {
+            options.durationSeconds = std::max(0.1, std::stod(value));
+        } else if (key == "mix") {
+            options.mix = value;
+        } else if (key == "page-size") {
+            options.pageSize = std::max(1, std::stoi(value));
+        } else if (key == "latency-ms") {
+            options.latencyMs = std::max(0, std::stoi(value));
+        } else if (key == "jitter-ms") {
+            options.jitterMs = std::max(0, std::stoi(value));
+        } else if (key == "disconnect-every-ms") {
+            options.disconnectEveryMs = std::max(0, std::stoi(value));
+        } else if (key == "db-timeout") {
+            options.dbTimeoutSeconds = static_cast<unsigned int>(std::max(1, std::stoi(value)));
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    return options;
+}
+
+std::vector<double> parseMix(const std::string& mix) {
+    std::vector<double> weights(kOperationCount, 0.0);
+    std::istringstream stream(mix);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        const std::size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Invalid mix entry: " + token);
+        }
+        const std::string name = token.substr(0, eq);
+        const double weight = std::max(0.0, std::stod(token.substr(eq + 1)));
+        bool matched = false;
+        for (std::size_t i = 0; i < kOperationCount; ++i) {
+            if (name == operationName(static_cast<Operation>(i))) {
+                weights[i] = weight;
+                matched = true;
+            }
+        }
+        if (!matched) {
+            throw std::invalid_argument("Unknown operation in mix: " + name);
+        }
+    }
+    return weights;
+}
+
+int sleepWithJitter(int latencyMs, int jitterMs, std::mt19937& rng) {
+    int delay = latencyMs;
+    if (jitterMs > 0) {
+        std::uniform_int_distribution<int> dist(-jitterMs, jitterMs);
+        delay = std::max(0, delay + dist(rng));
+    }
+    if (delay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    }
+    return delay;
+}
+
+// Stand-in for a flaky network path between the repository and MySQL:
+// forwards bytes to the real server, delaying each forwarded read and
+// periodically severing every live connection.
+class FaultProxy {
+public:
+    FaultProxy(std::string upstreamHost, unsigned int upstreamPort, const BenchOptions& options)
+        : m_upstreamHost(std::move(upstreamHost)),
+          m_upstreamPort(upstreamPort),
+          m_latencyMs(options.latencyMs),
+          m_jitterMs(options.jitterMs),
+          m_disconnectEveryMs(options.disconnectEveryMs) {
+        m_listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listenSocket < 0) {
+            throw std::runtime_error("Proxy: failed to create socket.");
+        }
+        int opt = 1;
+        setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(m_listenSocket, 64) != 0) {
+            ::close(m_listenSocket);
+            throw std::runtime_error("Proxy: failed to bind loopback listener.");
+        }
+        socklen_t len = sizeof(address);
+        getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&address), &len);
+        m_port = ntohs(address.sin_port);
+
+        m_acceptThread = std::thread(&FaultProxy::acceptLoop, this);
+        if (m_disconnectEveryMs > 0) {
+            m_chaosThread = std::thread(&FaultProxy::chaosLoop, this);
+        }
+    }
+
+    ~FaultProxy() {
+        m_stopping = true;
+        ::shutdown(m_listenSocket, SHUT_RDWR);
+        ::close(m_listenSocket);
+        if (m_acceptThread.joinable()) {
+            m_acceptThread.join();
+        }
+        if (m_chaosThread.joinable()) {
+            m_chaosThread.join();
+        }
+        severAll();
+        for (auto& worker : m_pumps) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    unsigned int port() const noexcept {
+        return m_port;
+    }
+
+    std::uint64_t disconnectsInjected() const noexcept {
+        return m_disconnects.load();
+    }
+
+private:
+    void acceptLoop() {
+        while (!m_stopping) {
+            const int client = accept(m_listenSocket, nullptr, nullptr);
+            if (client < 0) {
+                if (m_stopping) {
+                    return;
+                }
+                continue;
+            }
+            const int upstream = connectUpstream();
+            if (upstream < 0) {
+                ::close(client);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_live.push_back({client, upstream});
+            m_pumps.emplace_back(&FaultProxy::pump, this, client, upstream);
+        }
+    }
+
+    int connectUpstream() const {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(m_upstreamPort));
+        const std::string host = m_upstreamHost == "localhost" ? "127.0.0.1" : m_upstreamHost;
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1 ||
+            connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void pump(int client, int upstream) {
+        std::mt19937 rng(static_cast<unsigned int>(client * 7919 + upstream));
+        std::vector<char> buffer(16 * 1024);
+        pollfd fds[2] = {{client, POLLIN, 0}, {upstream, POLLIN, 0}};
+        bool open = true;
+        while (open && !m_stopping) {
+            if (poll(fds, 2, 200) <= 0) {
+                continue;
+            }
+            for (int i = 0; i < 2 && open; ++i) {
+                if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                    continue;
+                }
+                const ssize_t n = recv(fds[i].fd, buffer.data(), buffer.size(), 0);
+                if (n <= 0) {
+                    open = false;
+                    break;
+                }
+                sleepWithJitter(m_latencyMs, m_jitterMs, rng);
+                const int target = fds[1 - i].fd;
+                ssize_t offset = 0;
+                while (offset < n) {
+                    const ssize_t sent = send(target, buffer.data() + offset,
+                                              static_cast<std::size_t>(n - offset), MSG_NOSIGNAL);
+                    if (sent <= 0) {
+                        open = false;
+                        break;
+                    }
+                    offset += sent;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_live.erase(std::remove_if(m_live.begin(), m_live.end(),
+                                    [&](const std::pair<int, int>& p) { return p.first == client; }),
+                     m_live.end());
+        ::close(client);
+        ::close(upstream);
+    }
+
+    void chaosLoop() {
+        auto next = Clock::now() + std::chrono::milliseconds(m_disconnectEveryMs);
+        while (!m_stopping) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            if (Clock::now() < next) {
+                continue;
+            }
+            next = Clock::now() + std::chrono::milliseconds(m_disconnectEveryMs);
+            severAll();
+        }
+    }
+
+    void severAll() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [client, upstream] : m_live) {
+            ::shutdown(client, SHUT_RDWR);
+            ::shutdown(upstream, SHUT_RDWR);
+            m_disconnects.fetch_add(1);
+        }
+    }
+
+    std::string m_upstreamHost;
+    unsigned int m_upstreamPort;
+    int m_latencyMs;
+    int m_jitterMs;
+    int m_disconnectEveryMs;
+    int m_listenSocket{-1};
+    unsigned int m_port{0};
+    std::atomic<bool> m_stopping{false};
+    std::atomic<std::uint64_t> m_disconnects{0};
+    std::mutex m_mutex;
+    std::vector<std::pair<int, int>> m_live;
+    std::vector<std::thread> m_pumps;
+    std::thread m_acceptThread;
+    std::thread m_chaosThread;
+};
+
+// Fault injection for repositories that never touch a socket: delays each
+// call and fails every call inside a short window after each "disconnect".
+class FaultInjectingRepository : public backend::AttendanceRepository {
+public:
+    FaultInjectingRepository(std::unique_ptr<backend::AttendanceRepository> inner,
+                             const BenchOptions& options)
+        : m_inner(std::move(inner)),
+          m_latencyMs(options.latencyMs),
+          m_jitterMs(options.jitterMs),
+          m_disconnectEveryMs(options.disconnectEveryMs),
+          m_start(Clock::now()) {}
+
+    std::vector<backend::Student> listStudents() override {
+        inject();
+        return m_inner->listStudents();
+    }
+
+    std::vector<backend::Student> listStudentsAfter(const std::string& afterId,
+                                                    std::size_t limit) override {
+        inject();
+        return m_inner->listStudentsAfter(afterId, limit);
+    }
+
+    bool forEachStudent(const std::function<bool(const backend::Student&)>& visitor) override {
+        inject();
+        return m_inner->forEachStudent(visitor);
+    }
+
+    std::optional<backend::Student> findStudentById(const std::string& studentId) override {
+        inject();
+        return m_inner->findStudentById(studentId);
+    }
+
+    bool markAttendance(const backend::AttendanceRecord& record) override {
+        inject();
+        return m_inner->markAttendance(record);
+    }
+
+private:
+    void inject() {
+        thread_local std::mt19937 rng(std::random_device{}());
+        sleepWithJitter(m_latencyMs, m_jitterMs, rng);
+        if (m_disconnectEveryMs <= 0) {
+            return;
+        }
+        // Treat the first 5% of every period as an outage.
+        const auto sinceStart =
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_start).count();
+        const auto phase = sinceStart % m_disconnectEveryMs;
+        if (phase < std::max<long long>(1, m_disconnectEveryMs / 20)) {
+            throw backend::AttendanceUnavailableError("Injected disconnect.");
+        }
+    }
+
+    std::unique_ptr<backend::AttendanceRepository> m_inner;
+    int m_latencyMs;
+    int m_jitterMs;
+    int m_disconnectEveryMs;
+    Clock::time_point m_start;
+};
+
+struct OperationSamples {
+    std::vector<std::uint32_t> latenciesUs;
+    std::uint64_t errors{0};
+};
+
+struct WorkerResult {
+    std::array<OperationSamples, kOperationCount> perOperation;
+};
+
+std::string todayIsoDate() {
+    const std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm {};
+    localtime_r(&t, &tm);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm);
+    return buffer;
+}
+
+void runWorker(backend::AttendanceRepository& repo,
+               const std::vector<std::string>& studentIds,
+               const std::vector<double>& weights,
+               const BenchOptions& options,
+               Clock::time_point deadline,
+               unsigned int seed,
+               WorkerResult& result) {
+    std::mt19937 rng(seed);
+    std::discrete_distribution<std::size_t> pickOperation(weights.begin(), weights.end());
+    std::uniform_int_distribution<std::size_t> pickStudent(0, studentIds.empty() ? 0 : studentIds.size() - 1);
+    const std::string today = todayIsoDate();
+
+    while (Clock::now() < deadline) {
+        const auto op = static_cast<Operation>(pickOperation(rng));
+        const std::string& studentId = studentIds.empty() ? today : studentIds[pickStudent(rng)];
+        OperationSamples& samples = result.perOperation[static_cast<std::size_t>(op)];
+
+        const auto start = Clock::now();
+        bool ok = true;
+        try {
+            backend::AllocationScope allocationScope(operationName(op));
+            switch (op) {
+                case Operation::Find:
+                    ok = repo.findStudentById(studentId).has_value();
+                    break;
+                case Operation::Page:
+                    repo.listStudentsAfter(studentId, static_cast<std::size_t>(options.pageSize));
+                    break;
+                case Operation::List:
+                    repo.listStudents();
+                    break;
+                case Operation::Stream: {
+                    std::size_t rows = 0;
+                    ok = repo.forEachStudent([&](const backend::Student&) {
+                        ++rows;
+                        return true;
+                    });
+                    break;
+                }
+                case Operation::Mark:
+                    ok = repo.markAttendance(
+                        backend::AttendanceRecord{studentId, today, backend::AttendanceStatus::Present});
+                    break;
+            }
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        const auto elapsedUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        samples.latenciesUs.push_back(static_cast<std::uint32_t>(
+            std::min<long long>(elapsedUs, std::numeric_limits<std::uint32_t>::max())));
+        if (!ok) {
+            ++samples.errors;
+        }
+    }
+}
+
+double percentileMs(const std::vector<std::uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t index =
+        std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+void printRow(const std::string& name,
+              std::vector<std::uint32_t>& latencies,
+              std::uint64_t errors,
+              double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::left << std::setw(8) << name << std::right
+              << std::setw(10) << latencies.size()
+              << std::setw(9) << errors
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << static_cast<double>(latencies.size()) / seconds
+              << std::setprecision(3)
+              << std::setw(10) << percentileMs(latencies, 0.50)
+              << std::setw(10) << percentileMs(latencies, 0.90)
+              << std::setw(10) << percentileMs(latencies, 0.99)
+              << std::setw(10) << percentileMs(latencies, 0.999)
+              << std::setw(10) << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::vector<double> weights;
+    try {
+        options = parseOptions(argc, argv);
+        weights = parseMix(options.mix);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        printUsage();
+        return 2;
+    }
+
+    const bool injectFaults = options.latencyMs > 0 || options.disconnectEveryMs > 0;
+    std::unique_ptr<FaultProxy> proxy;
+    std::vector<std::unique_ptr<backend::AttendanceRepository>> repos;
+    try {
+        if (options.backend == "memory") {
+            for (int i = 0; i < options.connections; ++i) {
+                std::unique_ptr<backend::AttendanceRepository> repo =
+                    backend::createInMemoryAttendanceRepository();
+                if (injectFaults) {
+                    repo = std::make_unique<FaultInjectingRepository>(std::move(repo), options);
+                }
+                repos.push_back(std::move(repo));
+            }
+        } else if (options.backend == "mysql") {
+            backend::MySqlConnectionOptions db = backend::MySqlConnectionOptions::fromEnvironment();
+            db.exitOnDisconnect = false;
+            db.connectTimeoutSeconds = options.dbTimeoutSeconds;
+            db.readTimeoutSeconds = options.dbTimeoutSeconds;
+            db.writeTimeoutSeconds = options.dbTimeoutSeconds;
+            if (injectFaults) {
+                proxy = std::make_unique<FaultProxy>(db.host, db.port, options);
+                db.host = "127.0.0.1";
+                db.port = proxy->port();
+            }
+            for (int i = 0; i < options.connections; ++i) {
+                repos.push_back(backend::createMySqlAttendanceRepository(db));
+            }
+        } else {
+            std::cerr << "Unsupported backend '" << options.backend << "'.\n";
+            return 2;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to create repository: " << ex.what() << "\n";
+        return 1;
+    }
+
+    std::vector<std::string> studentIds;
+    for (int attempt = 0; attempt < 5 && studentIds.empty(); ++attempt) {
+        try {
+            for (const backend::Student& s : repos.front()->listStudents()) {
+                studentIds.push_back(s.studentId);
+            }
+            break;
+        } catch (const std::exception&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    std::cout << "backend=" << options.backend << " threads=" << options.threads
+              << " connections=" << options.connections << " duration=" << options.durationSeconds
+              << "s students=" << studentIds.size() << " latency=" << options.latencyMs << "ms±"
+              << options.jitterMs << " disconnectEvery=" << options.disconnectEveryMs << "ms\n";
+
+    std::vector<WorkerResult> results(static_cast<std::size_t>(options.threads));
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    const auto deadline =
+        start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(options.durationSeconds));
+    for (int i = 0; i < options.threads; ++i) {
+        backend::AttendanceRepository& repo = *repos[static_cast<std::size_t>(i) % repos.size()];
+        workers.emplace_back(runWorker, std::ref(repo), std::cref(studentIds), std::cref(weights),
+                             std::cref(options), deadline, static_cast<unsigned int>(1234 + i),
+                             std::ref(results[static_cast<std::size_t>(i)]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << std::left << std::setw(8) << "op" << std::right << std::setw(10) << "count"
+              << std::setw(9) << "errors" << std::setw(12) << "ops/s" << std::setw(10) << "p50ms"
+              << std::setw(10) << "p90ms" << std::setw(10) << "p99ms" << std::setw(10) << "p999ms"
+              << std::setw(10) << "maxms" << "\n";
+
+    std::vector<std::uint32_t> all;
+    std::uint64_t allErrors = 0;
+    std::vector<std::size_t> operationCounts(kOperationCount, 0);
+    for (std::size_t op = 0; op < kOperationCount; ++op) {
+        std::vector<std::uint32_t> merged;
+        std::uint64_t errors = 0;
+        for (WorkerResult& result : results) {
+            auto& samples = result.perOperation[op];
+            merged.insert(merged.end(), samples.latenciesUs.begin(), samples.latenciesUs.end());
+            errors += samples.errors;
+        }
+        if (merged.empty()) {
+            continue;
+        }
+        operationCounts[op] = merged.size();
+        all.insert(all.end(), merged.begin(), merged.end());
+        allErrors += errors;
+        printRow(operationName(static_cast<Operation>(op)), merged, errors, seconds);
+    }
+    printRow("total", all, allErrors, seconds);
+    if (proxy) {
+        std::cout << "proxy disconnects injected: " << proxy->disconnectsInjected() << "\n";
+    }
+    if (backend::AllocationTracker::enabled()) {
+        const std::vector<backend::AllocationStats> scopes = backend::AllocationTracker::snapshot();
+        std::cout << std::left << std::setw(8) << "op" << std::right << std::setw(14) << "allocs/op"
+                  << std::setw(14) << "bytes/op" << "\n";
+        for (std::size_t op = 0; op < kOperationCount; ++op) {
+            const char* name = operationName(static_cast<Operation>(op));
+            for (const backend::AllocationStats& scope : scopes) {
+                if (operationCounts[op] > 0 && std::string(scope.scope) == name) {
+                    const double count = static_cast<double>(operationCounts[op]);
+                    std::cout << std::left << std::setw(8) << name << std::right << std::setprecision(1)
+                              << std::setw(14) << static_cast<double>(scope.allocations) / count << std::setw(14)
+                              << static_cast<double>(scope.allocatedBytes) / count << "\n";
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,379 @@
+// File: duckai_bench.cpp
+// Description: Concurrent chat load generator for the /duckai endpoint.
+//              Runs N simulated students sending prompts (buffered or
+//              streamed), reports end-to-end and time-to-first-token
+//              latency percentiles, samples the server's thread count and
+//              prints the server's Duck AI (and, for WITH_ALLOC_TRACKING
+//              builds, heap allocation) metrics afterwards.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    std::string host{"127.0.0.1"};
+    int port{8080};
+    int concurrency{16};
+    double durationSeconds{10.0};
+    bool stream{false};
+    // 0 makes every prompt unique (no cache hits); K cycles through K prompts.
+    int prompts{0};
+    int serverPid{0};
+    int timeoutMs{30000};
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: duckai_bench [--host=ADDR] [--port=N] [--concurrency=N] [--duration=SECONDS]\n"
+           "                    [--stream=0|1] [--prompts=K] [--server-pid=PID] [--timeout-ms=N]\n"
+           "\n"
+           "Typical run against the local mock upstream:\n"
+           "  bin/mock_llm_server --latency=lognormal:300:0.4 &\n"
+           "  DUCKAI_UPSTREAM_URL=http://127.0.0.1:18099/v1/chat/completions OPENAI_API_KEY=mock \\\n"
+           "    bin/tank_red_envelope 8080 &\n"
+           "  bin/duckai_bench --concurrency=32 --server-pid=$!\n"
+           "\n"
+           "--prompts=K makes the workers share K distinct prompts so the response\n"
+           "cache and request coalescing come into play; the default sends unique\n"
+           "prompts. --server-pid samples the server's thread count (Linux /proc).\n";
+}
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "host") {
+            options.host = value;
+        } else if (key == "port") {
+            options.port = std::stoi(value);
+        } else if (key == "concurrency") {
+            options.concurrency = std::max(1, std::stoi(value));
+        } else if (key == "duration") {
+            options.durationSeconds = std::max(0.1, std::stod(value));
+        } else if (key == "stream") {
+            options.stream = value == "1" || value == "true";
+        } else if (key == "prompts") {
+            options.prompts = std::max(0, std::stoi(value));
+        } else if (key == "server-pid") {
+            options.serverPid = std::stoi(value);
+        } else if (key == "timeout-ms") {
+            options.timeoutMs = std::max(1, std::stoi(value));
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    return options;
+}
+
+struct HttpResult {
+    bool transportOk{false};
+    int status{0};
+    std::chrono::microseconds firstByte{0};  // first body byte (first delta when streaming)
+    std::chrono::microseconds total{0};
+    std::string body;
+};
+
+int connectTo(const BenchOptions& options) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    timeval timeout {};
+    timeout.tv_sec = options.timeoutMs / 1000;
+    timeout.tv_usec = (options.timeoutMs % 1000) * 1000;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+    if (::inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1 ||
+        ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// The server answers with Connection: close, so the response ends at EOF.
+HttpResult request(const BenchOptions& options, const std::string& method, const std::string& path,
+                   const std::string& body) {
+    HttpResult result;
+    const auto start = Clock::now();
+    const int fd = connectTo(options);
+    if (fd < 0) {
+        return result;
+    }
+    const std::string head = method + " " + path + " HTTP/1.1\r\nHost: " + options.host +
+                             "\r\nContent-Type: application/json\r\nContent-Length: " +
+                             std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    const std::string payload = head + body;
+    if (::send(fd, payload.data(), payload.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(payload.size())) {
+        ::close(fd);
+        return result;
+    }
+
+    std::string response;
+    std::size_t headerEnd = std::string::npos;
+    bool sawFirst = false;
+    char buffer[16384];
+    while (true) {
+        const ssize_t got = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (got < 0) {
+            ::close(fd);
+            return result;  // timeout or reset
+        }
+        if (got == 0) {
+            break;
+        }
+        response.append(buffer, static_cast<std::size_t>(got));
+        if (headerEnd == std::string::npos) {
+            headerEnd = response.find("\r\n\r\n");
+        }
+        if (!sawFirst && headerEnd != std::string::npos) {
+            // Streams count from the first delta, buffered answers from the first body byte.
+            const bool ready = options.stream ? response.find("data: ", headerEnd) != std::string::npos
+                                              : response.size() > headerEnd + 4;
+            if (ready) {
+                sawFirst = true;
+                result.firstByte =
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+            }
+        }
+    }
+    ::close(fd);
+    result.total = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    if (response.rfind("HTTP/1.", 0) != 0 || headerEnd == std::string::npos) {
+        return result;
+    }
+    result.transportOk = true;
+    result.status = std::atoi(response.c_str() + 9);
+    result.body = response.substr(headerEnd + 4);
+    if (!sawFirst) {
+        result.firstByte = result.total;
+    }
+    return result;
+}
+
+struct WorkerResult {
+    std::vector<std::uint32_t> totalUs;
+    std::vector<std::uint32_t> firstByteUs;
+    std::map<int, std::uint64_t> statuses;  // 0 = transport failure
+};
+
+std::uint32_t clampUs(std::chrono::microseconds value) {
+    return static_cast<std::uint32_t>(
+        std::min<long long>(value.count(), std::numeric_limits<std::uint32_t>::max()));
+}
+
+void runWorker(const BenchOptions& options, int worker, Clock::time_point deadline, WorkerResult& out) {
+    std::mt19937 rng(static_cast<unsigned int>(1000 + worker));
+    std::uint64_t sequence = 0;
+    while (Clock::now() < deadline) {
+        std::string prompt;
+        if (options.prompts > 0) {
+            prompt = "Bench prompt #" + std::to_string(rng() % static_cast<unsigned int>(options.prompts));
+        } else {
+            prompt = "Bench prompt w" + std::to_string(worker) + "-" + std::to_string(sequence++);
+        }
+        const std::string body = R"({"message":")" + prompt + R"(","stream":)" +
+                                 (options.stream ? "true" : "false") + "}";
+        const HttpResult result = request(options, "POST", "/duckai", body);
+        const int status = result.transportOk ? result.status : 0;
+        ++out.statuses[status];
+        if (status == 200) {
+            out.totalUs.push_back(clampUs(result.total));
+            out.firstByteUs.push_back(clampUs(result.firstByte));
+        }
+    }
+}
+
+// Samples Threads: from /proc/<pid>/status until stopped.
+class ThreadSampler {
+public:
+    explicit ThreadSampler(int pid) : m_pid(pid) {
+        if (m_pid > 0) {
+            m_thread = std::thread([this] { run(); });
+        }
+    }
+
+    ~ThreadSampler() { stop(); }
+
+    void stop() {
+        m_stop.store(true);
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    bool available() const { return m_samples > 0; }
+    int minimum() const { return m_min; }
+    int maximum() const { return m_max; }
+    double average() const { return m_samples > 0 ? static_cast<double>(m_sum) / m_samples : 0.0; }
+
+private:
+    void run() {
+        const std::string path = "/proc/" + std::to_string(m_pid) + "/status";
+        while (!m_stop.load()) {
+            std::ifstream status(path);
+            std::string line;
+            while (std::getline(status, line)) {
+                if (line.rfind("Threads:", 0) == 0) {
+                    const int threads = std::atoi(line.c_str() + 8);
+                    m_min = m_samples == 0 ? threads : std::min(m_min, threads);
+                    m_max = std::max(m_max, threads);
+                    m_sum += threads;
+                    ++m_samples;
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    int m_pid;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+    int m_min{0};
+    int m_max{0};
+    long long m_sum{0};
+    long long m_samples{0};
+};
+
+double percentileMs(const std::vector<std::uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t index =
+        std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+void printRow(const std::string& name, std::vector<std::uint32_t>& latencies, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::left << std::setw(8) << name << std::right
+              << std::setw(10) << latencies.size()
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << static_cast<double>(latencies.size()) / seconds
+              << std::setprecision(3)
+              << std::setw(10) << percentileMs(latencies, 0.50)
+              << std::setw(10) << percentileMs(latencies, 0.90)
+              << std::setw(10) << percentileMs(latencies, 0.99)
+              << std::setw(10) << percentileMs(latencies, 0.999)
+              << std::setw(10) << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        printUsage();
+        return 2;
+    }
+
+    std::cout << "target=" << options.host << ":" << options.port << " concurrency=" << options.concurrency
+              << " duration=" << options.durationSeconds << "s stream=" << (options.stream ? 1 : 0)
+              << " prompts=" << (options.prompts > 0 ? std::to_string(options.prompts) : "unique") << "\n";
+
+    ThreadSampler sampler(options.serverPid);
+    std::vector<WorkerResult> results(static_cast<std::size_t>(options.concurrency));
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(options.durationSeconds));
+    for (int i = 0; i < options.concurrency; ++i) {
+        workers.emplace_back(runWorker, std::cref(options), i, deadline,
+                             std::ref(results[static_cast<std::size_t>(i)]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    sampler.stop();
+
+    std::vector<std::uint32_t> totals;
+    std::vector<std::uint32_t> firstBytes;
+    std::map<int, std::uint64_t> statuses;
+    for (WorkerResult& result : results) {
+        totals.insert(totals.end(), result.totalUs.begin(), result.totalUs.end());
+        firstBytes.insert(firstBytes.end(), result.firstByteUs.begin(), result.firstByteUs.end());
+        for (const auto& [status, count] : result.statuses) {
+            statuses[status] += count;
+        }
+    }
+
+    std::cout << std::left << std::setw(8) << "metric" << std::right << std::setw(10) << "count"
+              << std::setw(12) << "req/s" << std::setw(10) << "p50ms" << std::setw(10) << "p90ms"
+              << std::setw(10) << "p99ms" << std::setw(10) << "p999ms" << std::setw(10) << "maxms"
+              << "\n";
+    printRow(options.stream ? "ttft" : "ttfb", firstBytes, seconds);
+    printRow("total", totals, seconds);
+
+    std::cout << "status:";
+    for (const auto& [status, count] : statuses) {
+        std::cout << " " << (status == 0 ? std::string("failed") : std::to_string(status)) << "=" << count;
+    }
+    std::cout << "\n";
+
+    if (sampler.available()) {
+        std::cout << "server threads: min=" << sampler.minimum() << " avg=" << std::setprecision(1)
+                  << sampler.average() << " max=" << sampler.maximum() << "\n";
+    } else if (options.serverPid > 0) {
+        std::cout << "server threads: unavailable (no /proc/" << options.serverPid << "/status)\n";
+    }
+
+    const HttpResult metrics = request(options, "GET", "/metrics", "");
+    if (metrics.transportOk && metrics.status == 200) {
+        std::istringstream lines(metrics.body);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (!line.empty() && line[0] != '#' &&
+                (line.rfind("duckai_", 0) == 0 || line.rfind("upstream_", 0) == 0 ||
+                 line.rfind("heap_", 0) == 0)) {
+                std::cout << "  " << line << "\n";
+            }
+        }
+    }
+    return 0;
+}
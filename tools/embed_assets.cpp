@@ -0,0 +1,321 @@
+// File: embed_assets.cpp
+// Description: Build step that compiles the browser assets into the server.
+//              Walks each DIR=URL_PREFIX root and writes a C++ source with
+//              one constexpr byte array per file, its gzip variant when that
+//              is smaller, MIME type and content-hash ETag, plus a table
+//              sorted by URL path for frontend::AssetStore.
+//
+//              Every asset except HTML and CSS documents is also listed under
+//              a content-hashed path (/static/duck.3fa2c1d9e0.png) served as
+//              immutable, and references to those assets inside the
+//              documents are rewritten to the hashed paths, so a changed
+//              image gets a new URL and an unchanged one is never refetched.
+//
+//              embed_assets --output=build/generated/EmbeddedAssets.cpp web=/ static=/static/
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Hex digits of the content hash used in hashed paths.
+constexpr std::size_t kPathHashDigits = 10;
+
+struct Asset {
+    std::string urlPath;
+    std::string hashedPath;  // empty for documents
+    std::string source;
+    std::string contentType;
+    std::string data;
+    std::string gzip;
+    std::uint64_t hash{0};
+};
+
+std::uint64_t fnv1a64(const std::string& bytes) {
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char byte : bytes) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string contentTypeFor(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".html" || extension == ".htm") {
+        return "text/html; charset=utf-8";
+    }
+    if (extension == ".js") {
+        return "application/javascript";
+    }
+    if (extension == ".css") {
+        return "text/css";
+    }
+    if (extension == ".json") {
+        return "application/json";
+    }
+    if (extension == ".svg") {
+        return "image/svg+xml";
+    }
+    if (extension == ".png") {
+        return "image/png";
+    }
+    if (extension == ".jpg" || extension == ".jpeg") {
+        return "image/jpeg";
+    }
+    if (extension == ".gif") {
+        return "image/gif";
+    }
+    if (extension == ".webp") {
+        return "image/webp";
+    }
+    if (extension == ".ico") {
+        return "image/x-icon";
+    }
+    if (extension == ".txt") {
+        return "text/plain; charset=utf-8";
+    }
+    return "application/octet-stream";
+}
+
+// gzip (RFC 1952) at maximum compression; empty if zlib fails.
+std::string gzipCompress(const std::string& input) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    std::string output(deflateBound(&stream, static_cast<uLong>(input.size())) + 32, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    const int result = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END ? output : std::string();
+}
+
+void writeBytes(std::ostream& out, const std::string& name, const std::string& bytes) {
+    out << "alignas(16) constexpr unsigned char " << name << "[] = {";
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        if (i % 24 == 0) {
+            out << "\n    ";
+        }
+        out << static_cast<unsigned>(static_cast<unsigned char>(bytes[i])) << ',';
+    }
+    out << "\n};\n";
+}
+
+void collect(const fs::path& root, const std::string& urlPrefix, std::vector<Asset>& assets) {
+    for (auto it = fs::recursive_directory_iterator(root); it != fs::recursive_directory_iterator(); ++it) {
+        const std::string name = it->path().filename().string();
+        if (!name.empty() && name[0] == '.') {
+            // .DS_Store, editor swap files, hidden directories.
+            if (it->is_directory()) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        std::ifstream file(it->path(), std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        if (!file) {
+            throw std::runtime_error("cannot read " + it->path().string());
+        }
+
+        Asset asset;
+        asset.urlPath = urlPrefix + fs::relative(it->path(), root).generic_string();
+        asset.source = it->path().generic_string();
+        asset.contentType = contentTypeFor(it->path());
+        asset.data = contents.str();
+        assets.push_back(std::move(asset));
+    }
+}
+
+bool isDocument(const Asset& asset) {
+    return asset.contentType.rfind("text/html", 0) == 0 || asset.contentType == "text/css";
+}
+
+std::string hexHash(std::uint64_t hash, std::size_t digits) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return std::string(buffer, digits);
+}
+
+// "/static/duck.png" -> "/static/duck.<hash>.png"
+std::string hashedPathFor(const std::string& urlPath, std::uint64_t hash) {
+    const std::size_t slash = urlPath.rfind('/');
+    const std::size_t dot = urlPath.rfind('.');
+    const std::string tag = "." + hexHash(hash, kPathHashDigits);
+    if (dot == std::string::npos || dot < slash) {
+        return urlPath + tag;
+    }
+    return urlPath.substr(0, dot) + tag + urlPath.substr(dot);
+}
+
+bool isReferenceBoundary(char c) {
+    return c == '"' || c == '\'' || c == '(' || c == ')' || c == '=' || c == '?' || c == '#' ||
+           std::isspace(static_cast<unsigned char>(c));
+}
+
+// Replaces whole-path references such as src="/static/duck.png" or
+// url('/static/duck.png'); returns how many were rewritten.
+std::size_t rewriteReferences(std::string& document, const std::vector<Asset>& assets) {
+    std::size_t rewritten = 0;
+    for (const Asset& target : assets) {
+        if (target.hashedPath.empty()) {
+            continue;
+        }
+        std::size_t pos = 0;
+        while ((pos = document.find(target.urlPath, pos)) != std::string::npos) {
+            const std::size_t end = pos + target.urlPath.size();
+            const bool bounded = pos > 0 && isReferenceBoundary(document[pos - 1]) &&
+                                 end < document.size() && isReferenceBoundary(document[end]);
+            if (!bounded) {
+                pos = end;
+                continue;
+            }
+            document.replace(pos, target.urlPath.size(), target.hashedPath);
+            pos += target.hashedPath.size();
+            ++rewritten;
+        }
+    }
+    return rewritten;
+}
+
+// Hashes assets first so documents can point at their hashed paths, then
+// hashes and compresses the rewritten documents.
+void finalize(std::vector<Asset>& assets) {
+    for (Asset& asset : assets) {
+        if (!isDocument(asset)) {
+            asset.hash = fnv1a64(asset.data);
+            asset.hashedPath = hashedPathFor(asset.urlPath, asset.hash);
+        }
+    }
+    for (Asset& asset : assets) {
+        if (isDocument(asset)) {
+            const std::size_t rewritten = rewriteReferences(asset.data, assets);
+            if (rewritten > 0) {
+                std::cout << "embed_assets: " << asset.urlPath << ": " << rewritten
+                          << " references rewritten to hashed paths\n";
+            }
+            asset.hash = fnv1a64(asset.data);
+        }
+        // Only worth a second copy if it saves at least a tenth.
+        std::string gzip = gzipCompress(asset.data);
+        if (!gzip.empty() && gzip.size() * 10 < asset.data.size() * 9) {
+            asset.gzip = std::move(gzip);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    std::vector<Asset> assets;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.rfind("--output=", 0) == 0) {
+                output = arg.substr(9);
+                continue;
+            }
+            const std::size_t eq = arg.find('=');
+            if (eq == std::string::npos || arg.compare(eq + 1, 1, "/") != 0) {
+                throw std::runtime_error("expected DIR=/url/prefix/, got '" + arg + "'");
+            }
+            std::string prefix = arg.substr(eq + 1);
+            if (prefix.back() != '/') {
+                prefix += '/';
+            }
+            collect(arg.substr(0, eq), prefix, assets);
+        }
+        if (output.empty()) {
+            throw std::runtime_error("--output is required");
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "embed_assets: " << ex.what() << "\n";
+        return 1;
+    }
+
+    finalize(assets);
+
+    // One row per URL, plain and hashed, sorted by path.
+    struct Row {
+        std::string path;
+        std::size_t asset;
+        bool immutable;
+    };
+    std::vector<Row> rows;
+    for (std::size_t i = 0; i < assets.size(); ++i) {
+        rows.push_back(Row{assets[i].urlPath, i, false});
+        if (!assets[i].hashedPath.empty()) {
+            rows.push_back(Row{assets[i].hashedPath, i, true});
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.path < b.path; });
+    for (std::size_t i = 1; i < rows.size(); ++i) {
+        if (rows[i].path == rows[i - 1].path) {
+            std::cerr << "embed_assets: " << assets[rows[i].asset].source << " and "
+                      << assets[rows[i - 1].asset].source << " both map to " << rows[i].path << "\n";
+            return 1;
+        }
+    }
+
+    std::ostringstream out;
+    out << "// Generated by tools/embed_assets.cpp. Do not edit; rebuild instead.\n\n"
+           "#include \"frontend/AssetStore.hpp\"\n\nnamespace frontend {\n\nnamespace {\n\n";
+    std::size_t totalBytes = 0;
+    for (std::size_t i = 0; i < assets.size(); ++i) {
+        out << "// " << assets[i].source << '\n';
+        if (!assets[i].data.empty()) {
+            writeBytes(out, "kData" + std::to_string(i), assets[i].data);
+        }
+        if (!assets[i].gzip.empty()) {
+            writeBytes(out, "kGzip" + std::to_string(i), assets[i].gzip);
+        }
+        totalBytes += assets[i].data.size() + assets[i].gzip.size();
+    }
+    out << "\n}  // namespace\n\nconstexpr EmbeddedAsset kEmbeddedAssets[] = {\n";
+    for (const Row& row : rows) {
+        const Asset& asset = assets[row.asset];
+        const std::string index = std::to_string(row.asset);
+        out << "    {\"" << row.path << "\", \"" << asset.contentType << "\", \"" << hexHash(asset.hash, 16) << "\", "
+            << (asset.data.empty() ? "nullptr" : "kData" + index) << ", " << asset.data.size() << ", "
+            << (asset.gzip.empty() ? "nullptr" : "kGzip" + index) << ", " << asset.gzip.size() << ", "
+            << (row.immutable ? "true" : "false") << "},\n";
+    }
+    if (rows.empty()) {
+        out << "    {\"\", \"\", \"\", nullptr, 0, nullptr, 0, false},\n";
+    }
+    out << "};\n\nconstexpr std::size_t kEmbeddedAssetCount = " << rows.size() << ";\n\n}  // namespace frontend\n";
+
+    fs::create_directories(fs::path(output).parent_path());
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    file << out.str();
+    if (!file) {
+        std::cerr << "embed_assets: cannot write " << output << "\n";
+        return 1;
+    }
+    std::cout << "embed_assets: " << assets.size() << " assets, " << totalBytes << " bytes -> " << output << "\n";
+    return 0;
+}
@@ -0,0 +1,290 @@
+// File: json_bench.cpp
+// Description: Compares the on-demand JsonDocument (SSE2 and scalar
+//              structural indexing) with the key-scanning extractor that
+//              WebServer used before, on /duckai request bodies, upstream
+//              completions, streamed chunks and a large document, plus
+//              allocations per parse in WITH_ALLOC_TRACKING builds.
+
+#include "backend/AllocationTracker.hpp"
+#include "frontend/JsonDocument.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    double seconds{0.5};  // per scenario and implementation
+};
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "seconds") {
+            options.seconds = std::max(0.05, std::stod(value));
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    return options;
+}
+
+// The scanner WebServer used before JsonDocument: first "key" anywhere in
+// the text, string values only, no \u surrogate pairs. Copied verbatim.
+std::string legacyExtractStringField(const std::string& body, const std::string& key) {
+    const std::string quotedKey = "\"" + key + "\"";
+    std::size_t pos = body.find(quotedKey);
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos = body.find(':', pos + quotedKey.size());
+    if (pos == std::string::npos) {
+        return "";
+    }
+    ++pos;
+    while (pos < body.size() && std::isspace(static_cast<unsigned char>(body[pos]))) {
+        ++pos;
+    }
+    if (pos >= body.size() || body[pos] != '"') {
+        return "";
+    }
+    ++pos;
+    std::string output;
+    output.reserve(256);
+    while (pos < body.size()) {
+        const char ch = body[pos++];
+        if (ch == '"') {
+            return output;
+        }
+        if (ch != '\\') {
+            output.push_back(ch);
+            continue;
+        }
+        if (pos >= body.size()) {
+            return "";
+        }
+        const char esc = body[pos++];
+        switch (esc) {
+            case '"':
+            case '\\':
+            case '/':
+                output.push_back(esc);
+                break;
+            case 'b':
+                output.push_back('\b');
+                break;
+            case 'f':
+                output.push_back('\f');
+                break;
+            case 'n':
+                output.push_back('\n');
+                break;
+            case 'r':
+                output.push_back('\r');
+                break;
+            case 't':
+                output.push_back('\t');
+                break;
+            case 'u': {
+                // Best-effort: keep the escape sequence if parsing fails.
+                if (pos + 4 > body.size()) {
+                    output += "\\u";
+                    break;
+                }
+                const std::string hex = body.substr(pos, 4);
+                pos += 4;
+                char* endPtr = nullptr;
+                const long code = std::strtol(hex.c_str(), &endPtr, 16);
+                if (!endPtr || *endPtr != '\0' || code < 0 || code > 0x10FFFF) {
+                    output += "\\u" + hex;
+                    break;
+                }
+                const uint32_t u = static_cast<uint32_t>(code);
+                if (u <= 0x7F) {
+                    output.push_back(static_cast<char>(u));
+                } else if (u <= 0x7FF) {
+                    output.push_back(static_cast<char>(0xC0 | (u >> 6)));
+                    output.push_back(static_cast<char>(0x80 | (u & 0x3F)));
+                } else if (u <= 0xFFFF) {
+                    output.push_back(static_cast<char>(0xE0 | (u >> 12)));
+                    output.push_back(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
+                    output.push_back(static_cast<char>(0x80 | (u & 0x3F)));
+                } else {
+                    output.push_back(static_cast<char>(0xF0 | (u >> 18)));
+                    output.push_back(static_cast<char>(0x80 | ((u >> 12) & 0x3F)));
+                    output.push_back(static_cast<char>(0x80 | ((u >> 6) & 0x3F)));
+                    output.push_back(static_cast<char>(0x80 | (u & 0x3F)));
+                }
+                break;
+            }
+            default:
+                output.push_back(esc);
+                break;
+        }
+    }
+    return "";
+}
+
+std::string makeRequestBody() {
+    return R"({"model":"qwen-plus","systemPrompt":"You are the duck in a tank game. Answer briefly.",)"
+           R"("message":"How do I collect more red envelopes before the timer runs out?","stream":false})";
+}
+
+// Shaped like a real provider answer: metadata and a long, escaped reply.
+std::string makeCompletion(std::size_t replyBytes) {
+    std::string reply;
+    while (reply.size() < replyBytes) {
+        reply += R"(Move toward clusters first, then sweep the edges. \"Rain\" drops arrive in waves;\n)";
+        reply += R"(红包 are worth more near the centre. )";
+    }
+    return R"({"id":"chatcmpl-bench","object":"chat.completion","created":1760000000,"model":"qwen-plus",)"
+           R"("prompt_filter_results":[{"index":0,"content_filter":{"hate":{"filtered":false}}}],)"
+           R"("choices":[{"index":0,"message":{"role":"assistant","content":")" +
+           reply +
+           R"("},"finish_reason":"stop","logprobs":null}],)"
+           R"("usage":{"prompt_tokens":42,"completion_tokens":180,"total_tokens":222}})";
+}
+
+std::string makeStreamChunk() {
+    return R"({"id":"chatcmpl-bench","object":"chat.completion.chunk","created":1760000000,"model":"qwen-plus",)"
+           R"("choices":[{"index":0,"delta":{"content":"Move toward"},"finish_reason":null}]})";
+}
+
+struct Result {
+    double nsPerOp{0.0};
+    double megabytesPerSecond{0.0};
+    double allocationsPerOp{0.0};
+};
+
+Result measure(double seconds, std::size_t bytes, const std::function<std::size_t()>& op) {
+    // Short warm-up, then run in batches until the time budget is spent.
+    std::size_t sink = 0;
+    for (int i = 0; i < 100; ++i) {
+        sink += op();
+    }
+    std::uint64_t iterations = 0;
+    const std::uint64_t allocationsBefore = backend::AllocationTracker::threadTotals().allocations;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    auto now = start;
+    do {
+        for (int i = 0; i < 64; ++i) {
+            sink += op();
+        }
+        iterations += 64;
+        now = Clock::now();
+    } while (now < deadline);
+    const std::uint64_t allocations = backend::AllocationTracker::threadTotals().allocations - allocationsBefore;
+    const double elapsedNs = std::chrono::duration<double, std::nano>(now - start).count();
+    if (sink == 42) {
+        std::cerr << "";  // Keeps the work observable.
+    }
+    Result result;
+    result.nsPerOp = elapsedNs / static_cast<double>(iterations);
+    result.megabytesPerSecond = static_cast<double>(bytes) * 1e3 / result.nsPerOp;
+    result.allocationsPerOp = static_cast<double>(allocations) / static_cast<double>(iterations);
+    return result;
+}
+
+void printRow(const std::string& scenario, const std::string& implementation, const Result& result) {
+    std::cout << std::left << std::setw(22) << scenario << std::setw(12) << implementation << std::right
+              << std::fixed << std::setprecision(1) << std::setw(12) << result.nsPerOp << std::setw(12)
+              << result.megabytesPerSecond;
+    if (backend::AllocationTracker::enabled()) {
+        std::cout << std::setw(12) << result.allocationsPerOp;
+    }
+    std::cout << "\n";
+}
+
+void runScenario(const BenchOptions& options,
+                 const std::string& name,
+                 const std::string& text,
+                 const std::function<std::size_t(const std::string&)>& legacy,
+                 const std::function<std::size_t(const frontend::JsonDocument&)>& onDemand) {
+    printRow(name, "legacy", measure(options.seconds, text.size(), [&] { return legacy(text); }));
+    printRow(name, "scalar", measure(options.seconds, text.size(), [&] {
+                 return onDemand(frontend::JsonDocument(text, frontend::JsonIndexMode::Scalar));
+             }));
+    if (frontend::JsonDocument::simdAvailable()) {
+        printRow(name, "sse2", measure(options.seconds, text.size(), [&] {
+                     return onDemand(frontend::JsonDocument(text));
+                 }));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\nUsage: json_bench [--seconds=S]\n";
+        return 2;
+    }
+
+    const std::string request = makeRequestBody();
+    const std::string completion = makeCompletion(1500);
+    const std::string chunk = makeStreamChunk();
+    const std::string large = makeCompletion(256 * 1024);
+
+    // The old scanner takes the first "content" key anywhere, so an
+    // OpenAI-style body yields the system prompt instead of the question.
+    const std::string chat =
+        R"({"messages":[{"role":"system","content":"You are a duck."},{"role":"user","content":"Where is the rain?"}]})";
+    std::cout << "messages body: legacy \"" << legacyExtractStringField(chat, "content")
+              << "\", on-demand messages[-1].content \""
+              << frontend::JsonDocument(chat).at("messages[-1].content").stringOr("") << "\"\n\n";
+
+    std::cout << std::left << std::setw(22) << "scenario" << std::setw(12) << "impl" << std::right
+              << std::setw(12) << "ns/op" << std::setw(12) << "MB/s";
+    if (backend::AllocationTracker::enabled()) {
+        std::cout << std::setw(12) << "allocs/op";
+    }
+    std::cout << "\n";
+
+    runScenario(
+        options, "request (4 fields)", request,
+        [](const std::string& text) {
+            return legacyExtractStringField(text, "message").size() + legacyExtractStringField(text, "model").size() +
+                   legacyExtractStringField(text, "systemPrompt").size() +
+                   legacyExtractStringField(text, "stream").size();
+        },
+        [](const frontend::JsonDocument& document) {
+            const frontend::JsonValue root = document.root();
+            return root["message"].stringOr("").size() + root["model"].stringOr("").size() +
+                   root["systemPrompt"].stringOr("").size() + (root["stream"].boolOr(false) ? 1u : 0u);
+        });
+
+    const auto legacyContentOp = [](const std::string& text) { return legacyExtractStringField(text, "content").size(); };
+    const auto messageContentOp = [](const frontend::JsonDocument& document) {
+        return document.at("choices[0].message.content").stringOr("").size();
+    };
+    runScenario(options, "completion 2KB", completion, legacyContentOp, messageContentOp);
+    runScenario(options, "stream chunk", chunk, legacyContentOp, [](const frontend::JsonDocument& document) {
+        return document.at("choices[0].delta.content").stringOr("").size();
+    });
+    runScenario(options, "completion 256KB", large, legacyContentOp, messageContentOp);
+    runScenario(
+        options, "index only 256KB", large, [](const std::string& text) { return text.find("\"usage\""); },
+        [](const frontend::JsonDocument& document) { return static_cast<std::size_t>(document.valid()); });
+    return 0;
+}
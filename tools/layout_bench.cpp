@@ -0,0 +1,193 @@
+// File: layout_bench.cpp
+// Description: Measures the persistent LayoutManager store: bulk load,
+//              snapshot write, cold-start load time, lock-free read
+//              throughput and group-committed write throughput. With
+//              WITH_ALLOC_TRACKING it also reports heap allocations per phase.
+
+#include "backend/AllocationTracker.hpp"
+#include "backend/Logger.hpp"
+#include "frontend/LayoutManager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    std::size_t users{1000000};
+    int readers{4};
+    int writers{8};
+    double seconds{2.0};
+    std::string directory{"/tmp/tank_layout_bench"};
+    bool sync{false};
+};
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "users") {
+            options.users = static_cast<std::size_t>(std::stoull(value));
+        } else if (key == "readers") {
+            options.readers = std::max(1, std::stoi(value));
+        } else if (key == "writers") {
+            options.writers = std::max(1, std::stoi(value));
+        } else if (key == "seconds") {
+            options.seconds = std::max(0.1, std::stod(value));
+        } else if (key == "dir") {
+            options.directory = value;
+        } else if (key == "sync") {
+            options.sync = value == "1" || value == "true";
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    return options;
+}
+
+double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string userIdFor(std::size_t i) {
+    return "user-" + std::to_string(i);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n"
+                  << "Usage: layout_bench [--users=N] [--readers=N] [--writers=N] [--seconds=S]"
+                     " [--dir=PATH] [--sync=0|1]\n";
+        return 2;
+    }
+
+    static const char* kThemes[] = {"light", "dark", "aurora", "sunset", "forest"};
+    static const char* kPresets[] = {"classic", "compact", "wide", "focus"};
+
+    std::filesystem::remove_all(options.directory);
+    frontend::LayoutStoreOptions store;
+    store.directory = options.directory;
+    store.syncOnCommit = options.sync;
+    store.snapshotEveryRecords = options.users * 4 + 1;
+
+    {
+        frontend::LayoutManager manager(store);
+        manager.initialize();
+        std::vector<std::pair<std::string, frontend::UserLayoutPreferences>> updates;
+        updates.reserve(options.users);
+        for (std::size_t i = 0; i < options.users; ++i) {
+            updates.emplace_back(userIdFor(i),
+                                 frontend::UserLayoutPreferences{kThemes[i % 5], kPresets[i % 4], i % 3 == 0});
+        }
+        auto start = Clock::now();
+        {
+            backend::AllocationScope allocationScope("bulk apply");
+            manager.applyPreferencesBatch(updates);
+        }
+        std::cout << "bulk apply (" << options.users << " users): " << std::fixed << std::setprecision(1)
+                  << millisSince(start) << " ms\n";
+        start = Clock::now();
+        {
+            backend::AllocationScope allocationScope("snapshot write");
+            manager.persist();
+        }
+        std::cout << "snapshot write: " << millisSince(start) << " ms ("
+                  << std::filesystem::file_size(std::filesystem::path(options.directory) / "layout.snap")
+                  << " bytes)\n";
+    }
+
+    frontend::LayoutManager manager(store);
+    auto start = Clock::now();
+    {
+        backend::AllocationScope allocationScope("cold start load");
+        manager.initialize();
+    }
+    std::cout << "cold start load: " << millisSince(start) << " ms (" << manager.userCount()
+              << " users)\n";
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> reads{0};
+    std::atomic<std::uint64_t> writes{0};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < options.readers; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937_64 rng(static_cast<std::uint64_t>(r) + 1);
+            std::uniform_int_distribution<std::size_t> pick(0, options.users - 1);
+            std::vector<std::string> ids;
+            for (int i = 0; i < 4096; ++i) {
+                ids.push_back(userIdFor(pick(rng)));
+            }
+            std::uint64_t local = 0;
+            backend::AllocationScope allocationScope("read");
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto prefs = manager.getPreferences(ids[local & 4095]);
+                if (prefs.theme.empty()) {
+                    std::cerr << "missing user after reload\n";
+                    std::abort();
+                }
+                ++local;
+            }
+            reads += local;
+        });
+    }
+    for (int w = 0; w < options.writers; ++w) {
+        threads.emplace_back([&, w] {
+            std::uint64_t local = 0;
+            backend::AllocationScope allocationScope("write");
+            while (!stop.load(std::memory_order_relaxed)) {
+                manager.applyPreferences(userIdFor((local * 7919 + static_cast<std::uint64_t>(w)) % options.users),
+                                         frontend::UserLayoutPreferences{"dark", "wide", false});
+                ++local;
+            }
+            writes += local;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "reads/s: " << std::setprecision(0) << reads.load() / options.seconds << " ("
+              << options.readers << " threads, concurrent with writes)\n";
+    std::cout << "writes/s: " << writes.load() / options.seconds << " (" << options.writers
+              << " threads, group commit, sync=" << (options.sync ? "on" : "off") << ")\n";
+
+    if (backend::AllocationTracker::enabled()) {
+        std::cout << "heap allocations by scope:\n";
+        for (const backend::AllocationStats& scope : backend::AllocationTracker::snapshot()) {
+            std::cout << "  " << std::left << std::setw(16) << scope.scope << std::right << std::setw(12)
+                      << scope.allocations << " allocs" << std::setw(14) << scope.allocatedBytes << " bytes";
+            const std::string name = scope.scope;
+            const std::uint64_t ops = name == "read" ? reads.load() : name == "write" ? writes.load() : 0;
+            if (ops > 0) {
+                std::cout << std::setprecision(2) << "  (" << static_cast<double>(scope.allocations) / ops
+                          << " allocs/op)" << std::setprecision(0);
+            }
+            std::cout << "\n";
+        }
+    }
+    return 0;
+}
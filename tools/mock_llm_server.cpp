@@ -0,0 +1,374 @@
+// File: mock_llm_server.cpp
+// Description: Local OpenAI-compatible chat completions server for
+//              exercising /duckai without a real API key. Answers POSTs with
+//              buffered JSON or SSE streams after a configurable latency
+//              distribution, and can inject HTTP errors, stalls and dropped
+//              connections.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+// "fixed:MS", "uniform:MIN:MAX", "normal:MEAN:STDDEV" or "lognormal:MEDIAN:SIGMA" (milliseconds).
+class LatencyDistribution {
+public:
+    static LatencyDistribution parse(const std::string& spec) {
+        LatencyDistribution dist;
+        std::vector<std::string> parts;
+        std::istringstream stream(spec);
+        std::string part;
+        while (std::getline(stream, part, ':')) {
+            parts.push_back(part);
+        }
+        if (parts.size() == 1) {
+            parts.insert(parts.begin(), "fixed");
+        }
+        dist.m_kind = parts[0];
+        const std::size_t expected = dist.m_kind == "fixed" ? 2 : 3;
+        if ((dist.m_kind != "fixed" && dist.m_kind != "uniform" && dist.m_kind != "normal" &&
+             dist.m_kind != "lognormal") ||
+            parts.size() != expected) {
+            throw std::invalid_argument("Bad latency spec: " + spec);
+        }
+        dist.m_a = std::stod(parts[1]);
+        dist.m_b = parts.size() > 2 ? std::stod(parts[2]) : 0.0;
+        return dist;
+    }
+
+    std::chrono::microseconds sample(std::mt19937_64& rng) const {
+        double ms = m_a;
+        if (m_kind == "uniform") {
+            ms = std::uniform_real_distribution<double>(m_a, std::max(m_a, m_b))(rng);
+        } else if (m_kind == "normal") {
+            ms = std::normal_distribution<double>(m_a, m_b)(rng);
+        } else if (m_kind == "lognormal") {
+            ms = std::lognormal_distribution<double>(std::log(std::max(m_a, 0.001)), m_b)(rng);
+        }
+        return std::chrono::microseconds(static_cast<long long>(std::max(0.0, ms) * 1000.0));
+    }
+
+private:
+    std::string m_kind{"fixed"};
+    double m_a{0.0};
+    double m_b{0.0};
+};
+
+struct MockOptions {
+    int port{18099};
+    LatencyDistribution firstByte = LatencyDistribution::parse("fixed:200");
+    LatencyDistribution perToken = LatencyDistribution::parse("fixed:20");
+    int tokens{16};
+    double errorRate{0.0};
+    int errorStatus{500};
+    double stallRate{0.0};
+    double dropRate{0.0};
+    std::uint64_t seed{42};
+};
+
+void printUsage() {
+    std::cout
+        << "Usage: mock_llm_server [--port=N] [--latency=SPEC] [--token-latency=SPEC] [--tokens=N]\n"
+           "                       [--error-rate=P] [--error-status=CODE] [--stall-rate=P]\n"
+           "                       [--drop-rate=P] [--seed=N]\n"
+           "\n"
+           "SPEC is fixed:MS, uniform:MIN:MAX, normal:MEAN:STDDEV or lognormal:MEDIAN:SIGMA.\n"
+           "--latency is the delay before the first byte (the whole answer when not\n"
+           "streaming); --token-latency is the gap between streamed tokens. Requests\n"
+           "whose JSON body sets \"stream\":true get an SSE stream. --error-rate answers\n"
+           "with --error-status, --stall-rate never answers and --drop-rate closes the\n"
+           "connection halfway through the response.\n"
+           "\n"
+           "Point the game server at it with\n"
+           "  DUCKAI_UPSTREAM_URL=http://127.0.0.1:18099/v1/chat/completions OPENAI_API_KEY=mock\n";
+}
+
+MockOptions parseOptions(int argc, char* argv[]) {
+    MockOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "port") {
+            options.port = std::stoi(value);
+        } else if (key == "latency") {
+            options.firstByte = LatencyDistribution::parse(value);
+        } else if (key == "token-latency") {
+            options.perToken = LatencyDistribution::parse(value);
+        } else if (key == "tokens") {
+            options.tokens = std::max(1, std::stoi(value));
+        } else if (key == "error-rate") {
+            options.errorRate = std::stod(value);
+        } else if (key == "error-status") {
+            options.errorStatus = std::stoi(value);
+        } else if (key == "stall-rate") {
+            options.stallRate = std::stod(value);
+        } else if (key == "drop-rate") {
+            options.dropRate = std::stod(value);
+        } else if (key == "seed") {
+            options.seed = std::stoull(value);
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    return options;
+}
+
+std::atomic<bool> g_stop{false};
+std::atomic<std::uint64_t> g_requests{0};
+std::atomic<std::uint64_t> g_streams{0};
+std::atomic<std::uint64_t> g_errors{0};
+std::atomic<std::uint64_t> g_stalls{0};
+std::atomic<std::uint64_t> g_drops{0};
+std::atomic<int> g_openConnections{0};
+
+bool sendAll(int fd, const std::string& data) {
+    const char* cursor = data.data();
+    std::size_t remaining = data.size();
+    while (remaining > 0) {
+        const ssize_t sent = ::send(fd, cursor, remaining, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        cursor += sent;
+        remaining -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+std::string chunk(const std::string& payload) {
+    char size[24];
+    std::snprintf(size, sizeof(size), "%zx\r\n", payload.size());
+    return size + payload + "\r\n";
+}
+
+bool wantsStream(const std::string& body) {
+    std::size_t pos = body.find("\"stream\"");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos = body.find(':', pos);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos = body.find_first_not_of(" \t\r\n", pos + 1);
+    return pos != std::string::npos && body.compare(pos, 4, "true") == 0;
+}
+
+// Reads one request (headers + Content-Length body); false on EOF or error.
+bool readRequest(int fd, std::string& buffer, std::string& head, std::string& body) {
+    char scratch[8192];
+    std::size_t headerEnd = std::string::npos;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t got = ::recv(fd, scratch, sizeof(scratch), 0);
+        if (got <= 0) {
+            return false;
+        }
+        buffer.append(scratch, static_cast<std::size_t>(got));
+    }
+    head = buffer.substr(0, headerEnd);
+    std::size_t contentLength = 0;
+    std::string lower = head;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const std::size_t clPos = lower.find("content-length:");
+    if (clPos != std::string::npos) {
+        contentLength = static_cast<std::size_t>(std::strtoull(head.c_str() + clPos + 15, nullptr, 10));
+    }
+    const std::size_t bodyStart = headerEnd + 4;
+    while (buffer.size() - bodyStart < contentLength) {
+        const ssize_t got = ::recv(fd, scratch, sizeof(scratch), 0);
+        if (got <= 0) {
+            return false;
+        }
+        buffer.append(scratch, static_cast<std::size_t>(got));
+    }
+    body = buffer.substr(bodyStart, contentLength);
+    buffer.erase(0, bodyStart + contentLength);
+    return true;
+}
+
+void serveConnection(int fd, const MockOptions& options, std::uint64_t seed) {
+    ++g_openConnections;
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::string buffer;
+    std::string head;
+    std::string body;
+    while (!g_stop.load() && readRequest(fd, buffer, head, body)) {
+        const std::uint64_t id = ++g_requests;
+        const bool stream = wantsStream(body);
+        const double roll = coin(rng);
+
+        if (roll < options.stallRate) {
+            ++g_stalls;
+            // Hold the request until the client gives up and closes.
+            char scratch[256];
+            while (::recv(fd, scratch, sizeof(scratch), 0) > 0) {
+            }
+            break;
+        }
+        std::this_thread::sleep_for(options.firstByte.sample(rng));
+        if (roll < options.stallRate + options.errorRate) {
+            ++g_errors;
+            const std::string payload =
+                R"({"error":{"message":"injected failure","type":"mock_error"}})";
+            sendAll(fd, "HTTP/1.1 " + std::to_string(options.errorStatus) +
+                            " Mock Error\r\nContent-Type: application/json\r\nContent-Length: " +
+                            std::to_string(payload.size()) + "\r\n\r\n" + payload);
+            continue;
+        }
+        const bool drop = roll < options.stallRate + options.errorRate + options.dropRate;
+
+        const std::string idText = "mock-" + std::to_string(id);
+        if (!stream) {
+            std::string content = "Quack! Mock answer " + std::to_string(id) + ":";
+            for (int t = 0; t < options.tokens; ++t) {
+                content += " token" + std::to_string(t);
+            }
+            const std::string payload =
+                R"({"id":")" + idText +
+                R"(","object":"chat.completion","model":"mock","choices":[{"index":0,"message":{"role":"assistant","content":")" +
+                content + R"("},"finish_reason":"stop"}]})";
+            const std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                                         std::to_string(payload.size()) + "\r\n\r\n" + payload;
+            if (drop) {
+                ++g_drops;
+                sendAll(fd, response.substr(0, response.size() / 2));
+                break;
+            }
+            if (!sendAll(fd, response)) {
+                break;
+            }
+            continue;
+        }
+
+        ++g_streams;
+        if (!sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                         "Transfer-Encoding: chunked\r\n\r\n")) {
+            break;
+        }
+        bool alive = true;
+        for (int t = 0; t < options.tokens && alive; ++t) {
+            if (t > 0) {
+                std::this_thread::sleep_for(options.perToken.sample(rng));
+            }
+            if (drop && t == options.tokens / 2) {
+                ++g_drops;
+                alive = false;
+                break;
+            }
+            const std::string text = t == 0 ? "Quack!" : " token" + std::to_string(t);
+            alive = sendAll(fd, chunk("data: {\"id\":\"" + idText +
+                                      "\",\"object\":\"chat.completion.chunk\",\"choices\":[{\"index\":0,"
+                                      "\"delta\":{\"content\":\"" + text + "\"}}]}\n\n"));
+        }
+        if (!alive || !sendAll(fd, chunk("data: [DONE]\n\n") + "0\r\n\r\n")) {
+            break;
+        }
+    }
+    ::close(fd);
+    --g_openConnections;
+}
+
+void handleSignal(int) {
+    g_stop.store(true);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    MockOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        printUsage();
+        return 2;
+    }
+
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("socket");
+        return 1;
+    }
+    const int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 512) != 0) {
+        std::perror("bind/listen");
+        return 1;
+    }
+
+    struct sigaction action {};
+    action.sa_handler = handleSignal;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "mock_llm_server listening on http://127.0.0.1:" << options.port
+              << "/v1/chat/completions" << std::endl;
+
+    std::uint64_t connectionSeed = options.seed;
+    while (!g_stop.load()) {
+        const int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::perror("accept");
+            break;
+        }
+        const int noDelay = 1;
+        ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        std::thread(serveConnection, client, std::cref(options), ++connectionSeed).detach();
+    }
+    ::close(listener);
+
+    std::cout << "requests=" << g_requests.load() << " streams=" << g_streams.load()
+              << " errors=" << g_errors.load() << " stalls=" << g_stalls.load()
+              << " drops=" << g_drops.load() << " openConnections=" << g_openConnections.load()
+              << std::endl;
+    return 0;
+}
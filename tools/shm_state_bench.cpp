@@ -0,0 +1,170 @@
+// File: shm_state_bench.cpp
+// Description: Measures reads of the shared-memory state export. By default
+//              it runs its own GameEngine, with a writer thread moving the
+//              tank as fast as it can while a reader copies snapshots, and
+//              reports read latency, seqlock retries and publishes per
+//              second. With --attach=/name it only reads a running
+//              server's segment (TANK_SHM_NAME) and prints the state.
+
+#include "backend/GameEngine.hpp"
+#include "backend/SharedState.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    double seconds{1.0};  // per scenario
+    std::string attach;
+};
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "seconds") {
+            options.seconds = std::max(0.05, std::stod(value));
+        } else if (key == "attach") {
+            options.attach = value;
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    return options;
+}
+
+const char* directionName(std::int32_t direction) {
+    static const char* const kNames[] = {"up", "down", "left", "right", "none"};
+    return direction >= 0 && direction < 5 ? kNames[direction] : "?";
+}
+
+int attach(const BenchOptions& options) {
+    backend::SharedStateReader reader(options.attach);
+    backend::SharedStateSnapshot snapshot{};
+    std::vector<backend::SharedEnvelope> envelopes;
+    if (!reader.read(snapshot, envelopes)) {
+        std::cerr << "Segment stayed busy; is the server stuck mid-write?\n";
+        return 1;
+    }
+    std::cout << "publish " << snapshot.publishCount << ", world " << snapshot.worldWidth << "x"
+              << snapshot.worldHeight << ", time left " << std::fixed << std::setprecision(1)
+              << backend::sharedTimeLeftSeconds(snapshot) << " s" << (snapshot.paused ? " (paused)" : "") << "\n"
+              << "tank (" << snapshot.tankX << ", " << snapshot.tankY << ") heading "
+              << directionName(snapshot.tankDirection) << ", collected " << snapshot.collectedCount << " worth "
+              << snapshot.collectedValue << "\n"
+              << "envelopes " << snapshot.envelopeCount << " of " << snapshot.envelopeTotal << "\n";
+    for (const backend::SharedEnvelope& envelope : envelopes) {
+        std::cout << "  #" << envelope.id << " (" << envelope.x << ", " << envelope.y << ") value "
+                  << envelope.value << "\n";
+    }
+    return 0;
+}
+
+void runScenario(const BenchOptions& options, int envelopeCount) {
+    backend::GameConfig config;
+    config.worldWidth = 200;
+    config.worldHeight = 200;
+    config.initialEnvelopeCount = envelopeCount;
+    config.timeLimitSeconds = 3600;
+    config.envelopeLifetimeSeconds = 0;
+    config.rainIntervalSeconds = 0;
+    backend::GameEngine engine(config);
+    const std::string name = "/tank_shm_bench." + std::to_string(::getpid());
+    engine.exportSharedState(name, static_cast<std::size_t>(envelopeCount));
+    backend::SharedStateReader reader(name);
+
+    std::atomic<bool> stop{false};
+    std::uint64_t writes = 0;
+    std::thread writer([&] {
+        const backend::MoveDirection directions[] = {backend::MoveDirection::Right, backend::MoveDirection::Down,
+                                                     backend::MoveDirection::Left, backend::MoveDirection::Up};
+        while (!stop.load(std::memory_order_relaxed)) {
+            engine.moveTank(directions[(writes / 8) % 4]);
+            ++writes;
+        }
+    });
+
+    backend::SharedStateSnapshot snapshot{};
+    std::vector<backend::SharedEnvelope> envelopes;
+    std::uint64_t reads = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t lastPublish = 0;
+    std::uint64_t inconsistent = 0;
+    std::uint64_t versionChecks = 0;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration<double>(options.seconds);
+    while (Clock::now() < deadline) {
+        for (int i = 0; i < 64; ++i) {
+            if (!reader.read(snapshot, envelopes)) {
+                ++failed;
+                continue;
+            }
+            ++reads;
+            if (snapshot.publishCount < lastPublish || snapshot.envelopeCount != envelopes.size() ||
+                snapshot.envelopeCount != snapshot.envelopeTotal) {
+                ++inconsistent;
+            }
+            lastPublish = snapshot.publishCount;
+        }
+    }
+    const double readSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Polling version() alone is what a consumer pays between updates.
+    const auto pollStart = Clock::now();
+    std::uint64_t sink = 0;
+    for (; versionChecks < 10'000'000; ++versionChecks) {
+        sink += reader.version();
+    }
+    const double pollSeconds = std::chrono::duration<double>(Clock::now() - pollStart).count();
+
+    stop = true;
+    writer.join();
+
+    std::cout << std::left << std::setw(10) << envelopeCount << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << readSeconds * 1e9 / static_cast<double>(std::max<std::uint64_t>(reads, 1))
+              << std::setw(12) << pollSeconds * 1e9 / static_cast<double>(versionChecks) << std::setw(14)
+              << static_cast<double>(writes) / readSeconds << std::setw(10) << failed << std::setw(14)
+              << inconsistent << (sink == 1 ? " " : "") << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        const BenchOptions options = parseOptions(argc, argv);
+        if (!options.attach.empty()) {
+            return attach(options);
+        }
+        std::cout << "Shared state reads against a writer moving the tank continuously\n"
+                  << std::left << std::setw(10) << "envelopes" << std::right << std::setw(12) << "ns/read"
+                  << std::setw(12) << "ns/poll" << std::setw(14) << "publishes/s" << std::setw(10) << "failed"
+                  << std::setw(14) << "inconsistent" << "\n";
+        for (int envelopes : {12, 1000, 10000}) {
+            runScenario(options, envelopes);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "shm_state_bench: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
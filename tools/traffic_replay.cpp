@@ -0,0 +1,346 @@
+// File: traffic_replay.cpp
+// Description: Replays a TANK_CAPTURE_FILE recording against a running
+//              server, preserving the recorded arrival times at 1x, scaled
+//              by --speed, or back to back, and reports latency percentiles
+//              per route together with how far dispatch fell behind schedule.
+
+#include "frontend/TrafficCapture.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ReplayOptions {
+    std::string file;
+    std::string host{"127.0.0.1"};
+    int port{8080};
+    // Time scale: 2 replays twice as fast as recorded; 0 sends back to back.
+    double speed{1.0};
+    int concurrency{64};
+    int timeoutMs{30000};
+    std::size_t limit{0};  // 0 = whole file
+};
+
+void printUsage() {
+    std::cout << "Usage: traffic_replay --file=PATH [--host=ADDR] [--port=N] [--speed=X|max]\n"
+                 "                      [--concurrency=N] [--timeout-ms=N] [--limit=N]\n"
+                 "\n"
+                 "Record with:  TANK_CAPTURE_FILE=traffic.cap bin/tank_red_envelope 8080\n"
+                 "Replay with:  bin/traffic_replay --file=traffic.cap --port=8080 --speed=4\n"
+                 "\n"
+                 "--speed=1 keeps recorded arrival times, N compresses them N times and\n"
+                 "max sends as fast as --concurrency connections allow.\n";
+}
+
+ReplayOptions parseOptions(int argc, char* argv[]) {
+    ReplayOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        const std::size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            throw std::invalid_argument("Unrecognized argument: " + arg);
+        }
+        const std::string key = arg.substr(2, eq - 2);
+        const std::string value = arg.substr(eq + 1);
+        if (key == "file") {
+            options.file = value;
+        } else if (key == "host") {
+            options.host = value;
+        } else if (key == "port") {
+            options.port = std::stoi(value);
+        } else if (key == "speed") {
+            options.speed = value == "max" ? 0.0 : std::max(0.0, std::stod(value));
+        } else if (key == "concurrency") {
+            options.concurrency = std::max(1, std::stoi(value));
+        } else if (key == "timeout-ms") {
+            options.timeoutMs = std::max(1, std::stoi(value));
+        } else if (key == "limit") {
+            options.limit = static_cast<std::size_t>(std::max(0L, std::stol(value)));
+        } else {
+            throw std::invalid_argument("Unknown option: --" + key);
+        }
+    }
+    if (options.file.empty()) {
+        throw std::invalid_argument("--file is required");
+    }
+    return options;
+}
+
+bool isHopHeader(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower == "host" || lower == "content-length" || lower == "connection" || lower == "keep-alive" ||
+           lower == "transfer-encoding";
+}
+
+// Sends one captured request; returns the status, or 0 on transport failure.
+int sendRequest(const ReplayOptions& options, const frontend::CapturedRequest& captured) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    timeval timeout {};
+    timeout.tv_sec = options.timeoutMs / 1000;
+    timeout.tv_usec = (options.timeoutMs % 1000) * 1000;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+    if (::inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1 ||
+        ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return 0;
+    }
+
+    std::string payload = captured.method + " " + captured.path + " HTTP/1.1\r\nHost: " + options.host + "\r\n";
+    for (const auto& [name, value] : captured.headers) {
+        if (!isHopHeader(name)) {
+            payload += name + ": " + value + "\r\n";
+        }
+    }
+    payload += "Content-Length: " + std::to_string(captured.body.size()) + "\r\nConnection: close\r\n\r\n";
+    payload += captured.body;
+    if (::send(fd, payload.data(), payload.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(payload.size())) {
+        ::close(fd);
+        return 0;
+    }
+
+    // The server closes after each response, so read to EOF.
+    std::string head;
+    char buffer[16384];
+    while (true) {
+        const ssize_t got = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (got < 0) {
+            ::close(fd);
+            return 0;
+        }
+        if (got == 0) {
+            break;
+        }
+        if (head.size() < 16) {
+            head.append(buffer, static_cast<std::size_t>(std::min<ssize_t>(got, 16)));
+        }
+    }
+    ::close(fd);
+    if (head.rfind("HTTP/1.", 0) != 0 || head.size() < 12) {
+        return 0;
+    }
+    return std::atoi(head.c_str() + 9);
+}
+
+struct Sample {
+    std::string route;
+    int status{0};
+    std::uint32_t latencyUs{0};
+    std::uint32_t lagUs{0};  // dispatch delay past the scheduled time
+};
+
+struct Job {
+    const frontend::CapturedRequest* request;
+    Clock::time_point due;
+};
+
+std::string routeOf(const frontend::CapturedRequest& request) {
+    const std::size_t query = request.path.find('?');
+    return request.method + " " + (query == std::string::npos ? request.path : request.path.substr(0, query));
+}
+
+double percentileMs(const std::vector<std::uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t index =
+        std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+void printRow(const std::string& name, std::vector<std::uint32_t>& latencies, std::uint64_t errors) {
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::left << std::setw(30) << name << std::right << std::setw(8) << latencies.size()
+              << std::setw(8) << errors << std::fixed << std::setprecision(3) << std::setw(10)
+              << percentileMs(latencies, 0.50) << std::setw(10) << percentileMs(latencies, 0.90) << std::setw(10)
+              << percentileMs(latencies, 0.99) << std::setw(10)
+              << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    std::vector<frontend::CapturedRequest> requests;
+    std::uint64_t redacted = 0;
+    std::uint64_t skipped = 0;
+    try {
+        options = parseOptions(argc, argv);
+        frontend::TrafficCaptureReader reader(options.file);
+        frontend::CapturedRequest request;
+        while ((options.limit == 0 || requests.size() < options.limit) && reader.next(request)) {
+            // Older captures may hold /spectate streams, which only end when
+            // the client hangs up; replaying one would block its worker.
+            if (routeOf(request) == "GET /spectate") {
+                ++skipped;
+                continue;
+            }
+            redacted += request.bodyRedacted ? 1 : 0;
+            requests.push_back(std::move(request));
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        printUsage();
+        return 2;
+    }
+    if (requests.empty()) {
+        std::cerr << "No requests in " << options.file << "\n";
+        return 1;
+    }
+    // Concurrent handlers take their timestamp before appending, so records
+    // can be slightly out of order in the file.
+    std::stable_sort(requests.begin(), requests.end(),
+                     [](const frontend::CapturedRequest& a, const frontend::CapturedRequest& b) {
+                         return a.offsetMicros < b.offsetMicros;
+                     });
+
+    const double recordedSeconds = static_cast<double>(requests.back().offsetMicros) / 1e6;
+    std::cout << "file=" << options.file << " requests=" << requests.size() << " redacted=" << redacted
+              << " skipped=" << skipped
+              << " recorded=" << std::fixed << std::setprecision(1) << recordedSeconds << "s speed=";
+    if (options.speed > 0.0) {
+        std::cout << std::setprecision(2) << options.speed << "x";
+    } else {
+        std::cout << "max";
+    }
+    std::cout << " concurrency=" << options.concurrency << "\n";
+
+    // Open loop: the dispatcher releases each request at its scheduled time
+    // regardless of how many are still in flight (up to --concurrency run).
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Job> queue;
+    bool finished = false;
+    std::vector<Sample> samples;
+    samples.reserve(requests.size());
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.concurrency; ++i) {
+        workers.emplace_back([&] {
+            std::vector<Sample> local;
+            while (true) {
+                Job job{};
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&] { return finished || !queue.empty(); });
+                    if (queue.empty()) {
+                        break;
+                    }
+                    job = queue.front();
+                    queue.pop_front();
+                }
+                const auto start = Clock::now();
+                Sample sample;
+                sample.route = routeOf(*job.request);
+                sample.status = sendRequest(options, *job.request);
+                sample.latencyUs = static_cast<std::uint32_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+                sample.lagUs = start > job.due ? static_cast<std::uint32_t>(
+                                                     std::chrono::duration_cast<std::chrono::microseconds>(
+                                                         start - job.due)
+                                                         .count())
+                                               : 0;
+                local.push_back(std::move(sample));
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            samples.insert(samples.end(), local.begin(), local.end());
+        });
+    }
+
+    const auto replayStart = Clock::now();
+    const std::uint64_t firstOffset = requests.front().offsetMicros;
+    for (const frontend::CapturedRequest& request : requests) {
+        Clock::time_point due = Clock::now();
+        if (options.speed > 0.0) {
+            const double scaled = static_cast<double>(request.offsetMicros - firstOffset) / options.speed;
+            due = replayStart + std::chrono::microseconds(static_cast<std::int64_t>(scaled));
+            std::this_thread::sleep_until(due);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(Job{&request, due});
+        }
+        ready.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - replayStart).count();
+
+    std::map<std::string, std::vector<std::uint32_t>> latencies;
+    std::map<std::string, std::uint64_t> errors;
+    std::map<int, std::uint64_t> statuses;
+    std::vector<std::uint32_t> all;
+    std::vector<std::uint32_t> lags;
+    std::uint64_t allErrors = 0;
+    for (const Sample& sample : samples) {
+        latencies[sample.route].push_back(sample.latencyUs);
+        all.push_back(sample.latencyUs);
+        lags.push_back(sample.lagUs);
+        ++statuses[sample.status];
+        if (sample.status == 0 || sample.status >= 500) {
+            ++errors[sample.route];
+            ++allErrors;
+        }
+    }
+
+    std::cout << std::left << std::setw(30) << "route" << std::right << std::setw(8) << "count" << std::setw(8)
+              << "errors" << std::setw(10) << "p50ms" << std::setw(10) << "p90ms" << std::setw(10) << "p99ms"
+              << std::setw(10) << "maxms" << "\n";
+    for (auto& [route, values] : latencies) {
+        printRow(route, values, errors[route]);
+    }
+    printRow("total", all, allErrors);
+
+    std::sort(lags.begin(), lags.end());
+    std::cout << std::setprecision(1) << "elapsed=" << elapsed << "s throughput="
+              << static_cast<double>(samples.size()) / elapsed << " req/s schedule lag p50="
+              << std::setprecision(3) << percentileMs(lags, 0.50) << "ms p99=" << percentileMs(lags, 0.99)
+              << "ms\nstatus:";
+    for (const auto& [status, count] : statuses) {
+        std::cout << " " << (status == 0 ? std::string("transport") : std::to_string(status)) << "=" << count;
+    }
+    std::cout << "\n";
+    return 0;
+}